@@ -3,7 +3,7 @@
 internal void LoadPredefinedMaterials(game_asset_manager* AssetManager)
 {
   u8 WhitePixel[4] = {255,255,255,255};
-  PushBitmapData(AssetManager, "null", 1, 1, 32, (void*)WhitePixel, true);
+  PushBitmapData(AssetManager, AssetKey("null"), 1, 1, 32, (void*)WhitePixel, true);
 
   //u32 WhiteTexture[256][256];
   //for (int i = 0; i < 256; ++i)
@@ -81,7 +81,7 @@ internal void LoadPredefinedMeshes(game_asset_manager* AssetManager)
     u32 ti[] = {0,1,2,2,1,3};
     u32 ni[] = {0,0,0,0,0,0};
     aabb3f AABB = AABB3f(V3(-0.5, -0.5, 0), V3( 0.5,  0.5, 0));
-    object_handle ObjectHandle = PushIndexData(AssetManager, "quad", MeshHandle, ArrayCount(vi), vi, ti, ni, AABB);
+    object_handle ObjectHandle = PushIndexData(AssetManager, AssetKey("quad"), MeshHandle, ArrayCount(vi), vi, ti, ni, AABB);
     AssetManager->EnumeratedMeshes[(u32)predefined_mesh::QUAD] = ObjectHandle;
   }
 
@@ -125,14 +125,14 @@ internal void LoadPredefinedMeshes(game_asset_manager* AssetManager)
     u32 ti[] = {0,1,3,3,1,2,0,1,3,3,1,2,0,1,3,3,1,2,0,1,3,3,1,2,0,1,3,3,1,2,0,1,3,3,1,2};
     u32 ni[] = {0,0,0,0,0,0,1,1,1,1,1,1,2,2,2,2,2,2,3,3,3,3,3,3,4,4,4,4,4,4,5,5,5,5,5,5};
     aabb3f AABB = AABB3f(V3(-0.5, -0.5, -0.5), V3( 0.5, 0.5, 0.5));
-    object_handle ObjectHandle = PushIndexData(AssetManager, "voxel", MeshHandle, ArrayCount(vi), vi, ti, ni, AABB);
+    object_handle ObjectHandle = PushIndexData(AssetManager, AssetKey("voxel"), MeshHandle, ArrayCount(vi), vi, ti, ni, AABB);
     AssetManager->EnumeratedMeshes[(u32)predefined_mesh::VOXEL] = ObjectHandle;
   }
 
 
   object_handle Handle;
-  GetHandle(AssetManager, "voxel", &Handle);
-  GetHandle(AssetManager, "quad", &Handle);
+  GetHandle(AssetManager, AssetKey("voxel"), &Handle);
+  GetHandle(AssetManager, AssetKey("quad"), &Handle);
 
 }
 
@@ -140,90 +140,27 @@ internal void LoadPredefinedMeshes(game_asset_manager* AssetManager)
 #include "externals/stb_image_write.h"
 
 
-internal void stbtt_BakeFontBitmap(game_asset_manager* AssetManager)
+internal void LoadFonts(game_asset_manager* AssetManager)
 {
-  const s32 Ranges[] =
-  {
-      0x20, 0x80,       // BasicLatin
-      0xA1, 0x100,      // ExtendedLatin
-      0x16A0, 0x1700,   // Runic
-      0x600, 0x700,     // Arabic
-      0x370, 0x400,     // Greek
-      0x2200, 0x2300    // Mathematical
-  };
-
-
+  // Glyphs are rasterized from the font file as they are drawn so it stays loaded
   thread_context Thread;
-  debug_read_file_result TTFFile = Platform.DEBUGPlatformReadEntireFile(&Thread, "..\\data\\Fonts\\Mx437_IBM_BIOS.ttf");
+  c8* FileName = "..\\data\\Fonts\\Mx437_IBM_BIOS.ttf";
+  AddAssetSource(AssetManager, FileName);
+  debug_read_file_result TTFFile = Platform.DEBUGPlatformReadEntireFile(&Thread, FileName);
   Assert(TTFFile.Contents);
-
-  auto push_font = [&Ranges, &AssetManager, &TTFFile](stb_font_map* FontMap, c8* Name, r32 FontHeightPx)
-  {
-    FontMap->StartChar = Ranges[0];
-    FontMap->NumChars = Ranges[1] - Ranges[0];
-    FontMap->FontHeightPx = FontHeightPx;
-    FontMap->CharData = PushArray(&AssetManager->AssetArena, FontMap->NumChars, stbtt_bakedchar);
-
-    stbtt_GetScaledFontVMetrics((u8*) TTFFile.Contents, stbtt_GetFontOffsetForIndex((u8*) TTFFile.Contents, 0),
-     FontMap->FontHeightPx, &FontMap->Ascent, &FontMap->Descent, &FontMap->LineGap);
-
-    // Todo: Insetead of saving the 8bit font map to a 32 bit, write a custom shader for the 8bit
-    //       texture that can render it with colour.
-
-    // Todo: Character clipping seems to be dependent on 512x512 texture size. Try to make it dynamic
-    //       so that any texturesize works
-    u32 BPP = 32;
-    u32 Width = 512;
-    u32 Height = 512;
-
-    u8* Pixels8BPP = PushArray(GlobalGameState->TransientArena, Width * Height, u8);
-
-    s32 ret = stbtt_BakeFontBitmap((u8*) TTFFile.Contents, stbtt_GetFontOffsetForIndex((u8*) TTFFile.Contents, 0),
-                         FontMap->FontHeightPx,
-                         Pixels8BPP, Width, Height,
-                         FontMap->StartChar, FontMap->NumChars,
-                         FontMap->CharData);
-    Assert(ret>0);
-
-    u32* BasePixel = PushArray(GlobalGameState->TransientArena, Width*Height, u32 );
-    u32* Pixels = BasePixel;
-    u8*  SrcPixel =  Pixels8BPP;
-    u8*  EndSrcPixel = Pixels8BPP + Width * Height;
-    while(SrcPixel != EndSrcPixel)
-    {
-      u8 Alpha = *SrcPixel;
-      u8 Blue = *SrcPixel;
-      u8 Green = *SrcPixel;
-      u8 Red = *SrcPixel;
-      u32 PixelData = (Blue << 0) | (Green << 8) | (Red << 16) | Alpha << 24;
-      *Pixels++ = PixelData;
-      SrcPixel++;
-    }
-
-    PushBitmapData(AssetManager, Name, Width, Height, BPP, BasePixel, false);
-    GetHandle(AssetManager, Name, &FontMap->BitmapHandle);
-  };
-
-
-  push_font(&AssetManager->FontMap[0], "debug_font_08", 8);
-  push_font(&AssetManager->FontMap[1], "debug_font_10", 10);
-  push_font(&AssetManager->FontMap[2], "debug_font_12", 12);
-  push_font(&AssetManager->FontMap[3], "debug_font_14", 14);
-  push_font(&AssetManager->FontMap[4], "debug_font_16", 16);
-  push_font(&AssetManager->FontMap[5], "debug_font_18", 18);
-  push_font(&AssetManager->FontMap[6], "debug_font_20", 20);
-  push_font(&AssetManager->FontMap[7], "debug_font_22", 22);
-  push_font(&AssetManager->FontMap[8], "debug_font_24", 24);
-  push_font(&AssetManager->FontMap[9], "debug_font_26", 26);
-
+  u8* Data = (u8*) PushCopy(&AssetManager->AssetArena, TTFFile.ContentSize, TTFFile.Contents, NoClear());
   Platform.DEBUGPlatformFreeFileMemory(&Thread, TTFFile.Contents);
+
+  u32 Font = AddFont(AssetManager->FontCache, "debug_font", Data, TTFFile.ContentSize);
+  Assert(Font == DEFAULT_FONT);
 }
 
 internal void LoadCubeAsset(game_asset_manager* AssetManager)
 {
   memory_arena* AssetArena = &AssetManager->AssetArena;
-  obj_loaded_file* LoadedObjFile = ReadOBJFile( AssetArena, GlobalGameState->TransientArena,
-   "..\\handmade\\data\\cube\\cube.obj");
+  c8* FileName = "..\\handmade\\data\\cube\\cube.obj";
+  AddAssetSource(AssetManager, FileName);
+  obj_loaded_file* LoadedObjFile = ReadOBJFile( AssetArena, GlobalGameState->TransientArena, FileName);
 
   mesh_data* MeshData = LoadedObjFile->MeshData;
 
@@ -272,17 +209,16 @@ internal void LoadCubeAsset(game_asset_manager* AssetManager)
 
 internal void LoadBitmaps(game_asset_manager* AssetManager)
 {
-  bitmap* ElectricalComponents = LoadTGA(&AssetManager->AssetArena,
-        "..\\assets\\TileSheet.tga" );
-  bitmap_handle ElectricalComponentsHandle = PushBitmapData(AssetManager, "TileSheet", ElectricalComponents->Width, ElectricalComponents->Height, ElectricalComponents->BPP, ElectricalComponents->Pixels, true);
-  PushMaterialData(AssetManager, "TileSheet", CreateMaterial(V4(1,1,1,1),V4(1,1,1,1),V4(1,1,1,1),1, false));
+  LoadBitmapAsync(AssetManager, AssetKey("TileSheet"), "..\\assets\\TileSheet.tga", true);
+  PushMaterialData(AssetManager, AssetKey("TileSheet"), CreateMaterial(V4(1,1,1,1),V4(1,1,1,1),V4(1,1,1,1),1, false));
 }
 
 internal void LoadTeapotAsset(game_asset_manager* AssetManager)
 {
   memory_arena* AssetArena = &AssetManager->AssetArena;
-  obj_loaded_file* LoadedObjFile = ReadOBJFile( AssetArena, GlobalGameState->TransientArena,
-   "..\\handmade\\data\\teapot.obj");
+  c8* FileName = "..\\handmade\\data\\teapot.obj";
+  AddAssetSource(AssetManager, FileName);
+  obj_loaded_file* LoadedObjFile = ReadOBJFile( AssetArena, GlobalGameState->TransientArena, FileName);
 
   mesh_data* MeshData = LoadedObjFile->MeshData;
 
@@ -308,9 +244,19 @@ internal void LoadTeapotAsset(game_asset_manager* AssetManager)
 
 internal void LoadAssets(game_asset_manager* AssetManager)
 {
+  if(LoadAssetPack(AssetManager, ASSET_PACK_PATH))
+  {
+    AssetManager->FromAssetPack = true;
+    GetHandle(AssetManager, AssetKey("quad"),  &AssetManager->EnumeratedMeshes[(u32)predefined_mesh::QUAD]);
+    GetHandle(AssetManager, AssetKey("voxel"), &AssetManager->EnumeratedMeshes[(u32)predefined_mesh::VOXEL]);
+    GetHandle(AssetManager, AssetKey("null"),  &AssetManager->PlaceholderBitmap);
+    return;
+  }
+
   LoadPredefinedMaterials(AssetManager);
   LoadPredefinedMeshes(AssetManager);
-  stbtt_BakeFontBitmap(AssetManager);
+  GetHandle(AssetManager, AssetKey("null"),  &AssetManager->PlaceholderBitmap);
+  LoadFonts(AssetManager);
   //LoadCubeAsset(AssetManager);
   LoadBitmaps(AssetManager);
   //LoadTeapotAsset(AssetManager);
@@ -318,32 +264,27 @@ internal void LoadAssets(game_asset_manager* AssetManager)
 
 game_asset_manager* CreateAssetManager()
 {
-  game_asset_manager* AssetManager = BootstrapPushStruct(game_asset_manager, AssetArena);
+  game_asset_manager* AssetManager = BootstrapPushStruct(game_asset_manager, AssetArena, LargePageArena());
 
+  // Starting sizes, the maps grow when they fill up
   AssetManager->Meshes.MaxCount = 64;
-  AssetManager->Meshes.Values = (void**) PushArray(&AssetManager->AssetArena,
-                                  AssetManager->Meshes.MaxCount, mesh_data);
+  AssetManager->Meshes.Values = PushArray(&AssetManager->AssetArena,
+                                  AssetManager->Meshes.MaxCount, void*);
 
-  AssetManager->Objects.MaxCount = 64;
-  AssetManager->Objects.Values = (void**) PushArray(&AssetManager->AssetArena,
-                                            AssetManager->Objects.MaxCount, void*);
+  InitializeAssetHashMap(&AssetManager->AssetArena, &AssetManager->Objects, 64);
   AssetManager->ObjectKeeper = PushArray(&AssetManager->AssetArena,
                                             AssetManager->Objects.MaxCount, buffer_keeper);
 
-  AssetManager->Materials.MaxCount = 64;
-  AssetManager->Materials.Values = (void**) PushArray( &AssetManager->AssetArena,
-                                            AssetManager->Materials.MaxCount, void*);
-  AssetManager->Bitmaps.MaxCount = 64;
-  AssetManager->Bitmaps.Values = (void**) PushArray( &AssetManager->AssetArena,
-                                            AssetManager->Materials.MaxCount, void*);
+  InitializeAssetHashMap(&AssetManager->AssetArena, &AssetManager->Materials, 64);
+  InitializeAssetHashMap(&AssetManager->AssetArena, &AssetManager->Bitmaps, 64);
   AssetManager->BitmapKeeper = PushArray(&AssetManager->AssetArena,
-                                            AssetManager->Materials.MaxCount, bitmap_keeper);
+                                            AssetManager->Bitmaps.MaxCount, bitmap_keeper);
 
   AssetManager->EnumeratedMeshes = PushArray(&AssetManager->AssetArena,
                                             (u32)predefined_mesh::COUNT, object_handle);
 
-  AssetManager->ObjectPendingLoadCount = 0;
-  AssetManager->BitmapPendingLoadCount = 0;
+  AssetManager->UploadBudgetBytes = DEFAULT_UPLOAD_BUDGET_BYTES;
+  AssetManager->FontCache = CreateFontCache(&AssetManager->AssetArena);
 
   LoadAssets(AssetManager);
 
@@ -0,0 +1,296 @@
+#include "asset_pack.h"
+#include "font_cache.h"
+
+struct asset_pack_writer
+{
+  u8* Base;
+  midx Used;
+  midx Size;
+};
+
+internal inline midx
+PackAlign(midx Size)
+{
+  midx Result = AlignPow2(Size, (midx) ASSET_PACK_ALIGNMENT);
+  return Result;
+}
+
+// Reserves Size bytes in the pack, copies Source there if given and returns the offset
+internal u64
+PackBytes(asset_pack_writer* Writer, midx Size, void* Source = 0)
+{
+  u64 Result = Writer->Used;
+  Writer->Used += PackAlign(Size);
+  Assert(Writer->Used <= Writer->Size);
+  if(Source)
+  {
+    utils::Copy(Size, Source, Writer->Base + Result);
+  }
+  return Result;
+}
+
+internal void
+PackName(c8* Key, c8* Name)
+{
+  u32 Length = str::StringLength(Key);
+  str::CopyStrings(Length, Key, ASSET_PACK_NAME_LENGTH-1, Name);
+}
+
+internal inline midx
+GetBitmapSize(bitmap* Bitmap)
+{
+  midx Result = (midx) Bitmap->Width * Bitmap->Height * Bitmap->BPP / 8;
+  return Result;
+}
+
+// Bitmaps that are still streaming, failed to load or are filled in at runtime, like font cache pages, stay out
+internal inline b32
+IsPackedBitmap(game_asset_manager* AssetManager, u32 Handle)
+{
+  bitmap_keeper* BitmapKeeper = AssetManager->BitmapKeeper + Handle;
+  b32 Result = !BitmapKeeper->Streaming && !BitmapKeeper->Missing && !BitmapKeeper->Runtime;
+  return Result;
+}
+
+b32 WriteAssetPack(game_asset_manager* AssetManager, memory_arena* TempArena, c8* FileName)
+{
+  asset_hash_map* Bitmaps = &AssetManager->Bitmaps;
+  asset_hash_map* Objects = &AssetManager->Objects;
+  asset_hash_map* Materials = &AssetManager->Materials;
+  asset_vector* Meshes = &AssetManager->Meshes;
+
+  ScopedMemory Memory(TempArena);
+
+  asset_pack_header Header = {};
+  Header.Magic = ASSET_PACK_MAGIC;
+  Header.Version = ASSET_PACK_VERSION;
+  Header.MeshCount = Meshes->Count;
+
+  // Objects are deduplicated here once instead of every time they are uploaded
+  gl_vertex_buffer* ObjectBuffers = PushArray(TempArena, Objects->Count, gl_vertex_buffer, NoClear());
+  for(u32 Index = 0; Index < Objects->Count; ++Index)
+  {
+    mesh_indeces* Object = (mesh_indeces*) Objects->Values[Index];
+    mesh_data* Mesh = (mesh_data*) Meshes->Values[Object->MeshHandle.Value];
+    Assert(!Object->Vertices);
+    ObjectBuffers[Index] = CreateGLVertexBuffer(TempArena, Object->Count,
+                                                Object->vi, Object->ti, Object->ni,
+                                                Mesh->v, Mesh->vt, Mesh->vn);
+  }
+
+  // Count records and payload so the pack can be written in one buffer
+  midx Size = PackAlign(sizeof(asset_pack_header));
+  for(u32 Index = 0; Index < Bitmaps->Count; ++Index)
+  {
+    bitmap* Bitmap = (bitmap*) Bitmaps->Values[Index];
+    if(IsPackedBitmap(AssetManager, Index))
+    {
+      ++Header.BitmapCount;
+      Size += PackAlign(GetBitmapSize(Bitmap));
+    }
+  }
+  for(u32 Index = 0; Index < Meshes->Count; ++Index)
+  {
+    mesh_data* Mesh = (mesh_data*) Meshes->Values[Index];
+    Size += PackAlign(Mesh->nv * sizeof(v3));
+  }
+  for(u32 Index = 0; Index < Objects->Count; ++Index)
+  {
+    gl_vertex_buffer* Buffer = ObjectBuffers + Index;
+    Size += 2 * PackAlign(Buffer->IndexCount * sizeof(u32)) + PackAlign(Buffer->VertexCount * sizeof(opengl_vertex));
+  }
+  Header.ObjectCount = Objects->Count;
+  Header.MaterialCount = Materials->Count;
+  font_cache* FontCache = AssetManager->FontCache;
+  Header.FontCount = FontCache->FontCount;
+  for(u32 Index = 0; Index < FontCache->FontCount; ++Index)
+  {
+    Size += PackAlign(FontCache->Fonts[Index].DataSize);
+  }
+  Size += PackAlign(Header.BitmapCount   * sizeof(asset_pack_bitmap));
+  Size += PackAlign(Header.MeshCount     * sizeof(asset_pack_mesh));
+  Size += PackAlign(Header.ObjectCount   * sizeof(asset_pack_object));
+  Size += PackAlign(Header.MaterialCount * sizeof(asset_pack_material));
+  Size += PackAlign(Header.FontCount     * sizeof(asset_pack_font));
+  Header.SourceCount = AssetManager->SourceCount;
+  Size += PackAlign(Header.SourceCount   * sizeof(asset_source));
+
+  asset_pack_writer Writer = {};
+  Writer.Size = Size;
+  Writer.Base = (u8*) PushSize(TempArena, Size, Align(ASSET_PACK_ALIGNMENT, true));
+
+  PackBytes(&Writer, sizeof(asset_pack_header));
+  Header.Bitmaps   = PackBytes(&Writer, Header.BitmapCount   * sizeof(asset_pack_bitmap));
+  Header.Meshes    = PackBytes(&Writer, Header.MeshCount     * sizeof(asset_pack_mesh));
+  Header.Objects   = PackBytes(&Writer, Header.ObjectCount   * sizeof(asset_pack_object));
+  Header.Materials = PackBytes(&Writer, Header.MaterialCount * sizeof(asset_pack_material));
+  Header.Fonts     = PackBytes(&Writer, Header.FontCount     * sizeof(asset_pack_font));
+  Header.Sources   = PackBytes(&Writer, Header.SourceCount   * sizeof(asset_source), AssetManager->Sources);
+  Header.Size      = Size;
+
+  asset_pack_bitmap* PackedBitmap = (asset_pack_bitmap*) (Writer.Base + Header.Bitmaps);
+  for(u32 Index = 0; Index < Bitmaps->Count; ++Index)
+  {
+    bitmap* Bitmap = (bitmap*) Bitmaps->Values[Index];
+    if(IsPackedBitmap(AssetManager, Index))
+    {
+      PackName(Bitmaps->Keys[Index], PackedBitmap->Name);
+      PackedBitmap->Special = Bitmap->Special;
+      PackedBitmap->BPP = Bitmap->BPP;
+      PackedBitmap->Width = Bitmap->Width;
+      PackedBitmap->Height = Bitmap->Height;
+      PackedBitmap->Pixels = PackBytes(&Writer, GetBitmapSize(Bitmap), Bitmap->Pixels);
+      ++PackedBitmap;
+    }
+  }
+
+  asset_pack_mesh* PackedMesh = (asset_pack_mesh*) (Writer.Base + Header.Meshes);
+  for(u32 Index = 0; Index < Meshes->Count; ++Index)
+  {
+    mesh_data* Mesh = (mesh_data*) Meshes->Values[Index];
+    PackedMesh->nv = Mesh->nv;
+    PackedMesh->v  = PackBytes(&Writer, Mesh->nv * sizeof(v3), Mesh->v);
+    ++PackedMesh;
+  }
+
+  asset_pack_object* PackedObject = (asset_pack_object*) (Writer.Base + Header.Objects);
+  for(u32 Index = 0; Index < Objects->Count; ++Index)
+  {
+    mesh_indeces* Object = (mesh_indeces*) Objects->Values[Index];
+    gl_vertex_buffer* Buffer = ObjectBuffers + Index;
+    midx IndexSize = Object->Count * sizeof(u32);
+    PackName(Objects->Keys[Index], PackedObject->Name);
+    PackedObject->MeshIndex = Object->MeshHandle.Value;
+    PackedObject->Count = Object->Count;
+    PackedObject->VertexCount = Buffer->VertexCount;
+    PackedObject->vi = PackBytes(&Writer, IndexSize, Object->vi);
+    PackedObject->Vertices = PackBytes(&Writer, Buffer->VertexCount * sizeof(opengl_vertex), Buffer->VertexData);
+    PackedObject->Indeces = PackBytes(&Writer, IndexSize, Buffer->Indeces);
+    PackedObject->AABB = Object->AABB;
+    ++PackedObject;
+  }
+
+  asset_pack_material* PackedMaterial = (asset_pack_material*) (Writer.Base + Header.Materials);
+  for(u32 Index = 0; Index < Materials->Count; ++Index)
+  {
+    material* Material = (material*) Materials->Values[Index];
+    PackName(Materials->Keys[Index], PackedMaterial->Name);
+    PackedMaterial->Material = *Material;
+    ++PackedMaterial;
+  }
+
+  asset_pack_font* PackedFont = (asset_pack_font*) (Writer.Base + Header.Fonts);
+  for(u32 Index = 0; Index < FontCache->FontCount; ++Index)
+  {
+    cached_font* Font = FontCache->Fonts + Index;
+    PackName(Font->Name, PackedFont->Name);
+    PackedFont->Size = Font->DataSize;
+    PackedFont->Data = PackBytes(&Writer, Font->DataSize, Font->Data);
+    ++PackedFont;
+  }
+
+  Assert(Writer.Used == Writer.Size);
+  *((asset_pack_header*) Writer.Base) = Header;
+
+  thread_context Thread = {};
+  b32 Result = Platform.DEBUGPlatformWriteEntireFile(&Thread, FileName, SafeTruncateToU32(Size), Writer.Base);
+  return Result;
+}
+
+b32 LoadAssetPack(game_asset_manager* AssetManager, c8* FileName)
+{
+  thread_context Thread = {};
+  debug_mapped_file File = Platform.DEBUGPlatformMapFile(&Thread, FileName);
+  if(!File.Contents)
+  {
+    return false;
+  }
+
+  asset_pack_header* Header = (asset_pack_header*) File.Contents;
+  if( File.ContentSize < sizeof(asset_pack_header) ||
+      Header->Magic != ASSET_PACK_MAGIC ||
+      Header->Version != ASSET_PACK_VERSION ||
+      Header->Size != File.ContentSize )
+  {
+    Platform.DEBUGPlatformUnmapFile(&Thread, &File);
+    return false;
+  }
+
+  // Sources that are gone don't count so a pack works without them
+  u8* Base = (u8*) File.Contents;
+  asset_source* Sources = (asset_source*) (Base + Header->Sources);
+  for(u32 Index = 0; Index < Header->SourceCount; ++Index)
+  {
+    asset_source* Source = Sources + Index;
+    u64 WriteTime = Platform.DEBUGPlatformGetFileWriteTime(Source->FileName);
+    if(WriteTime && WriteTime != Source->WriteTime)
+    {
+      Platform.DEBUGPlatformUnmapFile(&Thread, &File);
+      return false;
+    }
+  }
+
+  // Assets are registered with the same functions LoadAssets uses so handles come out the same,
+  // only the payloads point into the mapping instead of being copied.
+
+  asset_pack_bitmap* PackedBitmaps = (asset_pack_bitmap*) (Base + Header->Bitmaps);
+  for(u32 Index = 0; Index < Header->BitmapCount; ++Index)
+  {
+    asset_pack_bitmap* PackedBitmap = PackedBitmaps + Index;
+    u32 HandleValue = 0;
+    bitmap* Bitmap = AllocateBitmap(AssetManager, PackedBitmap->Name, &HandleValue);
+    Bitmap->Special = PackedBitmap->Special;
+    Bitmap->BPP = PackedBitmap->BPP;
+    Bitmap->Width = PackedBitmap->Width;
+    Bitmap->Height = PackedBitmap->Height;
+    Bitmap->Pixels = Base + PackedBitmap->Pixels;
+  }
+
+  Assert(AssetManager->Meshes.Count == 0);
+  asset_pack_mesh* PackedMeshes = (asset_pack_mesh*) (Base + Header->Meshes);
+  for(u32 Index = 0; Index < Header->MeshCount; ++Index)
+  {
+    asset_pack_mesh* PackedMesh = PackedMeshes + Index;
+    u32 HandleValue = 0;
+    mesh_data* Mesh = AllocateMesh(AssetManager, &HandleValue);
+    Mesh->nv = PackedMesh->nv;
+    Mesh->v  = (v3*) (Base + PackedMesh->v);
+  }
+
+  asset_pack_object* PackedObjects = (asset_pack_object*) (Base + Header->Objects);
+  for(u32 Index = 0; Index < Header->ObjectCount; ++Index)
+  {
+    asset_pack_object* PackedObject = PackedObjects + Index;
+    u32 HandleValue = 0;
+    mesh_indeces* Object = AllocateObject(AssetManager, PackedObject->Name, &HandleValue);
+    Assert(PackedObject->MeshIndex < Header->MeshCount);
+    Object->MeshHandle.Value = PackedObject->MeshIndex;
+    Object->Count = PackedObject->Count;
+    Object->vi = (u32*) (Base + PackedObject->vi);
+    Object->VertexCount = PackedObject->VertexCount;
+    Object->Vertices = (opengl_vertex*) (Base + PackedObject->Vertices);
+    Object->Indeces = (u32*) (Base + PackedObject->Indeces);
+    Object->AABB = PackedObject->AABB;
+    str::CopyStrings( str::StringLength( PackedObject->Name ), PackedObject->Name,
+                      ArrayCount( Object->Name ), Object->Name );
+  }
+
+  asset_pack_material* PackedMaterials = (asset_pack_material*) (Base + Header->Materials);
+  for(u32 Index = 0; Index < Header->MaterialCount; ++Index)
+  {
+    asset_pack_material* PackedMaterial = PackedMaterials + Index;
+    PushMaterialData(AssetManager, PackedMaterial->Name, PackedMaterial->Material);
+  }
+
+  asset_pack_font* PackedFonts = (asset_pack_font*) (Base + Header->Fonts);
+  for(u32 Index = 0; Index < Header->FontCount; ++Index)
+  {
+    asset_pack_font* PackedFont = PackedFonts + Index;
+    AddFont(AssetManager->FontCache, PackedFont->Name, Base + PackedFont->Data, PackedFont->Size);
+  }
+
+  // The mapping lives as long as the asset manager
+  AssetManager->AssetPack = File;
+
+  return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "types.h"
+#include "assets.h"
+
+// Binary asset pack.
+// Holds everything LoadAssets produces in the layout the asset manager uses at runtime: objects as
+// deduplicated vertex and index buffers, bitmaps in the pixel format they are uploaded with, font
+// files and materials. The pack is memory mapped and the asset manager points straight into the
+// mapping so startup does no parsing or decoding.
+// The pack is baked on request with the BakeAssets button in the debug settings, once the source
+// assets have finished loading, and is written to data/ next to the other debug output. It is ignored
+// when it has another version or one of the source files it lists was written after it was baked.
+// Bump ASSET_PACK_VERSION when the format changes.
+
+#define ASSET_PACK_MAGIC   (('B' << 0) | ('B' << 8) | ('P' << 16) | ('K' << 24))
+#define ASSET_PACK_VERSION 3
+#define ASSET_PACK_ALIGNMENT 16
+#define ASSET_PACK_NAME_LENGTH 128
+#define ASSET_PACK_PATH "..\\data\\breadboard.pack"
+
+// All offsets are in bytes from the start of the pack
+struct asset_pack_header
+{
+  u32 Magic;
+  u32 Version;
+  u64 Size;
+
+  u32 BitmapCount;
+  u32 MeshCount;
+  u32 ObjectCount;
+  u32 MaterialCount;
+  u32 FontCount;
+  u32 SourceCount;
+
+  u64 Bitmaps;   // asset_pack_bitmap[BitmapCount]
+  u64 Meshes;    // asset_pack_mesh[MeshCount]
+  u64 Objects;   // asset_pack_object[ObjectCount]
+  u64 Materials; // asset_pack_material[MaterialCount]
+  u64 Fonts;     // asset_pack_font[FontCount]
+  u64 Sources;   // asset_source[SourceCount]
+};
+
+struct asset_pack_bitmap
+{
+  c8 Name[ASSET_PACK_NAME_LENGTH];
+  b32 Special;
+  u32 BPP;
+  u32 Width;
+  u32 Height;
+  u64 Pixels;
+};
+
+// Only the positions are kept, colliders use them. Everything else is in the object vertices.
+struct asset_pack_mesh
+{
+  u32 nv;
+  u64 v;
+};
+
+struct asset_pack_object
+{
+  c8 Name[ASSET_PACK_NAME_LENGTH];
+  u32 MeshIndex;
+  u32 Count;
+  u32 VertexCount;
+  u64 vi;         // Position indeces for colliders
+  u64 Vertices;   // opengl_vertex[VertexCount]
+  u64 Indeces;    // u32[Count] into Vertices
+  aabb3f AABB;
+};
+
+struct asset_pack_material
+{
+  c8 Name[ASSET_PACK_NAME_LENGTH];
+  material Material;
+};
+
+// Fonts are stored in the order they were added to the font cache
+struct asset_pack_font
+{
+  c8 Name[ASSET_PACK_NAME_LENGTH];
+  u64 Size;
+  u64 Data;
+};
+
+// Writes all assets currently in the asset manager to a pack.
+b32 WriteAssetPack(game_asset_manager* AssetManager, memory_arena* TempArena, c8* FileName);
+
+// Maps the pack and registers its assets. Returns false if the file is missing or stale.
+b32 LoadAssetPack(game_asset_manager* AssetManager, c8* FileName);
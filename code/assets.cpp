@@ -1,88 +1,189 @@
 #include "assets.h"
+#include "asset_pack.h"
 #include "obj_loader.h"
 #include "utility_macros.h"
 
-void* AllocateValue_(memory_arena* Arena, midx Size, void** Values, u32 Index, u32* Count, u32* MaxCount)
+internal inline u32
+GetProbeDistance(asset_hash_map* HashMap, u64 Hash, u32 Slot)
+{
+  u32 Result = (Slot - (u32) Hash) & HashMap->SlotMask;
+  return Result;
+}
+
+internal void
+InsertSlot(asset_hash_map* HashMap, u64 Hash, u32 Handle)
 {
-  Assert(*Count < *MaxCount);
-  void* Result = Values[Index];
-  if (Arena && !Result)
+  u32 Slot = (u32) Hash & HashMap->SlotMask;
+  u32 Distance = 0;
+  while(HashMap->SlotHashes[Slot])
   {
-    (*Count)++;
-    Assert(*Count < *MaxCount);
-    Result = PushSize(Arena, Size);
-    Values[Index] = Result;
+    // Robin Hood: take the slot from entries closer to their home slot than we are to ours
+    u32 SlotDistance = GetProbeDistance(HashMap, HashMap->SlotHashes[Slot], Slot);
+    if(SlotDistance < Distance)
+    {
+      u64 SwapHash = HashMap->SlotHashes[Slot];
+      u32 SwapHandle = HashMap->SlotHandles[Slot];
+      HashMap->SlotHashes[Slot] = Hash;
+      HashMap->SlotHandles[Slot] = Handle;
+      Hash = SwapHash;
+      Handle = SwapHandle;
+      Distance = SlotDistance;
+    }
+    Slot = (Slot + 1) & HashMap->SlotMask;
+    ++Distance;
   }
+  HashMap->SlotHashes[Slot] = Hash;
+  HashMap->SlotHandles[Slot] = Handle;
+}
 
-  return Result;
+internal void
+ResizeSlots(memory_arena* Arena, asset_hash_map* HashMap, u32 SlotCount)
+{
+  Assert((SlotCount & (SlotCount - 1)) == 0);
+  u32 OldSlotCount = HashMap->SlotHashes ? HashMap->SlotMask + 1 : 0;
+  u64* OldSlotHashes = HashMap->SlotHashes;
+  u32* OldSlotHandles = HashMap->SlotHandles;
+
+  HashMap->SlotMask = SlotCount - 1;
+  HashMap->SlotHashes = PushArray(Arena, SlotCount, u64);
+  HashMap->SlotHandles = PushArray(Arena, SlotCount, u32, NoClear());
+  for(u32 Slot = 0; Slot < OldSlotCount; ++Slot)
+  {
+    if(OldSlotHashes[Slot])
+    {
+      InsertSlot(HashMap, OldSlotHashes[Slot], OldSlotHandles[Slot]);
+    }
+  }
 }
 
+internal void
+InitializeAssetHashMap(memory_arena* Arena, asset_hash_map* HashMap, u32 MaxCount)
+{
+  *HashMap = {};
+  HashMap->MaxCount = MaxCount;
+  HashMap->Keys = PushArray(Arena, MaxCount, c8*);
+  HashMap->Values = PushArray(Arena, MaxCount, void*);
+  u32 SlotCount = 16;
+  while(SlotCount < 2 * MaxCount)
+  {
+    SlotCount *= 2;
+  }
+  ResizeSlots(Arena, HashMap, SlotCount);
+}
 
-#define AllocateMesh(AssetManager, Index) (mesh_data*) AllocateValue_(&AssetManager->AssetArena, sizeof(mesh_data), AssetManager->Meshes.Values, Index, &AssetManager->Meshes.Count, &AssetManager->Meshes.MaxCount);
-#define AllocateBitmap(AssetManager, Index) (bitmap*) AllocateValue_(&AssetManager->AssetArena, sizeof(bitmap), AssetManager->Bitmaps.Values, Index, &AssetManager->Bitmaps.Count, &AssetManager->Bitmaps.MaxCount);
-#define AllocateObject(AssetManager, Index) (mesh_indeces*) AllocateValue_(&AssetManager->AssetArena, sizeof(mesh_indeces), AssetManager->Objects.Values, Index, &AssetManager->Objects.Count, &AssetManager->Objects.MaxCount);
-#define AllocateMaterial(AssetManager, Index) (material*) AllocateValue_(&AssetManager->AssetArena, sizeof(material), AssetManager->Materials.Values, Index, &AssetManager->Materials.Count, &AssetManager->Materials.MaxCount);
+u32 FindAsset(asset_hash_map* HashMap, asset_key Key)
+{
+  u32 Slot = (u32) Key.Hash & HashMap->SlotMask;
+  u32 Distance = 0;
+  while(true)
+  {
+    u64 SlotHash = HashMap->SlotHashes[Slot];
+    if(SlotHash == Key.Hash)
+    {
+      u32 Result = HashMap->SlotHandles[Slot];
+#if HANDMADE_SLOW
+      // Only slow builds compare the name, other lookups do no string work
+      Assert(str::ExactlyEquals(HashMap->Keys[Result], Key.String));
+#endif
+      return Result;
+    }
+    // We would have been placed before any entry closer to its home slot than we are
+    if(!SlotHash || GetProbeDistance(HashMap, SlotHash, Slot) < Distance)
+    {
+      return ASSET_NOT_FOUND;
+    }
+    Slot = (Slot + 1) & HashMap->SlotMask;
+    ++Distance;
+  }
+}
 
-u32 StringToIndex(asset_hash_map* HashMap, c8* Key)
+// Adds the key and pushes a cleared value of ValueSize. Returns the new handle.
+internal u32
+InsertAsset(memory_arena* Arena, asset_hash_map* HashMap, asset_key Key, midx ValueSize)
 {
-  Assert(Key);
-  Assert(str::StringLength(Key) > 0);
+  Assert(Key.String);
+  Assert(str::StringLength(Key.String) > 0);
+  // Also catches two names with the same hash, which lookups could not tell apart
+  Assert(FindAsset(HashMap, Key) == ASSET_NOT_FOUND);
 
-  const u32 StartIndex = utils::djb2_hash(Key) % HashMap->MaxCount;
+  if(HashMap->Count == HashMap->MaxCount)
+  {
+    u32 NewMaxCount = 2 * HashMap->MaxCount;
+    HashMap->Keys = GrowArray(Arena, HashMap->Keys, HashMap->MaxCount, NewMaxCount, c8*);
+    HashMap->Values = GrowArray(Arena, HashMap->Values, HashMap->MaxCount, NewMaxCount, void*);
+    HashMap->MaxCount = NewMaxCount;
+  }
 
-  u32 Index = StartIndex;
-  c8* MapKey = HashMap->Keys[StartIndex];
-  while(MapKey && !str::Equals(Key, MapKey))
+  u32 SlotCount = HashMap->SlotMask + 1;
+  if(4 * (HashMap->Count + 1) > 3 * SlotCount)
   {
-    ++Index;
-    Index = Index % HashMap->MaxCount;
-    MapKey = HashMap->Keys[Index];
-    Assert(Index != StartIndex);
+    ResizeSlots(Arena, HashMap, 2 * SlotCount);
   }
-  return Index;
-}
 
-internal inline b32
-IsKeySet(asset_hash_map* HashMap, u32 Index)
-{
-  return HashMap->Keys[Index] != nullptr;
+  u32 Handle = HashMap->Count++;
+  HashMap->Keys[Handle] = (c8*) PushCopy(Arena, str::StringLength(Key.String) + 1, (void*) Key.String, NoClear());
+  HashMap->Values[Handle] = PushSize(Arena, ValueSize);
+  InsertSlot(HashMap, Key.Hash, Handle);
+  return Handle;
 }
 
-internal inline void
-SetKey(memory_arena* Arena, asset_hash_map* HashMap, u32 Index, c8* Key)
+internal bitmap*
+AllocateBitmap(game_asset_manager* AssetManager, asset_key Key, u32* Handle)
 {
-  Assert(Key);
-  Assert(!IsKeySet(HashMap, Index));
-  c8* dst = (c8*) PushCopy(Arena, str::StringLength(Key)*sizeof(c8), Key);
-  HashMap->Keys[Index] = dst;
+  asset_hash_map* Bitmaps = &AssetManager->Bitmaps;
+  u32 MaxCount = Bitmaps->MaxCount;
+  *Handle = InsertAsset(&AssetManager->AssetArena, Bitmaps, Key, sizeof(bitmap));
+  if(Bitmaps->MaxCount != MaxCount)
+  {
+    AssetManager->BitmapKeeper = GrowArray(&AssetManager->AssetArena, AssetManager->BitmapKeeper, MaxCount, Bitmaps->MaxCount, bitmap_keeper);
+  }
+  bitmap* Result = (bitmap*) Bitmaps->Values[*Handle];
+  return Result;
 }
 
-internal inline u32
-GetObjectAssetIndex(game_asset_manager* AssetManager, c8* Key)
+internal mesh_indeces*
+AllocateObject(game_asset_manager* AssetManager, asset_key Key, u32* Handle)
 {
-  u32 Result = StringToIndex(&AssetManager->Objects, Key);
+  asset_hash_map* Objects = &AssetManager->Objects;
+  u32 MaxCount = Objects->MaxCount;
+  *Handle = InsertAsset(&AssetManager->AssetArena, Objects, Key, sizeof(mesh_indeces));
+  if(Objects->MaxCount != MaxCount)
+  {
+    AssetManager->ObjectKeeper = GrowArray(&AssetManager->AssetArena, AssetManager->ObjectKeeper, MaxCount, Objects->MaxCount, buffer_keeper);
+  }
+  mesh_indeces* Result = (mesh_indeces*) Objects->Values[*Handle];
   return Result;
 }
-internal inline u32
-GetMaterialAssetIndex(game_asset_manager* AssetManager, c8* Key)
+
+internal material*
+AllocateMaterial(game_asset_manager* AssetManager, asset_key Key, u32* Handle)
 {
-  u32 Result = StringToIndex(&AssetManager->Materials, Key);
+  *Handle = InsertAsset(&AssetManager->AssetArena, &AssetManager->Materials, Key, sizeof(material));
+  material* Result = (material*) AssetManager->Materials.Values[*Handle];
   return Result;
 }
-internal inline u32
-GetBitmapAssetIndex(game_asset_manager* AssetManager, c8* Key)
+
+internal mesh_data*
+AllocateMesh(game_asset_manager* AssetManager, u32* Handle)
 {
-  u32 Result = StringToIndex(&AssetManager->Bitmaps, Key);
+  asset_vector* Meshes = &AssetManager->Meshes;
+  if(Meshes->Count == Meshes->MaxCount)
+  {
+    u32 NewMaxCount = 2 * Meshes->MaxCount;
+    Meshes->Values = GrowArray(&AssetManager->AssetArena, Meshes->Values, Meshes->MaxCount, NewMaxCount, void*);
+    Meshes->MaxCount = NewMaxCount;
+  }
+  *Handle = Meshes->Count++;
+  mesh_data* Result = PushStruct(&AssetManager->AssetArena, mesh_data);
+  Meshes->Values[*Handle] = Result;
   return Result;
 }
 
 internal bitmap_handle
-PushBitmapData(game_asset_manager* AssetManager, c8* Key, u32 Width, u32 Height, u32 BPP, void* PixelData, b32 IsSpecial)
+PushBitmapData(game_asset_manager* AssetManager, asset_key Key, u32 Width, u32 Height, u32 BPP, void* PixelData, b32 IsSpecial)
 {
   bitmap_handle Handle = {};
-  Handle.Value = GetBitmapAssetIndex(AssetManager, Key);
-  SetKey(&AssetManager->AssetArena, &AssetManager->Bitmaps, Handle.Value, Key);
-  bitmap* Bitmap = AllocateBitmap(AssetManager, Handle.Value);
+  bitmap* Bitmap = AllocateBitmap(AssetManager, Key, &Handle.Value);
   Bitmap->BPP = BPP;
   Bitmap->Special = IsSpecial;
   Bitmap->Width = Width;
@@ -90,7 +191,7 @@ PushBitmapData(game_asset_manager* AssetManager, c8* Key, u32 Width, u32 Height,
   midx MemorySize = Width * Height * BPP / 8;
   if(PixelData)
   {
-    Bitmap->Pixels = PushCopy(&AssetManager->AssetArena, MemorySize, PixelData);
+    Bitmap->Pixels = PushCopy(&AssetManager->AssetArena, MemorySize, PixelData, NoClear());
   }else{
     Bitmap->Pixels = PushSize(&AssetManager->AssetArena, MemorySize);
   }
@@ -101,62 +202,229 @@ internal mesh_handle
 PushMeshData(game_asset_manager* AssetManager, u32 nv, v3* v, u32 nvn, v3* vn, u32 nvt, v2* vt)
 {
   mesh_handle Handle = {};
-  Handle.Value = AssetManager->Meshes.Count;
-  Assert(AssetManager->Meshes.Count < AssetManager->Meshes.MaxCount);
-  mesh_data* Data = AllocateMesh(AssetManager, Handle.Value);
+  mesh_data* Data = AllocateMesh(AssetManager, &Handle.Value);
   Data->nv  = nv;    // Nr Verices
   Data->nvn = nvn;   // Nr Vertice Normals
   Data->nvt = nvt;   // Nr Trxture Vertices
-  Data->v  = (v3*) PushCopy(&AssetManager->AssetArena, nv*sizeof(v3), v);
-  Data->vn = (v3*) PushCopy(&AssetManager->AssetArena, nvn*sizeof(v3), vn);
-  Data->vt = (v2*) PushCopy(&AssetManager->AssetArena, nvt*sizeof(v2), vt);
+  Data->v  = (v3*) PushCopy(&AssetManager->AssetArena, nv*sizeof(v3), v, NoClear());
+  Data->vn = (v3*) PushCopy(&AssetManager->AssetArena, nvn*sizeof(v3), vn, NoClear());
+  Data->vt = (v2*) PushCopy(&AssetManager->AssetArena, nvt*sizeof(v2), vt, NoClear());
   return Handle;
 }
 
 internal object_handle
-PushIndexData(game_asset_manager* AssetManager, c8* Key, mesh_handle MeshHandle, u32 Count, u32* vi, u32* ti, u32* ni, aabb3f AABB)
+PushIndexData(game_asset_manager* AssetManager, asset_key Key, mesh_handle MeshHandle, u32 Count, u32* vi, u32* ti, u32* ni, aabb3f AABB)
 {
   object_handle Handle = {};
-
-  Handle.Value = GetObjectAssetIndex(AssetManager, Key);
-  SetKey(&AssetManager->AssetArena, &AssetManager->Objects, Handle.Value, Key);
-  mesh_indeces* Indeces = AllocateObject(AssetManager, Handle.Value);
+  mesh_indeces* Indeces = AllocateObject(AssetManager, Key, &Handle.Value);
   Indeces->MeshHandle = MeshHandle;
   Indeces->Count  = Count;
-  Indeces->vi = (u32*) PushCopy(&AssetManager->AssetArena, Count * sizeof(u32), vi);
+  Indeces->vi = (u32*) PushCopy(&AssetManager->AssetArena, Count * sizeof(u32), vi, NoClear());
   if(ti)
   {
-    Indeces->ti = (u32*) PushCopy(&AssetManager->AssetArena, Count * sizeof(u32), ti);
+    Indeces->ti = (u32*) PushCopy(&AssetManager->AssetArena, Count * sizeof(u32), ti, NoClear());
   }
   if(ni)
   {
-    Indeces->ni = (u32*) PushCopy(&AssetManager->AssetArena, Count * sizeof(u32), ni);
+    Indeces->ni = (u32*) PushCopy(&AssetManager->AssetArena, Count * sizeof(u32), ni, NoClear());
   }
   Indeces->AABB = AABB;
-  str::CopyStrings( str::StringLength( Key ), Key,
+  str::CopyStrings( str::StringLength( Key.String ), (c8*) Key.String,
                     ArrayCount( Indeces->Name ), Indeces->Name );
   return Handle;
 }
 
+b32 CompareU32Triplet( const u8* DataA, const  u8* DataB)
+{
+  u32* U32A = (u32*) DataA;
+  const u32 A1 = *(U32A+0);
+  const u32 A2 = *(U32A+1);
+  const u32 A3 = *(U32A+2);
+  
+  u32* U32B = (u32*) DataB;
+  const u32 B1 = *(U32B+0);
+  const u32 B2 = *(U32B+1);
+  const u32 B3 = *(U32B+2);
+  
+  return (A1 == B1) && (A2 == B2) && (A3 == B3);
+}
+
+// Mixes the three indices of a vertex/texture/normal triplet into a hash
+internal inline u32
+HashU32Triplet( u32 A, u32 B, u32 C )
+{
+  u64 Key = ((u64) A * 0x9E3779B97F4A7C15) ^
+            ((u64) B * 0xC2B2AE3D27D4EB4F) ^
+            ((u64) C * 0x165667B19E3779F9);
+  Key ^= Key >> 29;
+  return (u32) Key;
+}
+
+// One interleaved vertex per unique vertex/texture/normal triplet. Used by the GL upload and
+// when baking objects into the asset pack.
+struct gl_vertex_buffer
+{
+  u32 IndexCount;
+  u32* Indeces;
+  u32 VertexCount;
+  opengl_vertex* VertexData;
+};
+
+internal gl_vertex_buffer
+CreateGLVertexBuffer( memory_arena* TemporaryMemory,
+                     const u32 IndexCount,
+                     const u32* VerticeIndeces, const u32* TextureIndeces, const u32* NormalIndeces,
+                     const v3* VerticeData,     const v2* TextureData,     const v3* NormalData)
+{
+  Assert(VerticeIndeces && VerticeData);
+  u32* GLVerticeIndexArray  = PushArray(TemporaryMemory, 3*IndexCount, u32, NoClear());
+  u32* GLIndexArray         = PushArray(TemporaryMemory, IndexCount, u32, NoClear());
+
+  // Open addressed table mapping a triplet to its vertex, slots hold vertex index + 1 and 0 means empty.
+  // Kept at most half full so the linear probes stay short.
+  u32 SlotCount = 1;
+  while(SlotCount < 2*IndexCount)
+  {
+    SlotCount <<= 1;
+  }
+  u32 SlotMask = SlotCount - 1;
+  u32* Slots = PushArray(TemporaryMemory, SlotCount, u32);
+
+  u32 VerticeArrayCount = 0;
+  for( u32 i = 0; i < IndexCount; ++i )
+  {
+    const u32 vidx = VerticeIndeces[i];
+    const u32 tidx = TextureIndeces ? TextureIndeces[i] : 0;
+    const u32 nidx = NormalIndeces  ? NormalIndeces[i]  : 0;
+    u32 NewElement[3] = {vidx, tidx, nidx};
+
+    u32 Slot = HashU32Triplet(vidx, tidx, nidx) & SlotMask;
+    while(Slots[Slot] && !CompareU32Triplet((u8*) NewElement, (u8*)(GLVerticeIndexArray + 3 * (Slots[Slot]-1))))
+    {
+      Slot = (Slot + 1) & SlotMask;
+    }
+
+    if(!Slots[Slot])
+    {
+      CopyArray(3, NewElement, GLVerticeIndexArray + 3 * VerticeArrayCount);
+      Slots[Slot] = ++VerticeArrayCount;
+    }
+
+    GLIndexArray[i] = Slots[Slot]-1;
+  }
+  
+  opengl_vertex* VertexData = PushArray(TemporaryMemory, VerticeArrayCount, opengl_vertex, NoClear());
+  opengl_vertex* Vertice = VertexData;
+  for( u32 i = 0; i < VerticeArrayCount; ++i )
+  {
+    const u32 vidx = *(GLVerticeIndexArray + 3 * i + 0);
+    const u32 tidx = *(GLVerticeIndexArray + 3 * i + 1);
+    const u32 nidx = *(GLVerticeIndexArray + 3 * i + 2);
+    Vertice->v  = VerticeData[vidx];
+    Vertice->vt = TextureData ? TextureData[tidx] : V2(0,0);
+    Vertice->vn = NormalData  ? NormalData[nidx]  : V3(0,0,0);
+    ++Vertice;
+  }
+  
+  gl_vertex_buffer Result = {};
+  Result.IndexCount = IndexCount;
+  Result.Indeces = GLIndexArray;
+  Result.VertexCount = VerticeArrayCount;
+  Result.VertexData = VertexData;
+  return Result;
+}
+
 internal void
-PushMaterialData(game_asset_manager* AssetManager, c8* Key, material SrcMaterial)
+PushMaterialData(game_asset_manager* AssetManager, asset_key Key, material SrcMaterial)
 {
-  u32 Index = GetMaterialAssetIndex(AssetManager, Key);
-  SetKey(&AssetManager->AssetArena, &AssetManager->Materials, Index, Key);
-  material* DstMaterial = AllocateMaterial(AssetManager, Index);
+  u32 Handle = 0;
+  material* DstMaterial = AllocateMaterial(AssetManager, Key, &Handle);
   *DstMaterial = SrcMaterial;
 }
 
-void GetHandle(game_asset_manager* AssetManager, char* Key, bitmap_handle* Handle)
+internal void
+PushPendingUpload(game_asset_manager* AssetManager, asset_type Type, u32 Handle)
+{
+  Assert(AssetManager->PendingUploadCount < MAX_PENDING_UPLOAD_COUNT);
+  u32 Index = (AssetManager->PendingUploadFirst + AssetManager->PendingUploadCount) % MAX_PENDING_UPLOAD_COUNT;
+  AssetManager->PendingUpload[Index].Handle = Handle;
+  AssetManager->PendingUpload[Index].Type = Type;
+  ++AssetManager->PendingUploadCount;
+}
+
+b32 PopPendingUpload(game_asset_manager* AssetManager, pending_asset* Result)
 {
-  Assert(Key && Handle);
-  Handle->Value = GetBitmapAssetIndex(AssetManager, Key);
+  if(!AssetManager->PendingUploadCount)
+  {
+    return false;
+  }
+  *Result = AssetManager->PendingUpload[AssetManager->PendingUploadFirst];
+  AssetManager->PendingUploadFirst = (AssetManager->PendingUploadFirst + 1) % MAX_PENDING_UPLOAD_COUNT;
+  --AssetManager->PendingUploadCount;
+  return true;
+}
+
+b32 IsUploadPending(game_asset_manager* AssetManager, asset_type Type, u32 Handle)
+{
+  for(u32 Index = 0; Index < AssetManager->PendingUploadCount; ++Index)
+  {
+    pending_asset* PendingAsset = AssetManager->PendingUpload + (AssetManager->PendingUploadFirst + Index) % MAX_PENDING_UPLOAD_COUNT;
+    if(PendingAsset->Type == Type && PendingAsset->Handle == Handle)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+midx GetUploadSize(game_asset_manager* AssetManager, pending_asset PendingAsset)
+{
+  midx Result = 0;
+  switch(PendingAsset.Type)
+  {
+    case asset_type::OBJECT:
+    {
+      mesh_indeces* Object = ((mesh_indeces**) AssetManager->Objects.Values)[PendingAsset.Handle];
+      if(Object->Vertices)
+      {
+        Result = Object->VertexCount * sizeof(opengl_vertex) + Object->Count * sizeof(u32);
+      }else{
+        // One interleaved vertex and one index per corner at most
+        Result = Object->Count * (sizeof(opengl_vertex) + sizeof(u32));
+      }
+    }break;
+    case asset_type::BITMAP:
+    {
+      bitmap* Bitmap = ((bitmap**) AssetManager->Bitmaps.Values)[PendingAsset.Handle];
+      bitmap_keeper* BitmapKeeper = AssetManager->BitmapKeeper + PendingAsset.Handle;
+      midx PixelCount = BitmapKeeper->UseSubRegion ?
+        (midx) (BitmapKeeper->SubRegion.W * BitmapKeeper->SubRegion.H) :
+        (midx) Bitmap->Width * Bitmap->Height;
+      Result = PixelCount * Bitmap->BPP / 8;
+    }break;
+    default:
+    {
+      INVALID_CODE_PATH
+    }
+  }
+  return Result;
+}
+
+void GetHandle(game_asset_manager* AssetManager, asset_key Key, bitmap_handle* Handle)
+{
+  Assert(Key.String && Handle);
+  Handle->Value = FindAsset(&AssetManager->Bitmaps, Key);
+  Assert(Handle->Value != ASSET_NOT_FOUND);
 
   bitmap_keeper* BitmapKeeper =  AssetManager->BitmapKeeper + Handle->Value;
   if(!BitmapKeeper->Referenced)
   {
     BitmapKeeper->Referenced = true;
-    AssetManager->BitmapPendingLoad[AssetManager->BitmapPendingLoadCount++] = *Handle;
+    // Streaming bitmaps are queued for upload once their pixels arrive, missing ones never are
+    if(!BitmapKeeper->Streaming && !BitmapKeeper->Missing)
+    {
+      PushPendingUpload(AssetManager, asset_type::BITMAP, Handle->Value);
+    }
   }
 }
 
@@ -166,7 +434,7 @@ void Reupload(game_asset_manager* AssetManager, bitmap_handle Handle, rect2f Sub
   BitmapKeeper->Referenced = true;
   BitmapKeeper->UseSubRegion = true;
   BitmapKeeper->SubRegion = SubRegion;
-  AssetManager->BitmapPendingLoad[AssetManager->BitmapPendingLoadCount++] = Handle;
+  PushPendingUpload(AssetManager, asset_type::BITMAP, Handle.Value);
 }
 
 void Reupload(game_asset_manager* AssetManager, bitmap_handle Handle)
@@ -174,32 +442,34 @@ void Reupload(game_asset_manager* AssetManager, bitmap_handle Handle)
   bitmap_keeper* BitmapKeeper = AssetManager->BitmapKeeper + Handle.Value;
   BitmapKeeper->Referenced = true;
   BitmapKeeper->UseSubRegion = false;
-  AssetManager->BitmapPendingLoad[AssetManager->BitmapPendingLoadCount++] = Handle;
+  PushPendingUpload(AssetManager, asset_type::BITMAP, Handle.Value);
 }
 
-void GetHandle(game_asset_manager* AssetManager, char* Key, object_handle* Handle)
+void GetHandle(game_asset_manager* AssetManager, asset_key Key, object_handle* Handle)
 {
-  Assert(Key && Handle);
-  Handle->Value = GetObjectAssetIndex(AssetManager, Key);
+  Assert(Key.String && Handle);
+  Handle->Value = FindAsset(&AssetManager->Objects, Key);
+  Assert(Handle->Value != ASSET_NOT_FOUND);
 
   buffer_keeper* ObjectKeeper = AssetManager->ObjectKeeper + Handle->Value;
   if(!ObjectKeeper->Referenced)
   {
     ObjectKeeper->Referenced = true;
-    AssetManager->ObjectPendingLoad[AssetManager->ObjectPendingLoadCount++] = *Handle;
+    PushPendingUpload(AssetManager, asset_type::OBJECT, Handle->Value);
   }
 }
-void GetHandle(game_asset_manager* AssetManager, char* Key, material_handle* Handle)
+void GetHandle(game_asset_manager* AssetManager, asset_key Key, material_handle* Handle)
 {
-  Assert(Key && Handle);
-  Handle->Value = GetMaterialAssetIndex(AssetManager, Key);
+  Assert(Key.String && Handle);
+  Handle->Value = FindAsset(&AssetManager->Materials, Key);
+  Assert(Handle->Value != ASSET_NOT_FOUND);
 }
 
 
 inline mesh_indeces*
 GetAsset(game_asset_manager* AssetManager, object_handle Handle, buffer_keeper** Keeper)
 {
-  Assert(Handle.Value < AssetManager->Objects.MaxCount);
+  Assert(Handle.Value < AssetManager->Objects.Count);
   mesh_indeces** Objects = (mesh_indeces**) AssetManager->Objects.Values;
   mesh_indeces* Result = Objects[Handle.Value];
   Assert(Result);
@@ -226,7 +496,7 @@ GetAsset(game_asset_manager* AssetManager, mesh_handle Handle)//, buffer_keeper*
 inline material*
 GetAsset(game_asset_manager* AssetManager, material_handle Handle)
 {
-  Assert(Handle.Value < AssetManager->Materials.MaxCount);
+  Assert(Handle.Value < AssetManager->Materials.Count);
   material** Materials = (material**) AssetManager->Materials.Values;
   material* Result = Materials[Handle.Value];
   Assert(Result);
@@ -235,14 +505,19 @@ GetAsset(game_asset_manager* AssetManager, material_handle Handle)
 inline bitmap*
 GetAsset(game_asset_manager* AssetManager, bitmap_handle Handle, bitmap_keeper** Keeper)
 {
-  Assert(Handle.Value < AssetManager->Bitmaps.MaxCount);
+  Assert(Handle.Value < AssetManager->Bitmaps.Count);
+  bitmap_keeper* BitmapKeeper = AssetManager->BitmapKeeper + Handle.Value;
+  Assert(BitmapKeeper->Referenced);
+  if(BitmapKeeper->Streaming || BitmapKeeper->Missing)
+  {
+    Handle = AssetManager->PlaceholderBitmap;
+    BitmapKeeper = AssetManager->BitmapKeeper + Handle.Value;
+  }
+
   bitmap** Bitmaps = (bitmap**) AssetManager->Bitmaps.Values;
   bitmap* Result = Bitmaps[Handle.Value];
 
   Assert(Result);
-
-  bitmap_keeper* BitmapKeeper = AssetManager->BitmapKeeper + Handle.Value;
-  Assert(BitmapKeeper->Referenced);
   if(Keeper) *Keeper = BitmapKeeper;
 
   return Result;
@@ -274,3 +549,102 @@ GetEnumeratedObjectHandle(game_asset_manager* AssetManager, predefined_mesh Mesh
   return Result;
 }
 
+PLATFORM_WORK_QUEUE_CALLBACK(LoadBitmapWork)
+{
+  asset_load_job* Job = (asset_load_job*) Data;
+  Job->Result = LoadTGA(&Job->Arena, Job->FileName);
+
+  // Push onto the completed list, workers may race each other here
+  asset_load_job* volatile* Head = &Job->AssetManager->CompletedLoads;
+  asset_load_job* Expected = 0;
+  do
+  {
+    Expected = *Head;
+    Job->Next = Expected;
+  } while(AtomicCompareExchangePointer((void* volatile*) Head, Job, Expected) != Expected);
+}
+
+void AddAssetSource(game_asset_manager* AssetManager, c8* FileName)
+{
+  Assert(AssetManager->SourceCount < ArrayCount(AssetManager->Sources));
+  asset_source* Source = AssetManager->Sources + AssetManager->SourceCount++;
+  str::CopyStrings(str::StringLength(FileName), FileName, ArrayCount(Source->FileName)-1, Source->FileName);
+  Source->WriteTime = Platform.DEBUGPlatformGetFileWriteTime(FileName);
+}
+
+bitmap_handle LoadBitmapAsync(game_asset_manager* AssetManager, asset_key Key, c8* FileName, b32 IsSpecial)
+{
+  AddAssetSource(AssetManager, FileName);
+
+  bitmap_handle Handle = {};
+  bitmap* Bitmap = AllocateBitmap(AssetManager, Key, &Handle.Value);
+  Bitmap->Special = IsSpecial;
+
+  bitmap_keeper* BitmapKeeper = AssetManager->BitmapKeeper + Handle.Value;
+  BitmapKeeper->Streaming = true;
+
+  asset_load_job* Job = AssetManager->FreeLoadJobs;
+  if(Job)
+  {
+    AssetManager->FreeLoadJobs = Job->Next;
+  }else{
+    Job = PushStruct(&AssetManager->AssetArena, asset_load_job);
+  }
+  Job->AssetManager = AssetManager;
+  Job->Handle = Handle;
+  Job->Result = 0;
+  Job->Next = 0;
+  str::CopyStrings(str::StringLength(FileName), FileName, ArrayCount(Job->FileName)-1, Job->FileName);
+
+  ++AssetManager->LoadsInFlight;
+  Platform.PlatformAddEntry(Platform.LowPriorityQueue, LoadBitmapWork, Job);
+
+  return Handle;
+}
+
+void ProcessCompletedAssetLoads(game_asset_manager* AssetManager)
+{
+  TIMED_FUNCTION();
+  asset_load_job* Job = (asset_load_job*) AtomicExchangePointer((void**) &AssetManager->CompletedLoads, 0);
+  while(Job)
+  {
+    asset_load_job* Next = Job->Next;
+
+    bitmap* Bitmap = ((bitmap**) AssetManager->Bitmaps.Values)[Job->Handle.Value];
+    bitmap_keeper* BitmapKeeper = AssetManager->BitmapKeeper + Job->Handle.Value;
+    BitmapKeeper->Streaming = false;
+
+    // A missing or empty file leaves the null bitmap in place and never reaches the gpu
+    bitmap* Loaded = Job->Result;
+    BitmapKeeper->Missing = !Loaded;
+    if(Loaded)
+    {
+      Bitmap->BPP = Loaded->BPP;
+      Bitmap->Width = Loaded->Width;
+      Bitmap->Height = Loaded->Height;
+      Bitmap->Pixels = Loaded->Pixels;
+
+      // The pixels stay where the worker wrote them, the job starts over with an empty arena
+      Assert(!BitmapKeeper->PixelArena.CurrentBlock);
+      BitmapKeeper->PixelArena = Job->Arena;
+      Job->Arena = {};
+      if(BitmapKeeper->Referenced)
+      {
+        PushPendingUpload(AssetManager, asset_type::BITMAP, Job->Handle.Value);
+      }
+    }
+
+    Job->Next = AssetManager->FreeLoadJobs;
+    AssetManager->FreeLoadJobs = Job;
+    Assert(AssetManager->LoadsInFlight);
+    --AssetManager->LoadsInFlight;
+
+    Job = Next;
+  }
+
+  if(AssetManager->BakeAssetPack && !AssetManager->LoadsInFlight)
+  {
+    AssetManager->BakeAssetPack = false;
+    WriteAssetPack(AssetManager, GlobalGameState->TransientArena, ASSET_PACK_PATH);
+  }
+}
@@ -31,6 +31,9 @@ struct bitmap_handle
 struct bitmap_keeper
 {
   b32 Loaded;
+  b32 Streaming;  // Pixels are still being loaded, GetAsset returns the placeholder
+  b32 Missing;    // The file could not be read, GetAsset keeps returning the placeholder
+  b32 Runtime;    // Filled in while running, not written to the asset pack
   u32 TextureHandle;
 
   u32 TextureSlot;
@@ -39,6 +42,8 @@ struct bitmap_keeper
 
   b32 UseSubRegion;
   rect2f SubRegion;
+
+  memory_arena PixelArena; // Streamed bitmaps keep the arena their load job decoded them into
 };
 
 struct buffer_keeper
@@ -81,6 +86,11 @@ struct mesh_indeces
   u32* ti;    // Texture Indeces
   u32* ni;    // Normal Indeces
   aabb3f AABB;
+
+  // Objects from the asset pack are uploaded as they are, they have no ti and ni
+  u32 VertexCount;
+  opengl_vertex* Vertices;
+  u32* Indeces;
   char Name[128];
 };
 
@@ -104,19 +114,7 @@ material CreateMaterial( v4 AmbientColor, v4 DiffuseColor, v4 SpecularColor, r32
   return Result;
 }
 
-struct stb_font_map
-{
-  s32 StartChar;
-  s32 NumChars;
-  r32 FontHeightPx;
-
-  r32 Ascent;
-  r32 Descent;
-  r32 LineGap;
-
-  bitmap_handle BitmapHandle;
-  stbtt_bakedchar* CharData;
-};
+struct font_cache;
 
 enum class asset_type
 {
@@ -142,12 +140,51 @@ struct asset_vector
   void** Values;
 };
 
+// 64 bit FNV-1a. Zero marks an empty slot in asset_hash_map so it is never returned.
+constexpr u64 HashAssetName(const c8* String)
+{
+  u64 Hash = 0xcbf29ce484222325ull;
+  while(*String)
+  {
+    Hash = (Hash ^ (u8) *String++) * 0x100000001b3ull;
+  }
+  return Hash ? Hash : 1;
+}
+
+template<u64 Value>
+struct compile_time_hash
+{
+  static constexpr u64 Hash = Value;
+};
+
+// Asset name together with its hash. Strings are hashed when converted, literals wrapped in
+// AssetKey() are hashed at compile time.
+struct asset_key
+{
+  u64 Hash;
+  const c8* String;
+
+  asset_key(const c8* KeyString) : Hash(HashAssetName(KeyString)), String(KeyString) {}
+  constexpr asset_key(u64 KeyHash, const c8* KeyString) : Hash(KeyHash), String(KeyString) {}
+};
+
+#define AssetKey(Literal) asset_key(compile_time_hash<HashAssetName(Literal)>::Hash, Literal)
+
+#define ASSET_NOT_FOUND 0xFFFFFFFF
+
+// Assets are stored densely in insertion order and handles index Keys and Values directly.
+// Names are found through a Robin Hood table of (hash, handle) slots that grows at 3/4 load.
+// Probes only compare hashes, colliding names are caught when inserted.
 struct asset_hash_map
 {
   u32 Count;
   u32 MaxCount;
-  c8* Keys[64];
+  c8** Keys;
   void** Values;
+
+  u32 SlotMask;       // Slot count - 1, slot count is a power of two
+  u64* SlotHashes;    // Zero for empty slots
+  u32* SlotHandles;
 };
 
 struct pending_asset
@@ -156,6 +193,33 @@ struct pending_asset
   asset_type Type;
 };
 
+// A bitmap decoded by a worker thread into its own arena.
+// Finished jobs are pushed lock free onto CompletedLoads and picked up by the main thread.
+struct game_asset_manager;
+struct asset_load_job
+{
+  game_asset_manager* AssetManager;
+  bitmap_handle Handle;
+  c8 FileName[256];
+
+  memory_arena Arena;
+  bitmap* Result;
+
+  asset_load_job* Next;
+};
+
+// A file assets were loaded from and its write time when it was read.
+// The asset pack is rebaked when any of them changed.
+struct asset_source
+{
+  c8 FileName[256];
+  u64 WriteTime;
+};
+
+#define MAX_ASSET_SOURCE_COUNT 32
+#define MAX_PENDING_UPLOAD_COUNT 1024
+#define DEFAULT_UPLOAD_BUDGET_BYTES Megabytes(4)
+
 struct game_asset_manager
 {
   memory_arena AssetArena;
@@ -168,15 +232,29 @@ struct game_asset_manager
   buffer_keeper* ObjectKeeper;
   bitmap_keeper* BitmapKeeper;
 
-  u32 ObjectPendingLoadCount;
-  object_handle ObjectPendingLoad[64];
+  // Assets waiting to be uploaded to the GPU, oldest first.
+  // The renderer uploads at most UploadBudgetBytes per frame but always at least one asset.
+  u32 PendingUploadFirst;
+  u32 PendingUploadCount;
+  pending_asset PendingUpload[MAX_PENDING_UPLOAD_COUNT];
+  midx UploadBudgetBytes;
+
+  bitmap_handle PlaceholderBitmap;
+  asset_load_job* volatile CompletedLoads;
+  asset_load_job* FreeLoadJobs;
+  u32 LoadsInFlight;
+  b32 BakeAssetPack; // Requested from the debug menu, written once no loads are in flight
+  b32 FromAssetPack; // Assets point into the mapped pack, which can't be baked over
 
-  u32 BitmapPendingLoadCount;
-  bitmap_handle BitmapPendingLoad[64];
+  u32 SourceCount;
+  asset_source Sources[MAX_ASSET_SOURCE_COUNT];
 
-  stb_font_map FontMap[10];
+  font_cache* FontCache;
 
   object_handle* EnumeratedMeshes;
+
+  // Assets loaded from the pack point into this mapping
+  debug_mapped_file AssetPack;
 };
 
 collider_mesh GetColliderMesh( game_asset_manager* AssetManager, object_handle Handle);
@@ -184,12 +262,27 @@ aabb3f GetMeshAABB( game_asset_manager* AssetManager, object_handle Handle);
 
 void ResetAssetManagerTemporaryInstances(game_asset_manager* AssetManager);
 
+// Call before reading a source file so the asset pack knows to rebake when it changes
+void AddAssetSource(game_asset_manager* AssetManager, c8* FileName);
+
+// Decodes the file on the low priority queue. The bitmap can be used right away and is drawn
+// with the placeholder until ProcessCompletedAssetLoads has picked it up.
+bitmap_handle LoadBitmapAsync(game_asset_manager* AssetManager, asset_key Key, c8* FileName, b32 IsSpecial);
+// Called once per frame on the main thread
+void ProcessCompletedAssetLoads(game_asset_manager* AssetManager);
+
+b32 PopPendingUpload(game_asset_manager* AssetManager, pending_asset* Result);
+b32 IsUploadPending(game_asset_manager* AssetManager, asset_type Type, u32 Handle);
+midx GetUploadSize(game_asset_manager* AssetManager, pending_asset PendingAsset);
+
 // GL Layer API
 inline object_handle GetEnumeratedObjectHandle(game_asset_manager* AssetManager, predefined_mesh MeshType);
 
-void GetHandle(game_asset_manager* AssetManager, char* Key, bitmap_handle* Handle);
-void GetHandle(game_asset_manager* AssetManager, char* Key, object_handle* Handle);
-void GetHandle(game_asset_manager* AssetManager, char* Key, material_handle* Handle);
+// Returns the handle of Key or ASSET_NOT_FOUND
+u32 FindAsset(asset_hash_map* HashMap, asset_key Key);
+void GetHandle(game_asset_manager* AssetManager, asset_key Key, bitmap_handle* Handle);
+void GetHandle(game_asset_manager* AssetManager, asset_key Key, object_handle* Handle);
+void GetHandle(game_asset_manager* AssetManager, asset_key Key, material_handle* Handle);
 
 inline mesh_indeces* GetAsset(game_asset_manager* AssetManager, object_handle Handle, buffer_keeper** Keeper = NULL);
 inline mesh_data* GetAsset(game_asset_manager* AssetManager, mesh_handle Index);//, buffer_keeper** Keeper = NULL);
@@ -197,23 +290,6 @@ inline bitmap* GetAsset(game_asset_manager* AssetManager, bitmap_handle Handle,
 inline material* GetAsset(game_asset_manager* AssetManager, material_handle Handle, u32 Index );
 
 
-stb_font_map* GetFontMap(game_asset_manager* AssetManager, u32 FontSize)
-{
-  Assert(ArrayCount(AssetManager->FontMap) == 10);
-  stb_font_map* Result = 0;
-  for (int i = 0; i < ArrayCount(AssetManager->FontMap); ++i)
-  {
-    stb_font_map* Map = &AssetManager->FontMap[i];
-    if(Map->FontHeightPx == FontSize)
-    {
-      Result = Map;
-      break;
-    }
-
-  }
-  Assert(Result);
-  return Result;
-}
 
 
 
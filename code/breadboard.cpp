@@ -68,7 +68,7 @@ rect2f PlotToBitmap( bitmap* Bitmap, r32 ChartXMin, r32 ChartXMax, r32 ChartYMin
 
 
   bitmap_handle Plot;
-  GetHandle(GlobalGameState->AssetManager, "energy_plot", &Plot);
+  GetHandle(GlobalGameState->AssetManager, AssetKey("energy_plot"), &Plot);
   bitmap* PlotBitMap = GetAsset(GlobalGameState->AssetManager, Plot);
 
   BeginScopedEntityManagerMemory();
@@ -122,9 +122,12 @@ global_variable r32 debug_angle = 0;
 #include "breadboard_entity_components.cpp"
 
 #include "assets.cpp"
+#include "font_cache.cpp"
+#include "asset_pack.cpp"
 #include "asset_loading.cpp"
 #include "menu_interface.cpp"
 #include "breadboard_tile.cpp"
+#include "wire_routing.cpp"
 #include "containers/chunk_list.cpp"
 #include "component_breadboard_components.cpp"
 #include "component_camera.cpp"
@@ -139,6 +142,8 @@ global_variable r32 debug_angle = 0;
 #include "containers/rb_tree_unit_tests.h"
 #include "containers/linked_memory.cpp"
 #include "containers/linked_memory_unit_tests.h"
+#include "wire_routing_unit_tests.h"
+#include "component_breadboard_components_unit_tests.h"
 #include "debug.h"
 
 
@@ -180,9 +185,10 @@ GameOutputSound(game_sound_output_buffer* SoundBuffer, int ToneHz)
 
 world* CreateWorld( )
 {
-  world* World = PushStruct(GlobalGameState->PersistentArena, world);
-  World->PositionNodes = NewChunkList(GlobalGameState->PersistentArena, sizeof(position_node), 128);
+  world* World = PushStruct(&GlobalGameState->PersistentArena, world);
+  World->PositionNodes = NewChunkList(&GlobalGameState->PersistentArena, sizeof(position_node), 128);
   InitializeTileMap( &World->TileMap );
+  World->Circuit = NewElectricalCircuit(&GlobalGameState->PersistentArena, MAX_CIRCUIT_NODE_COUNT, MAX_CIRCUIT_EDGE_COUNT, MAX_CIRCUIT_SPLINE_POINT_COUNT);
   return World;
 }
 
@@ -196,16 +202,19 @@ void InitiateGame(game_memory* Memory, game_render_commands* RenderCommands, gam
   }
 
   GlobalGameState = BootstrapPushStruct(game_state, PersistentArena);
-  GlobalGameState->TransientArena = PushStruct(GlobalGameState->PersistentArena, memory_arena);
+  GlobalGameState->TransientArena = PushStruct(&GlobalGameState->PersistentArena, memory_arena);
   GlobalGameState->TransientTempMem = BeginTemporaryMemory(GlobalGameState->TransientArena);
 
-  GlobalGameState->FunctionPool = PushStruct(GlobalGameState->PersistentArena, function_pool);
+  InitializeScratchPool(&GlobalGameState->ScratchPool, Memory->ThreadID);
+  GlobalScratchPool = &GlobalGameState->ScratchPool;
+
+  GlobalGameState->FunctionPool = PushStruct(&GlobalGameState->PersistentArena, function_pool);
 
   GlobalGameState->RenderCommands = RenderCommands;
 
   GlobalGameState->AssetManager  = CreateAssetManager();
   GlobalGameState->EntityManager = CreateEntityManager();
-  GlobalGameState->MenuInterface = CreateMenuInterface(GlobalGameState->PersistentArena, Megabytes(1));
+  GlobalGameState->MenuInterface = CreateMenuInterface(&GlobalGameState->PersistentArena, Megabytes(1));
 
   GlobalGameState->World = CreateWorld();
 
@@ -272,6 +281,8 @@ void InitiateGame(game_memory* Memory, game_render_commands* RenderCommands, gam
   RedBlackTreeUnitTest(GlobalGameState->TransientArena);
   RunRBTreeUnitTests(GlobalGameState->TransientArena);
   LinkedMemoryUnitTests(GlobalGameState->TransientArena);
+  wire_routing_tests::RunUnitTests(GlobalGameState->TransientArena);
+  electrical_circuit_tests::RunUnitTests(GlobalGameState->TransientArena);
 }
 
 #include "function_pointer_pool.h"
@@ -290,6 +301,7 @@ void BeginFrame(game_memory* Memory, game_render_commands* RenderCommands, game_
   Assert(Memory->GameState->AssetManager);
 
   GlobalGameState = Memory->GameState;
+  GlobalScratchPool = &GlobalGameState->ScratchPool;
 
   EndTemporaryMemory(GlobalGameState->TransientTempMem);
   GlobalGameState->TransientTempMem = BeginTemporaryMemory(GlobalGameState->TransientArena);
@@ -299,6 +311,10 @@ void BeginFrame(game_memory* Memory, game_render_commands* RenderCommands, game_
     ReinitiatePool();
   }
 
+  SwapChangeJournals(GlobalGameState->EntityManager);
+  UpdateElectricalCircuit(&GlobalGameState->World->Circuit, GlobalGameState->EntityManager);
+  ProcessCompletedAssetLoads(GlobalGameState->AssetManager);
+
 
   ResetRenderGroup(RenderCommands->WorldGroup);
   ResetRenderGroup(RenderCommands->OverlayGroup);
@@ -356,6 +372,8 @@ extern "C" GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
     PushDebugOverlay(Input);
   }
   UpdateAndRenderMenuInterface(Input, GlobalGameState->MenuInterface);
+
+  FlushFontCache(GlobalGameState->AssetManager);
 }
 
 extern "C" GAME_GET_SOUND_SAMPLES(GameGetSoundSamples)
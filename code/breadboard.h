@@ -7,6 +7,7 @@
 #include "breadboard_tile.h"
 #include "assets.h"
 #include "breadboard_entity_components.h"
+#include "component_breadboard_components.h"
 #include "menu_interface.h"
 #include "containers/chunk_list.h"
 
@@ -39,6 +40,9 @@ struct world
 
   // Holds position nodes for the component_position
   chunk_list PositionNodes;
+
+  // Graph of the electrical components, rebuilt at the start of a frame when they changed
+  electrical_circuit Circuit;
 };
 
 typedef void(*func_ptr_void)(void);
@@ -60,7 +64,7 @@ struct game_state
 {
   game_render_commands* RenderCommands;
   
-  memory_arena* PersistentArena;
+  memory_arena PersistentArena;
   memory_arena* TransientArena;
   temporary_memory TransientTempMem;
   
@@ -73,6 +77,8 @@ struct game_state
   world* World;
   
   function_pool* FunctionPool;
+
+  scratch_pool ScratchPool;
   
   b32 IsInitialized;
   
@@ -146,7 +152,7 @@ inline func_ptr_void* _DeclareFunction(func_ptr_void Function, const c8* Name)
   {
     Assert(Pool->Count == (Result - Pool->Functions))
       Pool->Count++;
-    Result->Name = (c8*) PushCopy(GlobalGameState->PersistentArena, (str::StringLength(Name)+1)*sizeof(c8), (void*) Name);
+    Result->Name = (c8*) PushCopy(&GlobalGameState->PersistentArena, (str::StringLength(Name)+1)*sizeof(c8), (void*) Name);
     Result->Function = Function;
   }else{
     Result->Function = Function;
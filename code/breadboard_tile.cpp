@@ -83,67 +83,142 @@ aabb3f GetTileAABB(tile_map* TileMap, tile_map_position CanPos )
 }
 
 #define TILE_PAGE_SAFE_MARGIN (INT32_MAX/64)
-#define TILE_PAGE_UNINITIALIZED INT32_MAX
+#define TILE_PAGE_MAX_Z 2048
+#define TILE_PAGE_MIN_SLOT_COUNT 256
 
-inline tile_page*
-GetTilePage(tile_map* TileMap, s32 TilePageX, s32 TilePageY, s32 TilePageZ,
-      memory_arena* Arena = 0)
+// Spreads the low 32 bits of Value out to the even bits
+internal inline u64
+SpreadBits(u32 Value)
+{
+  u64 Result = Value;
+  Result = (Result | (Result << 16)) & 0x0000FFFF0000FFFF;
+  Result = (Result | (Result <<  8)) & 0x00FF00FF00FF00FF;
+  Result = (Result | (Result <<  4)) & 0x0F0F0F0F0F0F0F0F;
+  Result = (Result | (Result <<  2)) & 0x3333333333333333;
+  Result = (Result | (Result <<  1)) & 0x5555555555555555;
+  return Result;
+}
+
+// Morton code of the biased page X and Y (26 bits each) with the page Z in the 12 bits above.
+// The key is unique per page and never zero.
+internal inline u64
+GetTilePageKey(s32 TilePageX, s32 TilePageY, s32 TilePageZ)
 {
   Assert( TilePageX > -TILE_PAGE_SAFE_MARGIN);
   Assert( TilePageY > -TILE_PAGE_SAFE_MARGIN);
-  Assert( TilePageZ > -TILE_PAGE_SAFE_MARGIN);
   Assert( TilePageX <  TILE_PAGE_SAFE_MARGIN);
   Assert( TilePageY <  TILE_PAGE_SAFE_MARGIN);
-  Assert( TilePageZ <  TILE_PAGE_SAFE_MARGIN);
+  Assert( TilePageZ > -TILE_PAGE_MAX_Z);
+  Assert( TilePageZ <  TILE_PAGE_MAX_Z);
 
-  // TODO (Jakob): Make a bett er hash function (lol)
-  u32 HashValue = 19 * TilePageX + 7*TilePageY + 3 * TilePageZ;
-  u32 HashSlot = HashValue & ( ArrayCount(TileMap->MapHash) - 1);
-  Assert( HashSlot < ArrayCount(TileMap->MapHash) );
+  u32 X = (u32) (TilePageX + TILE_PAGE_SAFE_MARGIN);
+  u32 Y = (u32) (TilePageY + TILE_PAGE_SAFE_MARGIN);
+  u32 Z = (u32) (TilePageZ + TILE_PAGE_MAX_Z);
+  u64 Result = SpreadBits(X) | (SpreadBits(Y) << 1) | ((u64) Z << 52);
+  return Result;
+}
 
-  tile_page* Page = TileMap->MapHash + HashSlot;
+// Neighbouring pages have close keys, mix them so they spread over the table
+internal inline u32
+GetTilePageSlot(tile_map* TileMap, u64 Key)
+{
+  u32 Result = (u32) utils::murmur_hash_64(Key) & (TileMap->SlotCount - 1);
+  return Result;
+}
 
-  do{
-    if( (TilePageX == Page->PageX) &&
-      (  TilePageY == Page->PageY) &&
-      (  TilePageZ == Page->PageZ))
+internal u32
+FindTilePage(tile_map* TileMap, u64 Key)
+{
+  u32 Result = TILE_PAGE_NONE;
+  if(TileMap->SlotCount)
+  {
+    u32 Slot = GetTilePageSlot(TileMap, Key);
+    while(TileMap->SlotKeys[Slot])
     {
-      break;
+      if(TileMap->SlotKeys[Slot] == Key)
+      {
+        Result = TileMap->SlotPages[Slot];
+        break;
+      }
+      Slot = (Slot + 1) & (TileMap->SlotCount - 1);
     }
+  }
+  return Result;
+}
 
-    if( Arena && ( Page->PageX != TILE_PAGE_UNINITIALIZED ) && ( !Page->NextInHash ) )
-    {
-      Page->NextInHash = PushStruct( Arena, tile_page );
-      Page->NextInHash->PageX = TILE_PAGE_UNINITIALIZED;
-      Page = Page->NextInHash;
-      break;
-    }
+internal void
+InsertTilePageSlot(tile_map* TileMap, u64 Key, u32 PageIndex)
+{
+  u32 Slot = GetTilePageSlot(TileMap, Key);
+  while(TileMap->SlotKeys[Slot])
+  {
+    Assert(TileMap->SlotKeys[Slot] != Key);
+    Slot = (Slot + 1) & (TileMap->SlotCount - 1);
+  }
+  TileMap->SlotKeys[Slot] = Key;
+  TileMap->SlotPages[Slot] = PageIndex;
+}
+
+internal u32
+CreateTilePage(memory_arena* Arena, tile_map* TileMap, u64 Key, s32 TilePageX, s32 TilePageY, s32 TilePageZ)
+{
+  if(TileMap->PageCount == TileMap->MaxPageCount)
+  {
+    u32 NewMaxPageCount = Maximum(2 * TileMap->MaxPageCount, TILE_PAGE_MIN_SLOT_COUNT / 2);
+    TileMap->Pages = GrowArray(Arena, TileMap->Pages, TileMap->MaxPageCount, NewMaxPageCount, tile_page);
+    TileMap->MaxPageCount = NewMaxPageCount;
+  }
 
-    if( Arena && ( Page->PageX == TILE_PAGE_UNINITIALIZED ) )
+  // Keep the load below 3/4, the pages are reinserted from the dense array
+  if(4 * (TileMap->PageCount + 1) > 3 * TileMap->SlotCount)
+  {
+    TileMap->SlotCount = Maximum(2 * TileMap->SlotCount, TILE_PAGE_MIN_SLOT_COUNT);
+    TileMap->SlotKeys  = PushArray(Arena, TileMap->SlotCount, u64);
+    TileMap->SlotPages = PushArray(Arena, TileMap->SlotCount, u32, NoClear());
+    for(u32 PageIndex = 0; PageIndex < TileMap->PageCount; ++PageIndex)
     {
-      u32 TileCount = TileMap->PageDim * TileMap->PageDim;
+      tile_page* Page = TileMap->Pages + PageIndex;
+      InsertTilePageSlot(TileMap, GetTilePageKey(Page->PageX, Page->PageY, Page->PageZ), PageIndex);
+    }
+  }
 
-      Page->PageX = TilePageX;
-      Page->PageY = TilePageY;
-      Page->PageZ = TilePageZ;
+  u32 Result = TileMap->PageCount++;
+  tile_page* Page = TileMap->Pages + Result;
+  Page->PageX = TilePageX;
+  Page->PageY = TilePageY;
+  Page->PageZ = TilePageZ;
 
-      // For now a page is just a 2d grid of tile_contents
-      Page->Page = PushArray(Arena, TileCount, tile_contents);
+  // For now a page is just a 2d grid of tile_contents
+  Page->Page = PushArray(Arena, TileMap->PageDim * TileMap->PageDim, tile_contents);
 
-      Page->NextInHash = 0;
+  InsertTilePageSlot(TileMap, Key, Result);
+  return Result;
+}
 
-      for( u32 TileIndex = 0; TileIndex < TileCount; ++TileIndex )
-      {
-        Page->Page[TileIndex] = {};
-      }
-      break;
-    }
+// Returns 0 if the page doesn't exist and no Arena is given to create it on.
+// The pointer is valid until the next page is created.
+inline tile_page*
+GetTilePage(tile_map* TileMap, s32 TilePageX, s32 TilePageY, s32 TilePageZ,
+      memory_arena* Arena = 0)
+{
+  u64 Key = GetTilePageKey(TilePageX, TilePageY, TilePageZ);
 
-    Page = Page->NextInHash;
+  // Misses are cached too, empty space is looked up as often as the pages are
+  u32 PageIndex = TileMap->LastPage;
+  if(Key != TileMap->LastKey)
+  {
+    PageIndex = FindTilePage(TileMap, Key);
+    TileMap->LastKey = Key;
+  }
 
-  }while( Page );
+  if(PageIndex == TILE_PAGE_NONE && Arena)
+  {
+    PageIndex = CreateTilePage(Arena, TileMap, Key, TilePageX, TilePageY, TilePageZ);
+  }
+  TileMap->LastPage = PageIndex;
 
-  return Page;
+  tile_page* Result = (PageIndex != TILE_PAGE_NONE) ? TileMap->Pages + PageIndex : 0;
+  return Result;
 }
 
 inline tile_index
@@ -270,12 +345,15 @@ void InitializeTileMap( tile_map* TileMap )
   TileMap->PageMask = (1<<TileMap->PageShift)-1;
   TileMap->PageDim = (1<<TileMap->PageShift);
 
-  for( u32 TilePageIndex = 0;
-     TilePageIndex < ArrayCount(TileMap->MapHash);
-     ++TilePageIndex)
-  {
-    TileMap->MapHash[TilePageIndex].PageX = TILE_PAGE_UNINITIALIZED;
-  }
+  // Pages and slots are pushed when the first tile is set
+  TileMap->PageCount = 0;
+  TileMap->MaxPageCount = 0;
+  TileMap->Pages = 0;
+  TileMap->SlotCount = 0;
+  TileMap->SlotKeys = 0;
+  TileMap->SlotPages = 0;
+  TileMap->LastKey = 0;
+  TileMap->LastPage = TILE_PAGE_NONE;
 }
 
 void GetIntersectingTiles(tile_map* TileMap, list<tile_map_position>* OutputList, aabb3f* AABB )
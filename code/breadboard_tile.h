@@ -52,10 +52,10 @@ struct tile_page{
   s32 PageZ;
 
   tile_contents* Page;
-
-  tile_page* NextInHash;
 };
 
+#define TILE_PAGE_NONE 0xFFFFFFFF
+
 struct tile_map{
   r32 TileHeight;
   r32 TileWidth;
@@ -65,8 +65,20 @@ struct tile_map{
   s32 PageMask;
   s32 PageDim;
 
-  // NOTE(Jakob): At the moment this needs to be a power of 2
-  tile_page MapHash[4096];
+  // All pages, in the order they were created. Iterate these instead of the slots.
+  u32 PageCount;
+  u32 MaxPageCount;
+  tile_page* Pages;
+
+  // Open addressed index from page key to page, linear probing. SlotCount is a power of two
+  // and zero keys are empty slots.
+  u32 SlotCount;
+  u64* SlotKeys;
+  u32* SlotPages;
+
+  // Lookups are coherent, most of them hit the page of the previous one
+  u64 LastKey;
+  u32 LastPage;
 };
 
 
@@ -12,7 +12,7 @@ REM -wd4018 Disables Waring: < Signed/Unsigned mismatch
 set CommonCompilerFlags= /DEBUG:FULL -Od -nologo -fp:fast -fp:except-     -GR- -EHa- -Zo -Oi -WX -W4 -wd4018 -wd4201 -wd4100 -wd4189 -wd4505 -wd4127 -wd4706 -FC -Z7 -GS- -Gs9999999 -wd4702
 set CommonCompilerFlags=-DHANDMADE_PROFILE=1 -DHANDMADE_INTERNAL=1 -DHANDMADE_SLOW=1 -DUSING_OPENGL=1 -DHANDMADE_WIN32=1 %CommonCompilerFlags%
 
-set CommonLinkerFlags= -incremental:no -opt:ref user32.lib gdi32.lib winmm.lib opengl32.lib
+set CommonLinkerFlags= -incremental:no -opt:ref user32.lib gdi32.lib winmm.lib opengl32.lib advapi32.lib
 
 IF NOT EXIST ..\build mkdir ..\build
 pushd ..\build
@@ -185,4 +185,57 @@ void DeleteElectricalEntity(entity_manager* EM, entity_id ElectricalComponent)
   }
 
   DeleteEntity(EM, &ElectricalComponent);
-}
\ No newline at end of file
+}
+
+void RebuildElectricalCircuit(electrical_circuit* Circuit, entity_manager* EM)
+{
+  TIMED_FUNCTION();
+
+  Circuit->NodeCount = 0;
+  Circuit->EdgeCount = 0;
+  Circuit->SplinePointCount = 0;
+  Circuit->EdgeOffset[0] = 0;
+  Circuit->EdgeSplineOffset[0] = 0;
+
+  filtered_entity_iterator EntityIterator = GetComponentsOfType(EM, COMPONENT_FLAG_ELECTRICAL);
+  while(Next(&EntityIterator))
+  {
+    Assert(Circuit->NodeCount < Circuit->MaxNodeCount);
+    u32 Node = Circuit->NodeCount++;
+    component_electrical* Component = GetElectricalComponent(&EntityIterator);
+    Circuit->NodeType[Node] = Component->Type;
+    Circuit->NodeEntity[Node] = GetEntityID(&EntityIterator);
+
+    component_connector_pin* Pin = Component->FirstPin;
+    while(Pin)
+    {
+      Assert(Circuit->EdgeCount < Circuit->MaxEdgeCount);
+      u32 Edge = Circuit->EdgeCount++;
+      // TODO: Resolve the target node once pins can be joined together with wires
+      Circuit->EdgeTarget[Edge] = CIRCUIT_NODE_NONE;
+      Circuit->EdgePinType[Edge] = Pin->Type;
+      Circuit->EdgeSplineOffset[Edge+1] = Circuit->SplinePointCount;
+      Pin = Pin->NextPin;
+    }
+    Circuit->EdgeOffset[Node+1] = Circuit->EdgeCount;
+  }
+}
+
+internal b32
+HasChanges(entity_manager* EM, bitmask32 ComponentFlag)
+{
+  chunk_list_iterator Iterator = GetChangeJournal(EM, ComponentFlag);
+  b32 Result = Next(&Iterator) != 0;
+  return Result;
+}
+
+b32 UpdateElectricalCircuit(electrical_circuit* Circuit, entity_manager* EM)
+{
+  // Any change can move edges of every later node, so the whole graph is rebuilt
+  b32 Result = HasChanges(EM, COMPONENT_FLAG_ELECTRICAL) || HasChanges(EM, COMPONENT_FLAG_CONNECTOR_PIN);
+  if(Result)
+  {
+    RebuildElectricalCircuit(Circuit, EM);
+  }
+  return Result;
+}
@@ -4,6 +4,8 @@
 #include "coordinate_systems.h"
 #include "math/rect2f.h"
 
+// NOTE: Diode and the Led types are the nonlinear devices. Once a Newton solver exists their
+//       I-V stamps should be evaluated grouped by type in SoA arrays so the exp kernel vectorizes.
 enum class ElectricalComponentType
 {
   None,
@@ -55,57 +57,67 @@ enum LEDColor
   LED_COLOR_BLUE
 };
 
-struct circuit_edge_spline
+#define CIRCUIT_NODE_NONE 0xFFFFFFFF
+#define MAX_CIRCUIT_NODE_COUNT 4096
+#define MAX_CIRCUIT_EDGE_COUNT (4*MAX_CIRCUIT_NODE_COUNT)
+#define MAX_CIRCUIT_SPLINE_POINT_COUNT (4*MAX_CIRCUIT_EDGE_COUNT)
+
+struct circuit_spline_point
 {
   world_coordinate Point;
   v2 InputCurvature;
   v2 OutputCurvature;
-  circuit_edge_spline* Next;
-};
-
-struct circuit_node_header;
-
-struct circuit_edge
-{
-  circuit_node_header* A;  // The Index this edge is located in Node A's circuit edge list is its Connection ID
-  circuit_node_header* B;  // The Index this edge is located in Node B's circuit edge list is its Connection ID
-  circuit_edge_spline* Points; // Where does the wire pass through in the world
-};
-
-struct circuit_node_header
-{
-  ElectricalComponentType Type; // The type of electric component
-  u32 BodySize;                 // Size of body in bytes
-  u32 TotalEdgeCount;           // The order of the edges dictates its function, defined by the type.
-  circuit_edge* Edges;          // Edges connecting to other nodes
 };
 
-struct electrical_circuit_memory
-{
-  chunk_list Nodes;
-  chunk_list Edges;
-  chunk_list Splines;
-};
+// TODO: There is no solver yet, the circuit is only a graph. When one lands, parameter sweeps
+//       (resistor values, source voltages) should be a batched solve over N samples that shares
+//       the symbolic factorization and keeps per-sample values SoA, not N separate solves.
 
+// The circuit graph in compressed adjacency form with the attributes in parallel arrays.
+// The edges of node N are [EdgeOffset[N], EdgeOffset[N+1]) and come in the same order as the pins
+// of the component, the order dictates their function, defined by the type.
+// The spline of edge E is SplinePoints[EdgeSplineOffset[E], EdgeSplineOffset[E+1]).
 struct electrical_circuit
 {
-  u32 SourceNodeCount;
-  circuit_node_header* SourceNodes;
-  linked_memory Nodes;
-  chunk_list Edges;
-  chunk_list Splines;
+  u32 NodeCount;
+  u32 MaxNodeCount;
+  ElectricalComponentType* NodeType;
+  entity_id* NodeEntity;
+  u32* EdgeOffset;                // NodeCount+1 entries
+
+  u32 EdgeCount;
+  u32 MaxEdgeCount;
+  u32* EdgeTarget;                // Node on the other side of the edge or CIRCUIT_NODE_NONE
+  ElectricalPinType* EdgePinType;
+  u32* EdgeSplineOffset;          // EdgeCount+1 entries
+
+  u32 SplinePointCount;
+  u32 MaxSplinePointCount;
+  circuit_spline_point* SplinePoints;
 };
 
-electrical_circuit NewElectricalCircuit(memory_arena* Arena)
+electrical_circuit NewElectricalCircuit(memory_arena* Arena, u32 MaxNodeCount, u32 MaxEdgeCount, u32 MaxSplinePointCount)
 {
-  u32 NodeChunkSize = 128;
-  u32 EdgeChunkSize = 2*NodeChunkSize;
-  u32 SplineChunkSize = 4*NodeChunkSize;
   electrical_circuit Result = {};
-  //u32 MaxLinkedMemorySize = 
-//  InitiateLinkedMemory(Arena, &Result.Nodes, sizeof(circuit_node_header), NodeChunkSize);
-  Result.Edges   = NewChunkList(Arena, sizeof(circuit_edge), EdgeChunkSize);
-  Result.Splines = NewChunkList(Arena, sizeof(circuit_edge_spline), SplineChunkSize);
+  Result.MaxNodeCount = MaxNodeCount;
+  Result.NodeType   = PushArray(Arena, MaxNodeCount, ElectricalComponentType);
+  Result.NodeEntity = PushArray(Arena, MaxNodeCount, entity_id);
+  Result.EdgeOffset = PushArray(Arena, MaxNodeCount+1, u32);
+
+  Result.MaxEdgeCount = MaxEdgeCount;
+  Result.EdgeTarget       = PushArray(Arena, MaxEdgeCount, u32);
+  Result.EdgePinType      = PushArray(Arena, MaxEdgeCount, ElectricalPinType);
+  Result.EdgeSplineOffset = PushArray(Arena, MaxEdgeCount+1, u32);
+
+  Result.MaxSplinePointCount = MaxSplinePointCount;
+  Result.SplinePoints = PushArray(Arena, MaxSplinePointCount, circuit_spline_point);
+  return Result;
+}
+
+inline u32 GetEdgeCount(electrical_circuit* Circuit, u32 Node)
+{
+  Assert(Node < Circuit->NodeCount);
+  u32 Result = Circuit->EdgeOffset[Node+1] - Circuit->EdgeOffset[Node];
   return Result;
 }
 
@@ -125,4 +137,11 @@ struct component_electrical
 };
 
 entity_id CreateElectricalComponent(entity_manager* EM, ElectricalComponentType EComponentType, world_coordinate WorldPos);
-void DeleteElectricalEntity(entity_manager* EM, entity_id ElectricalComponent);
\ No newline at end of file
+void DeleteElectricalEntity(entity_manager* EM, entity_id ElectricalComponent);
+
+// Rebuilds the circuit graph from the electrical components in the entity manager
+void RebuildElectricalCircuit(electrical_circuit* Circuit, entity_manager* EM);
+
+// Called once per frame after SwapChangeJournals. Rebuilds the circuit if an electrical component or
+// a connector pin changed last frame. Returns true if it was rebuilt.
+b32 UpdateElectricalCircuit(electrical_circuit* Circuit, entity_manager* EM);
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "component_breadboard_components.h"
+
+namespace electrical_circuit_tests
+{
+
+// Pins are pushed to the front of the component, so edges come in reverse creation order
+void RebuildFromComponents(memory_arena* Arena)
+{
+  ScopedMemory ScopedMem = ScopedMemory(Arena);
+
+  // The component getters go through the global entity manager
+  entity_manager* GameEntityManager = GlobalGameState->EntityManager;
+  entity_manager* EntityManager = CreateEntityManager();
+  GlobalGameState->EntityManager = EntityManager;
+
+  electrical_circuit Circuit = NewElectricalCircuit(Arena, 8, 16, 16);
+  SwapChangeJournals(EntityManager);
+  Assert(!UpdateElectricalCircuit(&Circuit, EntityManager));
+  Assert(Circuit.NodeCount == 0);
+
+  entity_id Source   = CreateElectricalComponent(EntityManager, ElectricalComponentType::Source, {});
+  entity_id Resistor = CreateElectricalComponent(EntityManager, ElectricalComponentType::Resistor, {});
+  entity_id Diode    = CreateElectricalComponent(EntityManager, ElectricalComponentType::Diode, {});
+  SwapChangeJournals(EntityManager);
+  Assert(UpdateElectricalCircuit(&Circuit, EntityManager));
+
+  Assert(Circuit.NodeCount == 3);
+  Assert(Circuit.EdgeCount == 5);
+  Assert(Circuit.SplinePointCount == 0);
+
+  Assert(Circuit.NodeType[0] == ElectricalComponentType::Source);
+  Assert(Circuit.NodeType[1] == ElectricalComponentType::Resistor);
+  Assert(Circuit.NodeType[2] == ElectricalComponentType::Diode);
+  Assert(Circuit.NodeEntity[0].EntityID == Source.EntityID);
+  Assert(Circuit.NodeEntity[1].EntityID == Resistor.EntityID);
+  Assert(Circuit.NodeEntity[2].EntityID == Diode.EntityID);
+
+  u32 EdgeOffset[] = {0, 1, 3, 5};
+  for(u32 Index = 0; Index < ArrayCount(EdgeOffset); ++Index)
+  {
+    Assert(Circuit.EdgeOffset[Index] == EdgeOffset[Index]);
+  }
+  Assert(GetEdgeCount(&Circuit, 0) == 1);
+  Assert(GetEdgeCount(&Circuit, 1) == 2);
+  Assert(GetEdgeCount(&Circuit, 2) == 2);
+
+  ElectricalPinType PinTypes[] =
+  {
+    ElectricalPinType::Source,
+    ElectricalPinType::InputOutput, ElectricalPinType::InputOutput,
+    ElectricalPinType::Output, ElectricalPinType::Input,
+  };
+  for(u32 Edge = 0; Edge < ArrayCount(PinTypes); ++Edge)
+  {
+    Assert(Circuit.EdgePinType[Edge] == PinTypes[Edge]);
+    Assert(Circuit.EdgeTarget[Edge] == CIRCUIT_NODE_NONE);
+    Assert(Circuit.EdgeSplineOffset[Edge+1] == 0);
+  }
+
+  // Nothing changed, the graph is kept
+  SwapChangeJournals(EntityManager);
+  Assert(!UpdateElectricalCircuit(&Circuit, EntityManager));
+  Assert(Circuit.NodeCount == 3);
+
+  // Deleting the resistor moves the diode edges down
+  DeleteElectricalEntity(EntityManager, Resistor);
+  SwapChangeJournals(EntityManager);
+  Assert(UpdateElectricalCircuit(&Circuit, EntityManager));
+  Assert(Circuit.NodeCount == 2);
+  Assert(Circuit.EdgeCount == 3);
+  Assert(Circuit.NodeEntity[1].EntityID == Diode.EntityID);
+  Assert(Circuit.EdgeOffset[1] == 1);
+  Assert(Circuit.EdgeOffset[2] == 3);
+  Assert(Circuit.EdgePinType[1] == ElectricalPinType::Output);
+
+  DeleteElectricalEntity(EntityManager, Source);
+  DeleteElectricalEntity(EntityManager, Diode);
+  GlobalGameState->EntityManager = GameEntityManager;
+}
+
+void RunUnitTests(memory_arena* Arena)
+{
+  RebuildFromComponents(Arena);
+}
+
+};
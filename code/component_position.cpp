@@ -21,7 +21,7 @@ void InsertPositionNode(component_position* PositionComponent, position_node* Pa
 
 position_node* CreatePositionNode(world_coordinate Position, r32 Rotation)
 {
-  position_node* Result = (position_node*) GetNewBlock(GlobalGameState->PersistentArena, &GlobalGameState->World->PositionNodes);
+  position_node* Result = (position_node*) GetNewBlock(&GlobalGameState->PersistentArena, &GlobalGameState->World->PositionNodes);
   Result->RelativePosition = Position;
   Result->RelativeRotation = Rotation;
   return Result;
@@ -127,7 +127,7 @@ void UpdateAbsolutePosition(memory_arena* Arena, component_position* Position)
 
   temporary_memory TempMem = BeginTemporaryMemory(Arena);
   node_queue NodeQueue = {};
-  NodeQueue.Nodes = PushArray(Arena, Position->NodeCount, position_node*);
+  NodeQueue.Nodes = PushArray(Arena, Position->NodeCount, position_node*, NoClear());
 
   position_node* Root = Position->FirstChild;
 
@@ -201,18 +201,20 @@ void SetRelativePosition(position_node* Node, world_coordinate Position, r32 Rot
   }
 
   Node->PositionComponent->Dirty = true;
+
+  entity_id EntityID = GetEntityIDFromComponent((bptr) Node->PositionComponent);
+  MarkChanged(GlobalGameState->EntityManager, &EntityID, COMPONENT_FLAG_POSITION);
 }
 
 // Note untested with several siblings
 void ClearPositionComponent(component_position* PositionComponent)
 {
-  memory_arena* TransientArena = GlobalGameState->TransientArena;
-  temporary_memory TempMem = BeginTemporaryMemory(TransientArena);
+  temporary_memory TempMem = GetScratch();
 
   chunk_list* PositionNodeList = &GlobalGameState->World->PositionNodes;
 
   node_queue NodeQueue = {};
-  NodeQueue.Nodes = PushArray(TransientArena, PositionComponent->NodeCount, position_node*);
+  NodeQueue.Nodes = PushArray(TempMem.Arena, PositionComponent->NodeCount, position_node*, NoClear());
 
   position_node* Root = PositionComponent->FirstChild;
 
@@ -235,5 +237,5 @@ void ClearPositionComponent(component_position* PositionComponent)
 
     FreeBlock(PositionNodeList, (bptr) Node);
   }
-  EndTemporaryMemory(TempMem);
+  ReleaseScratch(TempMem);
 }
\ No newline at end of file
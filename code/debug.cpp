@@ -1,18 +1,230 @@
 #include "debug.h"
+#include "font_cache.h"
 
 #include "math/utils.h"
 #include "color_table.h"
 
-void ClearFrame(debug_frame* Frame)
+inline u32
+GetHistogramBucket(u64 Cycles)
+{
+  u64 MaxCycles = ((u64)1 << DEBUG_HISTOGRAM_MAX_EXPONENT) - 1;
+  Cycles = Minimum(Cycles, MaxCycles);
+  if(Cycles < DEBUG_HISTOGRAM_SUB_BUCKET_COUNT)
+  {
+    return (u32) Cycles;
+  }
+  u32 Exponent = FindMostSignificantSetBit64(Cycles).Index;
+  u32 Shift = Exponent - DEBUG_HISTOGRAM_SUB_BUCKET_BITS;
+  u32 Result = (Shift + 1) * DEBUG_HISTOGRAM_SUB_BUCKET_COUNT + (u32)((Cycles >> Shift) & (DEBUG_HISTOGRAM_SUB_BUCKET_COUNT - 1));
+  return Result;
+}
+
+// Middle of the range of cycle counts that land in Bucket
+inline u64
+GetHistogramBucketValue(u32 Bucket)
+{
+  if(Bucket < DEBUG_HISTOGRAM_SUB_BUCKET_COUNT)
+  {
+    return Bucket;
+  }
+  u32 Shift = Bucket / DEBUG_HISTOGRAM_SUB_BUCKET_COUNT - 1;
+  u64 Low = (u64)(DEBUG_HISTOGRAM_SUB_BUCKET_COUNT + Bucket % DEBUG_HISTOGRAM_SUB_BUCKET_COUNT) << Shift;
+  u64 Result = Low + (((u64)1 << Shift) >> 1);
+  return Result;
+}
+
+internal u64
+GetHistogramPercentile(debug_record_stats* Stats, r32 Percentile)
+{
+  u32 Rank = (u32) Ciel(Percentile * Stats->HitCount);
+  Rank = Maximum(Rank, 1);
+  u32 Count = 0;
+  for(u32 Bucket = 0; Bucket < DEBUG_HISTOGRAM_BUCKET_COUNT; ++Bucket)
+  {
+    Count += Stats->Histogram[Bucket];
+    if(Count >= Rank)
+    {
+      return GetHistogramBucketValue(Bucket);
+    }
+  }
+  return 0;
+}
+
+internal u32
+GetCallPath(debug_state* DebugState, u32 Parent, u32 RecordIndex, debug_record_entry* Record)
+{
+  u64 Key = ((u64) Parent << 32) | (RecordIndex + 1);
+  u32 Slot = (u32)(utils::murmur_hash_64(Key) & (DEBUG_CALL_PATH_SLOT_COUNT - 1));
+  while(DebugState->CallPathKeys[Slot])
+  {
+    if(DebugState->CallPathKeys[Slot] == Key)
+    {
+      return DebugState->CallPathSlots[Slot];
+    }
+    Slot = (Slot + 1) & (DEBUG_CALL_PATH_SLOT_COUNT - 1);
+  }
+
+  // Paths past the limit are only counted towards the record
+  if(DebugState->CallPathCount == MAX_DEBUG_CALL_PATH_COUNT)
+  {
+    return DEBUG_CALL_PATH_ROOT;
+  }
+  u32 Result = DebugState->CallPathCount++;
+  debug_call_path* Path = DebugState->CallPaths + Result;
+  *Path = {};
+  Path->Parent = Parent;
+  Path->Depth = DebugState->CallPaths[Parent].Depth + 1;
+  Path->Record = Record;
+  DebugState->CallPathKeys[Slot] = Key;
+  DebugState->CallPathSlots[Slot] = Result;
+  return Result;
+}
+
+internal void
+ClearCallPaths(debug_state* DebugState)
+{
+  ZeroArray(DEBUG_CALL_PATH_SLOT_COUNT, DebugState->CallPathKeys);
+  DebugState->CallPaths[DEBUG_CALL_PATH_ROOT] = {};
+  DebugState->CallPathCount = 1;
+}
+
+// Adds a closed block to the statistics of its record and call path, or takes it away again
+internal void
+AccumulateBlockStatistics(debug_state* DebugState, debug_block* Block, b32 Remove)
+{
+  debug_record_entry* Record = Block->Record;
+  debug_record_stats* Stats = Record->Stats;
+  if(!Stats)
+  {
+    Assert(!Remove);
+    Stats = DebugState->FirstFreeRecordStats;
+    if(Stats)
+    {
+      DebugState->FirstFreeRecordStats = Stats->NextFree;
+    }else{
+      Stats = PushStruct(&DebugState->Arena, debug_record_stats, NoClear());
+    }
+    *Stats = {};
+    Record->Stats = Stats;
+  }
+
+  u64 Inclusive = Block->EndClock - Block->BeginClock;
+  u64 Exclusive = Inclusive - Minimum(Block->ChildCycles, Inclusive);
+  u32 Bucket = GetHistogramBucket(Inclusive);
+  debug_call_path* Path = DebugState->CallPaths + Block->CallPath;
+  if(Remove)
+  {
+    Assert(Stats->Histogram[Bucket] && Stats->HitCount);
+    --Stats->HitCount;
+    Stats->InclusiveCycles -= Inclusive;
+    Stats->ExclusiveCycles -= Exclusive;
+    --Stats->Histogram[Bucket];
+    --Path->HitCount;
+    Path->InclusiveCycles -= Inclusive;
+    Path->ExclusiveCycles -= Exclusive;
+  }else{
+    ++Stats->HitCount;
+    Stats->InclusiveCycles += Inclusive;
+    Stats->ExclusiveCycles += Exclusive;
+    ++Stats->Histogram[Bucket];
+    ++Path->HitCount;
+    Path->InclusiveCycles += Inclusive;
+    Path->ExclusiveCycles += Exclusive;
+  }
+
+  if(Block->HasCounters)
+  {
+    if(Remove)
+    {
+      Assert(Stats->CounterHitCount);
+      --Stats->CounterHitCount;
+      for(u32 CounterIndex = 0; CounterIndex < DEBUG_COUNTER_COUNT; ++CounterIndex)
+      {
+        Stats->Counters[CounterIndex] -= Block->Counters.Values[CounterIndex];
+      }
+    }else{
+      ++Stats->CounterHitCount;
+      for(u32 CounterIndex = 0; CounterIndex < DEBUG_COUNTER_COUNT; ++CounterIndex)
+      {
+        Stats->Counters[CounterIndex] += Block->Counters.Values[CounterIndex];
+      }
+    }
+  }
+}
+
+// Records are found again from the collated entries through the index they were stored under
+inline debug_record*
+GetDebugRecord(debug_record_entry* Entry)
+{
+  debug_record* Result = GlobalDebugTable->Records[Entry->RecordIndex / MAX_DEBUG_RECORD_COUNT] + (Entry->RecordIndex % MAX_DEBUG_RECORD_COUNT);
+  return Result;
+}
+
+void ClearFrame(debug_state* DebugState, debug_frame* Frame)
 {
   TIMED_FUNCTION();
+  // The frame leaves the history
+  for(debug_block_chunk* Chunk = Frame->FirstChunk; Chunk; Chunk = Chunk->Next)
+  {
+    for(debug_block* Block = Chunk->Blocks; Block < Chunk->Blocks + Chunk->Count; ++Block)
+    {
+      // Blocks still open when the frame ended were never counted
+      if(Block->EndClock)
+      {
+        AccumulateBlockStatistics(DebugState, Block, true);
+      }
+    }
+  }
+  if(Frame->Begun)
+  {
+    Assert(DebugState->StatsFrameCount);
+    --DebugState->StatsFrameCount;
+  }
+
   Frame->BeginClock = 0;
   Frame->EndClock = 0;
   Frame->WallSecondsElapsed = 0;
   Frame->FrameBarLaneCount = 0;
   ZeroArray(ArrayCount(Frame->Threads), Frame->Threads); 
-  Frame->FirstFreeBlock = 0;
-  Frame->Statistics.Clear();
+  Frame->Begun = false;
+  Frame->BlockCount = 0;
+  Frame->DroppedEventCount = 0;
+  if(Frame->FirstChunk)
+  {
+    Frame->LastChunk->Next = DebugState->FirstFreeChunk;
+    DebugState->FirstFreeChunk = Frame->FirstChunk;
+  }
+  Frame->FirstChunk = 0;
+  Frame->LastChunk = 0;
+}
+
+internal debug_block*
+PushDebugBlock(debug_state* DebugState, debug_frame* Frame)
+{
+  debug_block_chunk* Chunk = Frame->LastChunk;
+  if(!Chunk || Chunk->Count == DEBUG_BLOCK_CHUNK_SIZE)
+  {
+    Chunk = DebugState->FirstFreeChunk;
+    if(Chunk)
+    {
+      DebugState->FirstFreeChunk = Chunk->Next;
+    }else{
+      Chunk = PushStruct(&DebugState->Arena, debug_block_chunk, NoClear());
+    }
+    Chunk->Count = 0;
+    Chunk->Next = 0;
+    if(Frame->LastChunk)
+    {
+      Frame->LastChunk->Next = Chunk;
+    }else{
+      Frame->FirstChunk = Chunk;
+    }
+    Frame->LastChunk = Chunk;
+  }
+  debug_block* Result = Chunk->Blocks + Chunk->Count++;
+  *Result = {};
+  ++Frame->BlockCount;
+  return Result;
 }
 
 internal void ResetCollation()
@@ -22,14 +234,38 @@ internal void ResetCollation()
   DebugState->SelectedFrame = 0;
   DebugState->ThreadSelected = true;
   DebugState->SelectedThreadIndex = 0;
-  DebugState->FunctionList.Clear();
   for(u32 FrameIndex = 0;
-          FrameIndex < ArrayCount(DebugState->Frames);
+          FrameIndex < DebugState->FrameCount;
           ++FrameIndex)
   {
     debug_frame* Frame = DebugState->Frames+FrameIndex;
-    ClearFrame(Frame);
+    ClearFrame(DebugState, Frame);
   }
+  for(debug_record_entry* Entry = DebugState->FunctionList.First(); Entry; Entry = DebugState->FunctionList.Next(Entry))
+  {
+    if(Entry->Stats)
+    {
+      Entry->Stats->NextFree = DebugState->FirstFreeRecordStats;
+      DebugState->FirstFreeRecordStats = Entry->Stats;
+    }
+  }
+  DebugState->FunctionList.Clear();
+  ClearCallPaths(DebugState);
+}
+
+// Replaces the frame history. The old frames are left in the arena but their blocks are reused.
+internal void
+SetDebugFrameCount(debug_state* DebugState, u32 FrameCount)
+{
+  Assert(FrameCount > 1);
+  for(u32 FrameIndex = 0; FrameIndex < DebugState->FrameCount; ++FrameIndex)
+  {
+    ClearFrame(DebugState, DebugState->Frames + FrameIndex);
+  }
+  DebugState->FrameCount = FrameCount;
+  DebugState->Frames = PushArray(&DebugState->Arena, FrameCount, debug_frame);
+  DebugState->CurrentFrameIndex = 0;
+  DebugState->SelectedFrame = 0;
 }
 
 MENU_EVENT_CALLBACK(DebugToggleButton)
@@ -54,20 +290,15 @@ DEBUGGetState()
   debug_state* DebugState = DebugGlobalMemory->DebugState;
   if(!DebugState)
   {
-    DebugGlobalMemory->DebugState = BootstrapPushStruct(debug_state, Arena);
+    DebugGlobalMemory->DebugState = BootstrapPushStruct(debug_state, Arena, LargePageArena());
 
     DebugGlobalMemory->DebugState->FunctionList = vector_list<debug_record_entry>(&DebugGlobalMemory->DebugState->Arena, MAX_DEBUG_RECORD_COUNT*MAX_DEBUG_TRANSLATION_UNITS);
-
-    for(u32 FrameIndex = 0;
-        FrameIndex < ArrayCount(DebugGlobalMemory->DebugState->Frames);
-        ++FrameIndex)
-    {
-      debug_frame* Frame = DebugGlobalMemory->DebugState->Frames+FrameIndex;
-      Frame->MaxBlockCount = MAX_BLOCKS_PER_FRAME;
-      Frame->Blocks = PushArray( &DebugGlobalMemory->DebugState->Arena, Frame->MaxBlockCount, debug_block);
-      Frame->Statistics = vector_list<debug_statistics>(&DebugGlobalMemory->DebugState->Arena, MAX_DEBUG_FUNCTION_COUNT);
-    }
+    SetDebugFrameCount(DebugGlobalMemory->DebugState, PROFILER_FRAME_COUNT);
     DebugState = DebugGlobalMemory->DebugState;
+    DebugState->CallPaths = PushArray(&DebugState->Arena, MAX_DEBUG_CALL_PATH_COUNT, debug_call_path);
+    DebugState->CallPathKeys = PushArray(&DebugState->Arena, DEBUG_CALL_PATH_SLOT_COUNT, u64);
+    DebugState->CallPathSlots = PushArray(&DebugState->Arena, DEBUG_CALL_PATH_SLOT_COUNT, u32);
+    ClearCallPaths(DebugState);
   }
 
   if(!DebugState->Initialized)
@@ -156,6 +387,66 @@ DEBUGGetState()
 
         RegisterMenuEvent(GlobalGameState->MenuInterface, menu_event_type::MouseDown, RecompileButton, 0, DebugRecompileButton, 0 );
       }
+      container_node* DumpArenasButton = ConnectNodeToBack(ButtonContainer, NewContainer(GlobalGameState->MenuInterface));
+      {
+        color_attribute* Color = (color_attribute*) PushAttribute(GlobalGameState->MenuInterface, DumpArenasButton, ATTRIBUTE_COLOR);
+        Color->Color = V4(0.2,0.1,0.3,1);
+
+        text_attribute* Text = (text_attribute*) PushAttribute(GlobalGameState->MenuInterface, DumpArenasButton, ATTRIBUTE_TEXT);
+        str::CopyStringsUnchecked( "DumpArenas", Text->Text );
+        Text->FontSize = FontSize;
+        Text->Color = TextColor;
+
+        size_attribute* SizeAttr = (size_attribute*) PushAttribute(GlobalGameState->MenuInterface, DumpArenasButton, ATTRIBUTE_SIZE);
+        SizeAttr->Width = ContainerSizeT(menu_size_type::ABSOLUTE_, ButtonSize.W);
+        SizeAttr->Height = ContainerSizeT(menu_size_type::RELATIVE_, 1);
+        SizeAttr->LeftOffset = ContainerSizeT(menu_size_type::RELATIVE_, 0);
+        SizeAttr->TopOffset = ContainerSizeT(menu_size_type::RELATIVE_, 0);
+        SizeAttr->XAlignment = menu_region_alignment::CENTER;
+        SizeAttr->YAlignment = menu_region_alignment::CENTER;
+
+        RegisterMenuEvent(GlobalGameState->MenuInterface, menu_event_type::MouseDown, DumpArenasButton, 0, DebugDumpArenasButton, 0 );
+      }
+      container_node* DumpTraceButton = ConnectNodeToBack(ButtonContainer, NewContainer(GlobalGameState->MenuInterface));
+      {
+        color_attribute* Color = (color_attribute*) PushAttribute(GlobalGameState->MenuInterface, DumpTraceButton, ATTRIBUTE_COLOR);
+        Color->Color = V4(0.2,0.1,0.3,1);
+
+        text_attribute* Text = (text_attribute*) PushAttribute(GlobalGameState->MenuInterface, DumpTraceButton, ATTRIBUTE_TEXT);
+        str::CopyStringsUnchecked( "DumpTrace", Text->Text );
+        Text->FontSize = FontSize;
+        Text->Color = TextColor;
+
+        size_attribute* SizeAttr = (size_attribute*) PushAttribute(GlobalGameState->MenuInterface, DumpTraceButton, ATTRIBUTE_SIZE);
+        SizeAttr->Width = ContainerSizeT(menu_size_type::ABSOLUTE_, ButtonSize.W);
+        SizeAttr->Height = ContainerSizeT(menu_size_type::RELATIVE_, 1);
+        SizeAttr->LeftOffset = ContainerSizeT(menu_size_type::RELATIVE_, 0);
+        SizeAttr->TopOffset = ContainerSizeT(menu_size_type::RELATIVE_, 0);
+        SizeAttr->XAlignment = menu_region_alignment::CENTER;
+        SizeAttr->YAlignment = menu_region_alignment::CENTER;
+
+        RegisterMenuEvent(GlobalGameState->MenuInterface, menu_event_type::MouseDown, DumpTraceButton, 0, DebugDumpTraceButton, 0 );
+      }
+      container_node* BakeAssetsButton = ConnectNodeToBack(ButtonContainer, NewContainer(GlobalGameState->MenuInterface));
+      {
+        color_attribute* Color = (color_attribute*) PushAttribute(GlobalGameState->MenuInterface, BakeAssetsButton, ATTRIBUTE_COLOR);
+        Color->Color = V4(0.2,0.1,0.3,1);
+
+        text_attribute* Text = (text_attribute*) PushAttribute(GlobalGameState->MenuInterface, BakeAssetsButton, ATTRIBUTE_TEXT);
+        str::CopyStringsUnchecked( "BakeAssets", Text->Text );
+        Text->FontSize = FontSize;
+        Text->Color = TextColor;
+
+        size_attribute* SizeAttr = (size_attribute*) PushAttribute(GlobalGameState->MenuInterface, BakeAssetsButton, ATTRIBUTE_SIZE);
+        SizeAttr->Width = ContainerSizeT(menu_size_type::ABSOLUTE_, ButtonSize.W);
+        SizeAttr->Height = ContainerSizeT(menu_size_type::RELATIVE_, 1);
+        SizeAttr->LeftOffset = ContainerSizeT(menu_size_type::RELATIVE_, 0);
+        SizeAttr->TopOffset = ContainerSizeT(menu_size_type::RELATIVE_, 0);
+        SizeAttr->XAlignment = menu_region_alignment::CENTER;
+        SizeAttr->YAlignment = menu_region_alignment::CENTER;
+
+        RegisterMenuEvent(GlobalGameState->MenuInterface, menu_event_type::MouseDown, BakeAssetsButton, 0, DebugBakeAssetsButton, 0 );
+      }
       SettingsPlugin = CreatePlugin(GlobalGameState->MenuInterface, "Settings", V4(0.5,0.5,0.5,1), ButtonContainer);
     }
 
@@ -171,6 +462,17 @@ DEBUGGetState()
       BackgroundColor->Color = V4(0,0,0,0.7);
     }
 
+    // Create arena window
+    container_node* MemoryPlugin = 0;
+    {
+      container_node* ArenaContainer = NewContainer(GlobalGameState->MenuInterface);
+      ArenaContainer->Functions.Draw = DeclareFunction(menu_draw, DrawArenaStatistics);
+
+      MemoryPlugin = CreatePlugin(GlobalGameState->MenuInterface, "Memory", HexCodeToColorV4( 0x4F8BF7 ), ArenaContainer);
+      color_attribute* BackgroundColor = (color_attribute* ) PushAttribute(GlobalGameState->MenuInterface, MemoryPlugin, ATTRIBUTE_COLOR);
+      BackgroundColor->Color = V4(0,0,0,0.7);
+    }
+
     // Create graph window
     container_node* GraphPlugin = 0;
     {
@@ -196,6 +498,7 @@ DEBUGGetState()
     RegisterWindow(GlobalGameState->MenuInterface, WindowsDropDownMenu, SettingsPlugin);
     RegisterWindow(GlobalGameState->MenuInterface, WindowsDropDownMenu, GraphPlugin);
     RegisterWindow(GlobalGameState->MenuInterface, WindowsDropDownMenu, FunctionPlugin);
+    RegisterWindow(GlobalGameState->MenuInterface, WindowsDropDownMenu, MemoryPlugin);
     //ToggleWindow(GlobalGameState->MenuInterface, "Functions");
     //ToggleWindow(GlobalGameState->MenuInterface, "Settings");
     //ToggleWindow(GlobalGameState->MenuInterface, "Profiler");
@@ -203,29 +506,6 @@ DEBUGGetState()
   return DebugState;
 }
 
-void BeginDebugStatistics(debug_statistics* Statistic, debug_record_entry* Record)
-{
-  Statistic->HitCount = 0;
-  Statistic->Min =  R32Max;
-  Statistic->Max = -R32Max;
-  Statistic->Tot = 0;
-  Statistic->Record = Record;
-}
-
-void AccumulateStatistic(debug_statistics* Statistic, r32 Value)
-{
-  if(Statistic->Min > Value)
-  {
-    Statistic->Min = Value;
-  }
-  if(Statistic->Max < Value)
-  {
-    Statistic->Max = Value;
-  }
-  Statistic->Tot += Value;
-  ++Statistic->HitCount;
-}
-
 
 #define DebugRecords_Main_Count __COUNTER__
 
@@ -235,7 +515,7 @@ debug_table* GlobalDebugTable = &GlobalDebugTable_;
 #else
 debug_table* GlobalDebugTable = 0;
 #endif
-internal debug_thread* GetDebugThread(game_memory* Memory, debug_frame* Frame, u16 ThreadID)
+internal debug_thread* GetDebugThread(debug_frame* Frame, u16 ThreadID)
 {
   Assert(ThreadID);
   debug_thread* Result = 0;
@@ -276,47 +556,47 @@ s32 CompareDebugRecordEntry(void* A, void* B)
   return Result;
 }
 
-s32 CompareDebugStatistics(void* A, void* B)
-{
-  debug_statistics* EntryA  = (debug_statistics*) A;
-  debug_statistics* EntryB  = (debug_statistics*) B;
-  s32 Result = str::Compare(EntryA->Record->BlockName, EntryB->Record->BlockName);
-  return Result;
-}
-
 inline u32 GetRecordIndexFromEvent( debug_event* Event )
 {
   u32 Result = Event->TranslationUnit*MAX_DEBUG_RECORD_COUNT + Event->DebugRecordIndex;
   return Result;
 }
 
-void CollateDebugRecords(game_memory* Memory)
+// Turns the events of a finished event array into blocks and statistics
+void CollateDebugRecords(debug_state* DebugState, u32 DebugTableFrame)
 {
-  debug_state* DebugState = DEBUGGetState();
-
-  // Start on the frame after the one we are writing to
-  u32 DebugTableFrame = GlobalDebugTable->CurrentEventArrayIndex - 1;
-  if(GlobalDebugTable->CurrentEventArrayIndex == 0)
-  {
-    DebugTableFrame = MAX_DEBUG_EVENT_ARRAY_COUNT-1;
-  }
-
   debug_frame* Frame = DebugState->Frames + DebugState->CurrentFrameIndex;
 
-  // Get the  statistics list for the current frame;
-  vector_list<debug_statistics>* FrameStatistics = &Frame->Statistics;
-
   // Get the persistent function list from the debug state
   vector_list<debug_record_entry>* FunctionList = &DebugState->FunctionList;
 
   BEGIN_BLOCK(ProfileCollation);
-  u32 EventCount = GlobalDebugTable->EventCount[DebugTableFrame];
-  for(u32 EventIndex = 0;
-          EventIndex < EventCount;
-          ++EventIndex)
+  Frame->DroppedEventCount += GlobalDebugTable->DroppedEventCount[DebugTableFrame];
+  u32* EventCount = GlobalDebugTable->EventCount[DebugTableFrame];
+  u32 EventCursor[MAX_DEBUG_THREAD_COUNT] = {};
+  for(;;)
   {
-    // Get the record and event from the debug table
-    debug_event* Event = GlobalDebugTable->Events[DebugTableFrame] + EventIndex;
+    // Merge the events of all threads, oldest clock first
+    debug_event* Event = 0;
+    u32 EventThread = 0;
+    for(u32 SlotIndex = 0; SlotIndex < MAX_DEBUG_THREAD_COUNT; ++SlotIndex)
+    {
+      if(EventCursor[SlotIndex] < EventCount[SlotIndex])
+      {
+        debug_event* Candidate = GetDebugEvent(GlobalDebugTable, GlobalDebugTable->Threads + SlotIndex, DebugTableFrame, EventCursor[SlotIndex]);
+        if(!Event || Candidate->Clock < Event->Clock)
+        {
+          Event = Candidate;
+          EventThread = SlotIndex;
+        }
+      }
+    }
+    if(!Event)
+    {
+      break;
+    }
+    ++EventCursor[EventThread];
+
     debug_record* DebugRecord = (GlobalDebugTable->Records[Event->TranslationUnit] + Event->DebugRecordIndex);
 
     u32 RecordIndex = GetRecordIndexFromEvent(Event);
@@ -325,31 +605,30 @@ void CollateDebugRecords(game_memory* Memory)
     {
       case DebugEvent_FrameMarker:
       {
-        if(Frame->FirstFreeBlock)
+        if(Frame->Begun)
         {
           Frame->EndClock = Event->Clock;
           Frame->WallSecondsElapsed = Event->SecondsElapsed;
         }
 
-        u32 MaxFrameCount = ArrayCount(DebugState->Frames);
         ++Frame;
         ++DebugState->CurrentFrameIndex;
-        if(DebugState->CurrentFrameIndex >= MaxFrameCount)
+        if(DebugState->CurrentFrameIndex >= DebugState->FrameCount)
         {
           DebugState->CurrentFrameIndex = 0;
           Frame = DebugState->Frames;
         }
         
-        ClearFrame(Frame);
+        ClearFrame(DebugState, Frame);
         
         Frame->BeginClock = Event->Clock;
-        Frame->FirstFreeBlock = Frame->Blocks;
-        *Frame->FirstFreeBlock = {};
+        Frame->Begun = true;
+        ++DebugState->StatsFrameCount;
         
       }break;
       case DebugEvent_BeginBlock:
       {
-        if(Frame->FirstFreeBlock)
+        if(Frame->Begun)
         {
           debug_record_entry* RecordEntry = 0;
           if(!FunctionList->Exists(RecordIndex))
@@ -357,27 +636,25 @@ void CollateDebugRecords(game_memory* Memory)
             debug_record_entry Entry{};
             str::CopyStringsUnchecked(DebugRecord->BlockName, Entry.BlockName); 
             Entry.LineNumber = DebugRecord->LineNumber;
+            Entry.RecordIndex = RecordIndex;
             RecordEntry = FunctionList->PushBack(Entry, RecordIndex);
           }else{
             RecordEntry = FunctionList->GetFromVector(RecordIndex);
           }
           
-          debug_thread* Thread = GetDebugThread(Memory, Frame, Event->TC.ThreadID);
-          debug_block* Block = Frame->FirstFreeBlock++;
-          *Frame->FirstFreeBlock = {};
-          midx BlockCount = Block - Frame->Blocks;
-          if(BlockCount >= MAX_BLOCKS_PER_FRAME)
-          {
-            // TODO: Handle this case somehow by growing the Block-vector by chunks
-            //       For now just change the MAX_BLOCKS_PER_FRAME if we hit this assert
-            Assert(0);
-          }
+          debug_thread* Thread = GetDebugThread(Frame, Event->TC.ThreadID);
+          debug_block* Block = PushDebugBlock(DebugState, Frame);
 
           Block->Record = RecordEntry;
           Block->ThreadIndex = Thread->ID;
           Block->BeginClock = Event->Clock - Frame->BeginClock;
           Block->EndClock = 0;
           Block->OpeningEvent = *Event;
+          Block->HasCounters = false;
+          if(Event->TC.CounterSample)
+          {
+            Block->Counters = GlobalDebugTable->Threads[EventThread].CounterSamples[DebugTableFrame][Event->TC.CounterSample-1];
+          }
 
           // Set the opening block for this thread
           if(!Thread->FirstBlock)
@@ -392,6 +669,7 @@ void CollateDebugRecords(game_memory* Memory)
           }
 
           Block->Parent = Thread->OpenBlock;
+          Block->CallPath = GetCallPath(DebugState, Block->Parent ? Block->Parent->CallPath : DEBUG_CALL_PATH_ROOT, RecordIndex, RecordEntry);
 
           if(Thread->ClosedBlock && GetRecordFrom(Thread->ClosedBlock->Parent) == GetRecordFrom(Block->Parent))
           {
@@ -403,12 +681,11 @@ void CollateDebugRecords(game_memory* Memory)
       }break;
       case DebugEvent_EndBlock:
       {
-        if(Frame->FirstFreeBlock)
+        if(Frame->Begun)
         {
-          debug_record_entry* RecordEntry = FunctionList->GetFromVector(RecordIndex);
           Assert(FunctionList->Exists(RecordIndex));
 
-          debug_thread* Thread = GetDebugThread(Memory, Frame, Event->TC.ThreadID);
+          debug_thread* Thread = GetDebugThread(Frame, Event->TC.ThreadID);
           Assert(Thread->OpenBlock);
           debug_block* Block = Thread->OpenBlock;
           Block->EndClock = Event->Clock - Frame->BeginClock;
@@ -418,33 +695,26 @@ void CollateDebugRecords(game_memory* Memory)
           Assert(OpeningEvent->DebugRecordIndex == Event->DebugRecordIndex);
           Assert(OpeningEvent->TranslationUnit  == Event->TranslationUnit);
 
-          Thread->ClosedBlock = Block;
-          
-          Thread->OpenBlock = Block->Parent;
-
-          u32 Hash = utils::djb2_hash(RecordEntry->BlockName);
-          u32 HashedIndex = Hash % FrameStatistics->maxSize();
-          debug_statistics* Statistic = 0;
-          b32 EntryFound = false;
-          while(FrameStatistics->Exists(HashedIndex))
+          // Both ends have to be sampled, the record may have been flagged while the block was open
+          if(OpeningEvent->TC.CounterSample && Event->TC.CounterSample)
           {
-            Statistic = FrameStatistics->GetFromVector(HashedIndex);
-            if(str::ExactlyEquals(Statistic->Record->BlockName, RecordEntry->BlockName))
+            debug_counter_sample* EndSample = GlobalDebugTable->Threads[EventThread].CounterSamples[DebugTableFrame] + (Event->TC.CounterSample-1);
+            for(u32 CounterIndex = 0; CounterIndex < DEBUG_COUNTER_COUNT; ++CounterIndex)
             {
-              EntryFound = true;
-              break;
+              Block->Counters.Values[CounterIndex] = EndSample->Values[CounterIndex] - Block->Counters.Values[CounterIndex];
             }
-            ++HashedIndex;
+            Block->HasCounters = true;
           }
 
-          if(!EntryFound)
+          Thread->ClosedBlock = Block;
+          
+          Thread->OpenBlock = Block->Parent;
+
+          if(Block->Parent)
           {
-            debug_statistics Stats = {};
-            BeginDebugStatistics(&Stats, RecordEntry);
-            Statistic = FrameStatistics->PushBack(Stats, HashedIndex);
+            Block->Parent->ChildCycles += Block->EndClock - Block->BeginClock;
           }
-
-          AccumulateStatistic(Statistic, (r32)(Block->EndClock - Block->BeginClock));
+          AccumulateBlockStatistics(DebugState, Block, false);
         }
       }break;
     }
@@ -462,11 +732,13 @@ DebugRewriteConfigFile()
 "#define MULTI_THREADED %d // b32\n\
 #define SHOW_COLLISION_POINTS %d // b32\n\
 #define SHOW_COLLIDER %d // b32\n\
-#define SHOW_AABB_TREE %d // b32",
+#define SHOW_AABB_TREE %d // b32\n\
+#define PROFILER_FRAME_COUNT %d // u32",
     DebugState->ConfigMultiThreaded,
     DebugState->ConfigCollisionPoints,
     DebugState->ConfigCollider,
-    DebugState->ConfigAABBTree);
+    DebugState->ConfigAABBTree,
+    DebugState->FrameCount);
   thread_context Dummy = {};
 
   Platform.DEBUGPlatformWriteEntireFile(&Dummy, "W:\\handmade\\code\\debug_config.h", Size, Buffer);
@@ -478,41 +750,349 @@ DebugRewriteConfigFile()
 }
 
 
+internal void
+AddArenaReportEntry(debug_state* DebugState, const c8* Name, memory_arena* Arena, b32 ExecutableReloaded)
+{
+  Assert(DebugState->ArenaReportCount < ArrayCount(DebugState->ArenaReport));
+  Assert(str::StringLength(Name) < ArrayCount(DebugState->ArenaReport[0].Name));
+
+  // The file names of the call sites point into the game dll that was just unloaded
+  if(ExecutableReloaded)
+  {
+    Arena->Stats.CallSiteCount = 0;
+    Arena->Stats.OtherBytes = 0;
+    ZeroArray(ArrayCount(Arena->Stats.CallSites), Arena->Stats.CallSites);
+  }
+
+  arena_report_entry* Entry = DebugState->ArenaReport + DebugState->ArenaReportCount++;
+  str::CopyStringsUnchecked(Name, Entry->Name);
+  Entry->Stats = Arena->Stats;
+  Entry->TailBytes = GetArenaTailBytes(Arena);
+  EndArenaStatsFrame(Arena);
+}
+
+internal void
+CollateArenaStats(game_state* GameState, debug_state* DebugState)
+{
+  TIMED_FUNCTION();
+  b32 Reloaded = GameState->Input->ExecutableReloaded;
+  DebugState->ArenaReportCount = 0;
+  AddArenaReportEntry(DebugState, "Persistent",  &GameState->PersistentArena, Reloaded);
+  AddArenaReportEntry(DebugState, "Transient",   GameState->TransientArena, Reloaded);
+  AddArenaReportEntry(DebugState, "WorldGroup",  &GameState->RenderCommands->WorldGroup->Arena, Reloaded);
+  AddArenaReportEntry(DebugState, "OverlayGroup",&GameState->RenderCommands->OverlayGroup->Arena, Reloaded);
+  AddArenaReportEntry(DebugState, "Entities",    &GameState->EntityManager->Arena, Reloaded);
+  AddArenaReportEntry(DebugState, "Assets",      &GameState->AssetManager->AssetArena, Reloaded);
+  AddArenaReportEntry(DebugState, "Debug",       &DebugState->Arena, Reloaded);
+  for(u32 ThreadIndex = 0; ThreadIndex < SCRATCH_THREAD_COUNT; ++ThreadIndex)
+  {
+    for(u32 ArenaIndex = 0; ArenaIndex < SCRATCH_ARENA_COUNT; ++ArenaIndex)
+    {
+      c8 Name[32] = {};
+      Platform.DEBUGFormatString(Name, sizeof(Name), sizeof(Name)-1, "Scratch %d.%d", ThreadIndex, ArenaIndex);
+      AddArenaReportEntry(DebugState, Name, &GameState->ScratchPool.Arenas[ThreadIndex][ArenaIndex], Reloaded);
+    }
+  }
+}
+
+// Writes the last arena report as json, sizes are in bytes
+internal void
+WriteArenaReport(debug_state* DebugState, c8* FileName)
+{
+  memory_arena* Arena = GlobalGameState->TransientArena;
+  ScopedMemory Memory(Arena);
+
+  midx BufferSize = Kilobytes(256);
+  c8* Buffer = PushArray(Arena, BufferSize, c8, NoClear());
+  midx Used = 0;
+  auto Append = [Buffer, BufferSize, &Used](const c8* Format, auto... Args)
+  {
+    s32 Count = (s32) Platform.DEBUGFormatString(Buffer + Used, BufferSize - Used, BufferSize - Used - 1, Format, Args...);
+    Assert(Count >= 0);
+    Used += Count;
+  };
+
+  Append("{\n  \"arenas\": [");
+  for(u32 EntryIndex = 0; EntryIndex < DebugState->ArenaReportCount; ++EntryIndex)
+  {
+    arena_report_entry* Entry = DebugState->ArenaReport + EntryIndex;
+    arena_stats* Stats = &Entry->Stats;
+    Append("%s\n    {\"name\": \"%s\", \"push_count\": %llu, \"bytes_pushed\": %llu, "
+           "\"frame_bytes_pushed\": %llu, \"peak_frame_bytes_pushed\": %llu, \"alignment_bytes\": %llu, "
+           "\"tail_bytes\": %llu, \"blocks_allocated\": %llu, \"block_count\": %u, \"block_bytes\": %llu, "
+           "\"peak_block_bytes\": %llu, \"used_bytes\": %llu, \"peak_used_bytes\": %llu, \"peak_temp_count\": %d, "
+           "\"other_call_site_bytes\": %llu,\n     \"call_sites\": [",
+           EntryIndex ? "," : "", Entry->Name, Stats->PushCount, Stats->BytesPushed,
+           Stats->FrameBytesPushed, Stats->PeakFrameBytesPushed, Stats->AlignmentBytes,
+           Entry->TailBytes, Stats->BlocksAllocated, Stats->BlockCount, Stats->BlockBytes,
+           Stats->PeakBlockBytes, Stats->UsedBytes, Stats->PeakUsedBytes, Stats->PeakTempCount,
+           Stats->OtherBytes);
+    for(u32 SiteIndex = 0; SiteIndex < Stats->CallSiteCount; ++SiteIndex)
+    {
+      arena_call_site* Site = Stats->CallSites + SiteIndex;
+      Append("%s\n       {\"file\": \"", SiteIndex ? "," : "");
+      // Windows paths, escape the separators
+      for(const c8* At = Site->File; *At; ++At)
+      {
+        Append(*At == '\\' ? "\\\\" : "%c", *At);
+      }
+      Append("\", \"line\": %u, \"push_count\": %u, \"bytes\": %llu}", Site->Line, Site->PushCount, Site->Bytes);
+    }
+    Append("]}");
+  }
+  Append("\n  ]\n}\n");
+
+  thread_context Dummy = {};
+  Platform.DEBUGPlatformWriteEntireFile(&Dummy, FileName, (u32) Used, Buffer);
+}
+
+MENU_EVENT_CALLBACK(DebugDumpArenasButton)
+{
+  WriteArenaReport(DEBUGGetState(), ARENA_REPORT_PATH);
+}
+
+internal b32
+IsCompleteFrame(debug_frame* Frame)
+{
+  b32 Result = Frame->Begun && Frame->EndClock > Frame->BeginClock && Frame->WallSecondsElapsed > 0;
+  return Result;
+}
+
+// Streams the last FrameCount collated frames to FileName in the Chrome trace event format
+// (chrome://tracing, ui.perfetto.dev). Each thread gets a lane, blocks become complete events,
+// frame markers instant events and the frame time and block count are written as counters.
+// Returns how many frames were written.
+internal u32
+WriteChromeTrace(debug_state* DebugState, c8* FileName, u32 FrameCount)
+{
+  memory_arena* Arena = GlobalGameState->TransientArena;
+  ScopedMemory Memory(Arena);
+
+  midx BufferSize = Kilobytes(256);
+  midx FlushSize = BufferSize - Kilobytes(16); // Room for the largest frame header
+  c8* Buffer = PushArray(Arena, BufferSize, c8, NoClear());
+  midx Used = 0;
+  b32 FileStarted = false;
+  thread_context Dummy = {};
+  auto Flush = [&]()
+  {
+    if(FileStarted)
+    {
+      Platform.DEBUGPlatformAppendToFile(&Dummy, FileName, (u32) Used, Buffer);
+    }else{
+      Platform.DEBUGPlatformWriteEntireFile(&Dummy, FileName, (u32) Used, Buffer);
+      FileStarted = true;
+    }
+    Used = 0;
+  };
+  auto Append = [Buffer, BufferSize, &Used](const c8* Format, auto... Args)
+  {
+    s32 Count = (s32) Platform.DEBUGFormatString(Buffer + Used, BufferSize - Used, BufferSize - Used - 1, Format, Args...);
+    Assert(Count >= 0);
+    Used += Count;
+  };
+  auto AppendEscaped = [&Append](const c8* String)
+  {
+    for(const c8* At = String; *At; ++At)
+    {
+      Append((*At == '\\' || *At == '"') ? "\\%c" : "%c", *At);
+    }
+  };
+
+  // Oldest frame first, the frame currently being collated is never complete
+  u32 MaxFrameCount = DebugState->FrameCount;
+  FrameCount = Minimum(FrameCount, MaxFrameCount - 1);
+  u32 FirstFrameIndex = (DebugState->CurrentFrameIndex + MaxFrameCount - FrameCount) % MaxFrameCount;
+
+  // Clocks are converted with the average rate over the exported frames so the timeline is continuous
+  u64 FirstClock = 0;
+  u64 TotalCycles = 0;
+  r64 TotalSeconds = 0;
+  for(u32 Offset = 0; Offset < FrameCount; ++Offset)
+  {
+    debug_frame* Frame = DebugState->Frames + (FirstFrameIndex + Offset) % MaxFrameCount;
+    if(IsCompleteFrame(Frame))
+    {
+      FirstClock = FirstClock ? FirstClock : Frame->BeginClock;
+      TotalCycles += Frame->EndClock - Frame->BeginClock;
+      TotalSeconds += Frame->WallSecondsElapsed;
+    }
+  }
+  if(!TotalCycles)
+  {
+    return 0;
+  }
+  r64 MicrosecondsPerCycle = (TotalSeconds * 1000000.0) / (r64) TotalCycles;
+
+  Append("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  Append("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": 0, \"args\": {\"name\": \"breadboard\"}}");
+
+  u32 NamedThreads[MAX_THREAD_COUNT] = {};
+  u32 NamedThreadCount = 0;
+  u32 WrittenFrameCount = 0;
+  for(u32 Offset = 0; Offset < FrameCount; ++Offset)
+  {
+    debug_frame* Frame = DebugState->Frames + (FirstFrameIndex + Offset) % MaxFrameCount;
+    if(!IsCompleteFrame(Frame))
+    {
+      continue;
+    }
+    if(Used > FlushSize)
+    {
+      Flush();
+    }
+
+    r64 FrameBegin = (r64)(Frame->BeginClock - FirstClock) * MicrosecondsPerCycle;
+    u32 BlockCount = Frame->BlockCount;
+    Append(",\n{\"name\": \"Frame\", \"ph\": \"i\", \"s\": \"g\", \"ts\": %.3f, \"pid\": 0, \"tid\": 0}", FrameBegin);
+    Append(",\n{\"name\": \"Frame\", \"ph\": \"C\", \"ts\": %.3f, \"pid\": 0, \"args\": {\"ms\": %.3f, \"blocks\": %u, \"dropped\": %u}}",
+           FrameBegin, Frame->WallSecondsElapsed * 1000.0, BlockCount, Frame->DroppedEventCount);
+
+    // One lane per thread, named the first time it shows up
+    for(u32 ThreadIndex = 0; ThreadIndex < MAX_THREAD_COUNT && Frame->Threads[ThreadIndex].ID; ++ThreadIndex)
+    {
+      u32 ThreadID = Frame->Threads[ThreadIndex].ID;
+      b32 Named = false;
+      for(u32 NamedIndex = 0; NamedIndex < NamedThreadCount; ++NamedIndex)
+      {
+        Named |= NamedThreads[NamedIndex] == ThreadID;
+      }
+      if(!Named && NamedThreadCount < ArrayCount(NamedThreads))
+      {
+        NamedThreads[NamedThreadCount++] = ThreadID;
+        b32 MainThread = ThreadID == (u16) DebugGlobalMemory->ThreadID[0];
+        Append(",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %u, \"args\": {\"name\": \"%s %u\"}}",
+               ThreadID, MainThread ? "Main" : "Worker", ThreadID);
+        Append(",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 0, \"tid\": %u, \"args\": {\"sort_index\": %u}}",
+               ThreadID, MainThread ? 0 : NamedThreadCount);
+      }
+    }
+
+    for(debug_block_chunk* Chunk = Frame->FirstChunk; Chunk; Chunk = Chunk->Next)
+    for(debug_block* Block = Chunk->Blocks; Block < Chunk->Blocks + Chunk->Count; ++Block)
+    {
+      // Blocks still open when the frame ended are cut at the frame end
+      u64 EndClock = Block->EndClock ? Block->EndClock : Frame->EndClock - Frame->BeginClock;
+      r64 Begin = FrameBegin + (r64) Block->BeginClock * MicrosecondsPerCycle;
+      r64 Duration = (r64)(EndClock - Block->BeginClock) * MicrosecondsPerCycle;
+      Append(",\n{\"name\": \"");
+      AppendEscaped(Block->Record->BlockName);
+      Append("\", \"cat\": \"block\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 0, \"tid\": %u, \"args\": {\"line\": %u",
+             Begin, Duration, Block->ThreadIndex, Block->Record->LineNumber);
+      if(Block->HasCounters)
+      {
+        for(u32 CounterIndex = 0; CounterIndex < Platform.DEBUGPerformanceCounterCount; ++CounterIndex)
+        {
+          Append(", \"%s\": %llu", Platform.DEBUGPerformanceCounterNames[CounterIndex], Block->Counters.Values[CounterIndex]);
+        }
+      }
+      Append("}}");
+      if(Used > FlushSize)
+      {
+        Flush();
+      }
+    }
+    ++WrittenFrameCount;
+  }
+  Append("\n]}\n");
+  Flush();
+  return WrittenFrameCount;
+}
+
+MENU_EVENT_CALLBACK(DebugDumpTraceButton)
+{
+  debug_state* DebugState = DEBUGGetState();
+  WriteChromeTrace(DebugState, TRACE_EXPORT_PATH, DebugState->FrameCount);
+}
+
+// Writes the asset pack the next start maps instead of loading the source assets
+MENU_EVENT_CALLBACK(DebugBakeAssetsButton)
+{
+  game_asset_manager* AssetManager = GlobalGameState->AssetManager;
+  if(!AssetManager->FromAssetPack)
+  {
+    AssetManager->BakeAssetPack = true;
+  }
+}
+
+PLATFORM_WORK_QUEUE_CALLBACK(DoDebugCollation)
+{
+  debug_state* DebugState = (debug_state*) Data;
+  CollateDebugRecords(DebugState, DebugState->CollationEventArrayIndex);
+  CompilerBarrier();
+  DebugState->Collating = false;
+}
+
+// Called before anything reads the collated frames or the event array being collated is reused
+internal void
+WaitForDebugCollation(debug_state* DebugState)
+{
+  TIMED_FUNCTION();
+  while(DebugState->Collating) {_mm_pause();}
+}
+
 extern "C" DEBUG_GAME_FRAME_END(DEBUGGameFrameEnd)
 {
   if(!GlobalDebugTable) return 0;
   GlobalDebugTable->RecordCount[0] = DebugRecords_Main_Count; // This stores the amount of records found is the first translation unit, (The Game)
 
-  // Increment which event-array we should  be writing to. (Each frame writes into it's own array)
-  ++GlobalDebugTable->CurrentEventArrayIndex;
-  if(GlobalDebugTable->CurrentEventArrayIndex >= ArrayCount(GlobalDebugTable->Events))
+  // The array the threads move over to is the one collated during the last frame
+  debug_state* DebugState = DEBUGGetState();
+  WaitForDebugCollation(DebugState);
+
+  // Move all threads over to the next event array. (Each frame writes into it's own array)
+  u32 EventArrayIndex = GlobalDebugTable->CurrentEventArrayIndex; // The event array we just finished writing to
+  u32 NextEventArrayIndex = EventArrayIndex + 1;
+  if(NextEventArrayIndex >= MAX_DEBUG_EVENT_ARRAY_COUNT)
   {
     // Wrap if we reached the final array
-    GlobalDebugTable->CurrentEventArrayIndex=0;
+    NextEventArrayIndex = 0;
   }
+  // Its chunks belonged to the collated frame, nobody writes to it until the swap
+  GlobalDebugTable->EventChunkCount[NextEventArrayIndex] = 0;
+  CompilerBarrier();
+  GlobalDebugTable->CurrentEventArrayIndex = NextEventArrayIndex;
+
+  // A thread that read the old index before the swap raised its Writing flag before it did.
+  // Once the flush has made those flags visible, wait for the writes to land and take the counts.
+  Platform.DEBUGFlushWriteBuffers();
+  GlobalDebugTable->DroppedEventCount[EventArrayIndex] = 0;
+  for(u32 SlotIndex = 0; SlotIndex < MAX_DEBUG_THREAD_COUNT; ++SlotIndex)
+  {
+    debug_thread_events* Slot = GlobalDebugTable->Threads + SlotIndex;
+    while(Slot->Writing) {_mm_pause();}
+    GlobalDebugTable->EventCount[EventArrayIndex][SlotIndex] = Slot->EventCount[EventArrayIndex];
+    GlobalDebugTable->DroppedEventCount[EventArrayIndex] += Slot->DroppedEventCount[EventArrayIndex];
+    Slot->EventCount[EventArrayIndex] = 0;
+    Slot->DroppedEventCount[EventArrayIndex] = 0;
+    Slot->CounterSampleCount[EventArrayIndex] = 0; // The collator finds the samples through the events
+  }
+  GlobalDebugTable->ReadPerformanceCounters = Platform.DEBUGReadPerformanceCounters;
 
-  // Shift CurrentEventArrayIndex to the high bits of ArrayIndex_EventIndex.
-  //  The old value of ArrayIndex_EventIndex is returned by AtomicExchangeu64
-  // Note the low bits "EventIndex" is zeroed out since we wanna start writing from the top of the array next frame.
-  // EventIndex is incremented each time we run through a TIMED_FUNCTION macro
-  u64 ArrayIndex_EventIndex = AtomicExchangeu64(&GlobalDebugTable->EventArrayIndex_EventIndex,          // The new value is stored in this variable
-                                               ((u64)GlobalDebugTable->CurrentEventArrayIndex << 32));  // This is the new value
-
-  u32 EventArrayIndex = (ArrayIndex_EventIndex >> 32);         // The event array index we just finished writing to
-  u32 EventCount = (ArrayIndex_EventIndex & 0xFFFFFFFF);       // The number of events encountered last frame
-  GlobalDebugTable->EventCount[EventArrayIndex] = EventCount;  // The frame "EventArrayIndex" saw "EventCount" Recorded Events
-
-  debug_state* DebugState = DEBUGGetState();
   if(DebugState)
   {
     if(Memory->GameState->Input->ExecutableReloaded)
     {
       ResetCollation();
+      if(DebugState->FrameCount != PROFILER_FRAME_COUNT)
+      {
+        SetDebugFrameCount(DebugState, PROFILER_FRAME_COUNT);
+      }
     }
     if(!DebugState->Paused)
     {
-      CollateDebugRecords(Memory);
+      // The main thread only hands the finished array over, it is collated while the next frame runs.
+      // It has a queue of its own so nothing waits behind it and it never waits behind asset loads.
+      DebugState->CollationEventArrayIndex = EventArrayIndex;
+      if(DebugState->ConfigMultiThreaded)
+      {
+        DebugState->Collating = true;
+        Platform.PlatformAddEntry(Platform.DebugQueue, DoDebugCollation, DebugState);
+      }else{
+        CollateDebugRecords(DebugState, EventArrayIndex);
+      }
     }
+    CollateArenaStats(Memory->GameState, DebugState);
   }
   return GlobalDebugTable;
 }
@@ -523,9 +1103,9 @@ void DEBUGAddTextSTB(const c8* String, r32 LineNumber, u32 FontSize)
 {
   TIMED_FUNCTION();
   game_window_size WindowSize = GameGetWindowSize();
-  stb_font_map* FontMap = GetFontMap(GlobalGameState->AssetManager, FontSize);
+  font_metrics Metrics = GetFontMetrics(GlobalGameState->AssetManager->FontCache, DEFAULT_FONT, FontSize);
   r32 CanPosX = 1/100.f;
-  r32 CanPosY = 1 - ((LineNumber+1) * FontMap->Ascent - LineNumber*FontMap->Descent)/WindowSize.HeightPx;
+  r32 CanPosY = 1 - ((LineNumber+1) * Metrics.Ascent - LineNumber*Metrics.Descent)/WindowSize.HeightPx;
   PushTextAt(CanPosX, CanPosY, String, FontSize, V4(1,1,1,1));
 }
 
@@ -533,118 +1113,78 @@ void DEBUGAddTextSTB(const c8* String, r32 LineNumber, u32 FontSize)
 MENU_DRAW(DrawStatistics)
 {
   TIMED_FUNCTION();
-  BEGIN_BLOCK(AllocatingMemory);
   rect2f Region = Shrink(Node->Region,0.01);
   debug_state* DebugState = DEBUGGetState();
-
-  ScopedMemory Memory(GlobalGameState->TransientArena);
-  memory_arena* Arena = GlobalGameState->TransientArena;
-  
-  vector_list<debug_statistics> CumulativeStats = vector_list<debug_statistics>(GlobalGameState->TransientArena, MAX_DEBUG_FUNCTION_COUNT);
   vector_list<debug_record_entry>* DebugFunctions = &DebugState->FunctionList;
-  END_BLOCK(AllocatingMemory);
-  // TODO: This loop is super slow and it's unecessary to loop through it all every frame.
-  //       Instead we can store the sum of CycleCount and HitCount for all previous farmes
-  //       in each frame and calculate the average by just going through the latest frame
-
-  // For each frame and for each debug-record: 
-  u32 RowCount = 0;
-  u32 CurrentFrameIndex = DebugState->CurrentFrameIndex == 0 ? MAX_DEBUG_FRAME_COUNT-1 : DebugState->CurrentFrameIndex-1;
-  u32 FrameCount = 0;
+
+  // The record statistics already cover the whole history, only turn them into per frame numbers
   BEGIN_BLOCK(SummingStats);
-  for(u32 FrameIndex = 0; FrameIndex < ArrayCount(DebugState->Frames); ++FrameIndex)
+  r32 FrameCount = (r32) Maximum(DebugState->StatsFrameCount, 1);
+  for(debug_record_entry* Record = DebugFunctions->First(); Record; Record = DebugFunctions->Next(Record))
   {
-    FrameCount++;
-    debug_frame* Frame = DebugState->Frames + FrameIndex;
-    u64 FrameCycleCount = Frame->EndClock - Frame->BeginClock;
-
-    vector_list<debug_statistics>* FrameStatistics = &Frame->Statistics;
-    debug_statistics*  Stat = FrameStatistics->First();
-    
-    while(Stat)
+    debug_record_stats* Stats = Record->Stats;
+    if(!Stats || !Stats->HitCount)
     {
-      Assert(Stat->HitCount);
-
-      u32 ArrayIndex = FrameStatistics->GetIndexOfEntry(Stat);
-
-      debug_statistics* CumulativeStat = CumulativeStats.GetFromVector(ArrayIndex);
-
-      if(!CumulativeStats.Exists(ArrayIndex))
-      {
-        debug_statistics NewStatisticEntry{};
-        BeginDebugStatistics(&NewStatisticEntry, Stat->Record);
-        CumulativeStat = CumulativeStats.PushBack(NewStatisticEntry, ArrayIndex);
-      }
-
-      CumulativeStat->HitCount += Stat->HitCount;
-      CumulativeStat->Min = Minimum(CumulativeStat->Min, Stat->Min);
-      CumulativeStat->Max = Maximum(CumulativeStat->Max, Stat->Max);
-      CumulativeStat->Tot += Stat->Tot;
-
-      Stat = FrameStatistics->Next(Stat);
+      Record->CycleCount = 0;
+      Record->ExclusiveCycleCount = 0;
+      Record->HitCount = 0;
+      Record->HCCount = 0;
+      Record->P50 = Record->P95 = Record->P99 = 0;
+      continue;
     }
-  }
 
-  debug_statistics* Stat = CumulativeStats.First();
-  while(Stat)
-  {
-    Assert(Stat->HitCount);
-
-    r32 HitCount = (Stat->HitCount / (r32) FrameCount);
-    r32 CycleCount = (Stat->Tot / (r32) FrameCount);
-
-    debug_record_entry* Record = Stat->Record;
-    u32 ArrayIndex = DebugFunctions->GetIndexOfEntry(Record);
-    Assert(DebugFunctions->Exists(ArrayIndex));
+    r32 HitCount = Stats->HitCount / FrameCount;
+    r32 CycleCount = Stats->InclusiveCycles / FrameCount;
 
     Record->CycleCount = (u32) CycleCount;
+    Record->ExclusiveCycleCount = (u32) (Stats->ExclusiveCycles / FrameCount);
     Record->HitCount = Ciel(HitCount);
     Record->HCCount = Ciel(CycleCount/HitCount);
-
-    Stat = CumulativeStats.Next(Stat);
+    Record->P50 = (u32) GetHistogramPercentile(Stats, 0.50f);
+    Record->P95 = (u32) GetHistogramPercentile(Stats, 0.95f);
+    Record->P99 = (u32) GetHistogramPercentile(Stats, 0.99f);
   }
-
   END_BLOCK(SummingStats);
 
 
-  u32 Cols = 5;
   u32 FontSize = 8;
   r32 LineHeight = GetTextLineHeightSize(FontSize);
-  rect2f HeaderRects[5] = {};
   char* Text[] = {"LineNumber ",
                   "BlockName  ",
                   "  CycleCount",
                   "  HitCount",
-                  "Cy/Hi"};
-  r32 ColWidthPercent[5] = {};
-  r32 ColWidthSum[5] = {};
+                  "Cy/Hi",
+                  "  Excl",
+                  "  p50",
+                  "  p95",
+                  "  p99"};
+  const u32 Cols = ArrayCount(Text);
+  r32 ColWidthPercent[Cols] = {};
+  r32 ColWidthSum[Cols] = {};
 
   r32 Width = GetTextWidth(Text[0], FontSize);
   ColWidthPercent[0] = Width / Region.W;
-  ColWidthSum[1] = ColWidthPercent[0];
-  ColWidthPercent[1] = 0.4;
-  ColWidthSum[2] = ColWidthSum[1] + ColWidthPercent[1];
-  r32 RemainingWidth =1.f - (ColWidthPercent[0] + ColWidthPercent[1]);
-
-  ColWidthPercent[2] = RemainingWidth/3.f;
-  ColWidthSum[3] = ColWidthSum[2] + ColWidthPercent[2];
-  ColWidthPercent[3] = RemainingWidth/3.f;
-  ColWidthSum[4] =ColWidthSum[3] + ColWidthPercent[3];
-  ColWidthPercent[4] = RemainingWidth/3.f;
-
-  rect2f TextRect[] = {
-    Rect2f(Region.X + Region.W * ColWidthSum[0], Region.Y + Region.H - LineHeight, Region.W * ColWidthPercent[0], LineHeight ),
-    Rect2f(Region.X + Region.W * ColWidthSum[1], Region.Y + Region.H - LineHeight, Region.W * ColWidthPercent[1], LineHeight ),
-    Rect2f(Region.X + Region.W * ColWidthSum[2], Region.Y + Region.H - LineHeight, Region.W * ColWidthPercent[2], LineHeight ),
-    Rect2f(Region.X + Region.W * ColWidthSum[3], Region.Y + Region.H - LineHeight, Region.W * ColWidthPercent[3], LineHeight ),
-    Rect2f(Region.X + Region.W * ColWidthSum[4], Region.Y + Region.H - LineHeight, Region.W * ColWidthPercent[4], LineHeight )
-  };
-  
+  ColWidthPercent[1] = 0.3;
+  r32 RemainingWidth = 1.f - (ColWidthPercent[0] + ColWidthPercent[1]);
+  for(u32 Col = 2; Col < Cols; ++Col)
+  {
+    ColWidthPercent[Col] = RemainingWidth/(Cols - 2);
+  }
+
+  rect2f TextRect[Cols] = {};
+  for(u32 Col = 0; Col < Cols; ++Col)
+  {
+    ColWidthSum[Col] = Col ? ColWidthSum[Col-1] + ColWidthPercent[Col-1] : 0;
+    TextRect[Col] = Rect2f(Region.X + Region.W * ColWidthSum[Col], Region.Y + Region.H - LineHeight, Region.W * ColWidthPercent[Col], LineHeight );
+  }
+
+  // Numbers are right aligned
   PushTextAt(TextRect[0].X, TextRect[0].Y, Text[0], FontSize, V4(1,1,1,1));
   PushTextAt(TextRect[1].X, TextRect[1].Y, Text[1], FontSize, V4(1,1,1,1));
-  PushTextAt(TextRect[2].X + TextRect[2].W - GetTextWidth(Text[2], FontSize), TextRect[2].Y, Text[2], FontSize, V4(1,1,1,1));
-  PushTextAt(TextRect[3].X + TextRect[3].W - GetTextWidth(Text[3], FontSize), TextRect[3].Y, Text[3], FontSize, V4(1,1,1,1));
-  PushTextAt(TextRect[4].X + TextRect[4].W - GetTextWidth(Text[4], FontSize), TextRect[4].Y, Text[4], FontSize, V4(1,1,1,1));
+  for(u32 Col = 2; Col < Cols; ++Col)
+  {
+    PushTextAt(TextRect[Col].X + TextRect[Col].W - GetTextWidth(Text[Col], FontSize), TextRect[Col].Y, Text[Col], FontSize, V4(1,1,1,1));
+  }
 
   if(GlobalGameState->MenuInterface->MouseLeftButton.Active)
   {
@@ -773,6 +1313,40 @@ MENU_DRAW(DrawStatistics)
           });
         }
 
+      }else if(Intersects(TextRect[5], Interface->MousePos)){
+        if(DebugState->ExclusiveSorted == function_sorting::Descending || DebugState->ExclusiveSorted == function_sorting::None)
+        {
+          DebugState->ExclusiveSorted = function_sorting::Ascending;
+          DebugFunctions->MergeSort(GlobalGameState->TransientArena, [](debug_record_entry* A, debug_record_entry* B)
+          {
+            b32 Result = A->ExclusiveCycleCount <= B->ExclusiveCycleCount;
+            return Result;
+          });
+        }else if(DebugState->ExclusiveSorted == function_sorting::Ascending){
+          DebugState->ExclusiveSorted = function_sorting::Descending;
+          DebugFunctions->MergeSort(GlobalGameState->TransientArena, [](debug_record_entry* A, debug_record_entry* B)
+          {
+            b32 Result = A->ExclusiveCycleCount >= B->ExclusiveCycleCount;
+            return Result;
+          });
+        }
+      }else if(Intersects(TextRect[8], Interface->MousePos)){
+        if(DebugState->P99Sorted == function_sorting::Descending || DebugState->P99Sorted == function_sorting::None)
+        {
+          DebugState->P99Sorted = function_sorting::Ascending;
+          DebugFunctions->MergeSort(GlobalGameState->TransientArena, [](debug_record_entry* A, debug_record_entry* B)
+          {
+            b32 Result = A->P99 <= B->P99;
+            return Result;
+          });
+        }else if(DebugState->P99Sorted == function_sorting::Ascending){
+          DebugState->P99Sorted = function_sorting::Descending;
+          DebugFunctions->MergeSort(GlobalGameState->TransientArena, [](debug_record_entry* A, debug_record_entry* B)
+          {
+            b32 Result = A->P99 >= B->P99;
+            return Result;
+          });
+        }
       }
     }
   }
@@ -787,12 +1361,24 @@ MENU_DRAW(DrawStatistics)
   v4 OddColor = HexCodeToColorV4(0x9400D3);
   OddColor.W = 0.5;
   b32 EvenRow = false;
+  debug_record_entry* HotEntry = 0;
   debug_record_entry* Entry = DebugFunctions->First();
   while(Entry)
   { 
     rect2f RowRect = Rect2f(Node->Region.X, YPos-LineHeight*0.5f, Node->Region.W, LineHeight*1.5f);
     PushOverlayQuad(RowRect, EvenRow ? EventColor : OddColor );
     EvenRow = !EvenRow;
+    // Clicking a row turns performance counter sampling on or off for the record
+    debug_record* DebugRecord = GetDebugRecord(Entry);
+    if(Intersects(RowRect, Interface->MousePos))
+    {
+      HotEntry = Entry;
+      if(Interface->MouseLeftButton.Edge && Interface->MouseLeftButton.Active)
+      {
+        DebugRecord->Flags ^= DebugRecordFlag_Counters;
+      }
+    }
+    v4 NameColor = (DebugRecord->Flags & DebugRecordFlag_Counters) ? V4(1,1,0,1) : V4(1,1,1,1);
 
     char StringBuffer[512]={};
 
@@ -807,28 +1393,18 @@ MENU_DRAW(DrawStatistics)
     "%s", Entry->BlockName);
 
     XPos = TextRect[1].X;
-    PushTextAt(XPos, YPos, StringBuffer, FontSize, V4(1,1,1,1));
+    PushTextAt(XPos, YPos, StringBuffer, FontSize, NameColor);
 
-    Platform.DEBUGFormatString(StringBuffer, ArrayCount(StringBuffer), ArrayCount(StringBuffer)-1,
-    "%d", (u32) Entry->CycleCount);
-    Width = GetTextWidth(StringBuffer,FontSize);
-    
-    XPos = TextRect[2].X + TextRect[2].W - Width;
-    PushTextAt(XPos, YPos, StringBuffer, FontSize, V4(1,1,1,1));
-
-
-    Platform.DEBUGFormatString(StringBuffer, ArrayCount(StringBuffer), ArrayCount(StringBuffer)-1,
-    "%d", (u32) Entry->HitCount);
-    Width = GetTextWidth(StringBuffer,FontSize);
-    XPos = TextRect[3].X + TextRect[3].W - Width;
-    PushTextAt(XPos, YPos, StringBuffer, FontSize, V4(1,1,1,1));
-
-
-    Platform.DEBUGFormatString(StringBuffer, ArrayCount(StringBuffer), ArrayCount(StringBuffer)-1,
-    "%d", (u32) Entry->HCCount);
-    Width = GetTextWidth(StringBuffer,FontSize);
-    XPos = TextRect[4].X + TextRect[4].W - Width;
-    PushTextAt(XPos, YPos, StringBuffer, FontSize, V4(1,1,1,1));
+    u32 Values[Cols] = {0, 0, Entry->CycleCount, (u32) Entry->HitCount, (u32) Entry->HCCount,
+                        Entry->ExclusiveCycleCount, Entry->P50, Entry->P95, Entry->P99};
+    for(u32 Col = 2; Col < Cols; ++Col)
+    {
+      Platform.DEBUGFormatString(StringBuffer, ArrayCount(StringBuffer), ArrayCount(StringBuffer)-1,
+      "%d", Values[Col]);
+      Width = GetTextWidth(StringBuffer,FontSize);
+      XPos = TextRect[Col].X + TextRect[Col].W - Width;
+      PushTextAt(XPos, YPos, StringBuffer, FontSize, V4(1,1,1,1));
+    }
 
 
     if(YPos-LineHeight < Region.Y){
@@ -841,6 +1417,78 @@ MENU_DRAW(DrawStatistics)
     
   }
 
+  // List the call paths of the hovered record, most expensive first
+  if(HotEntry)
+  {
+    u32 Order[16] = {};
+    u32 OrderCount = 0;
+    for(u32 PathIndex = 1; PathIndex < DebugState->CallPathCount; ++PathIndex)
+    {
+      debug_call_path* Path = DebugState->CallPaths + PathIndex;
+      if(Path->Record != HotEntry || !Path->HitCount)
+      {
+        continue;
+      }
+      u32 Insert = Minimum(OrderCount, ArrayCount(Order) - 1);
+      if(OrderCount == ArrayCount(Order) && DebugState->CallPaths[Order[Insert]].InclusiveCycles >= Path->InclusiveCycles)
+      {
+        continue;
+      }
+      while(Insert > 0 && DebugState->CallPaths[Order[Insert-1]].InclusiveCycles < Path->InclusiveCycles)
+      {
+        Order[Insert] = Order[Insert-1];
+        --Insert;
+      }
+      Order[Insert] = PathIndex;
+      OrderCount = Minimum(OrderCount + 1, ArrayCount(Order));
+    }
+
+    r32 TipY = Interface->MousePos.Y - LineHeight;
+    debug_record_stats* Stats = HotEntry->Stats;
+    if(Stats && Stats->CounterHitCount)
+    {
+      c8 Line[512] = {};
+      u32 Length = 0;
+      for(u32 CounterIndex = 0; CounterIndex < Platform.DEBUGPerformanceCounterCount; ++CounterIndex)
+      {
+        s32 Written = (s32) Platform.DEBUGFormatString(Line + Length, sizeof(Line) - Length, sizeof(Line) - Length - 1, "%s %llu  ",
+          Platform.DEBUGPerformanceCounterNames[CounterIndex], Stats->Counters[CounterIndex] / Stats->CounterHitCount);
+        if(Written < 0)
+        {
+          break;
+        }
+        Length += Written;
+      }
+      PushTextAt(Interface->MousePos.X, TipY, Line, FontSize, V4(0,1,1,1));
+      TipY -= LineHeight;
+    }
+    for(u32 Index = 0; Index < OrderCount; ++Index)
+    {
+      debug_call_path* Path = DebugState->CallPaths + Order[Index];
+
+      // Written from the record up towards the root
+      c8 Chain[512] = {};
+      u32 ChainLength = 0;
+      for(debug_call_path* Parent = Path; Parent != DebugState->CallPaths; Parent = DebugState->CallPaths + Parent->Parent)
+      {
+        s32 Written = (s32) Platform.DEBUGFormatString(Chain + ChainLength, sizeof(Chain) - ChainLength, sizeof(Chain) - ChainLength - 1,
+          Parent == Path ? "%s" : " < %s", Parent->Record->BlockName);
+        if(Written < 0)
+        {
+          break;
+        }
+        ChainLength += Written;
+      }
+
+      c8 Line[1024] = {};
+      Platform.DEBUGFormatString(Line, sizeof(Line), sizeof(Line)-1, "Incl %d Excl %d Hits %d  %s",
+        (u32)(Path->InclusiveCycles / FrameCount), (u32)(Path->ExclusiveCycles / FrameCount),
+        (u32) Ciel(Path->HitCount / FrameCount), Chain);
+      PushTextAt(Interface->MousePos.X, TipY, Line, FontSize, V4(1,1,0,1));
+      TipY -= LineHeight;
+    }
+  }
+
   END_BLOCK(PaintingStats);
 }
 
@@ -972,8 +1620,8 @@ MENU_DRAW(DrawFrameFunctions)
   debug_frame* Frame = DebugState->SelectedFrame;
   if(!Frame)
   {
-    u32 FrameCount = ArrayCount(DebugState->Frames);
-    u32 FrameIndex = (DebugState->CurrentFrameIndex-1) % FrameCount;
+    u32 FrameCount = DebugState->FrameCount;
+    u32 FrameIndex = (DebugState->CurrentFrameIndex + FrameCount - 1) % FrameCount;
     Frame = DebugState->Frames + FrameIndex;
   };
 
@@ -1176,7 +1824,7 @@ MENU_DRAW(DrawFunctionTimeline)
   r32 HeightScaling = FrameTargetHeight/dt;
 
   
-  u32 MaxFramesToDisplay = ArrayCount(DebugState->Frames)-1;
+  u32 MaxFramesToDisplay = DebugState->FrameCount-1;
 
   game_window_size WindowSize = GameGetWindowSize();
   r32 PixelSize = 1.f / WindowSize.HeightPx;
@@ -1191,7 +1839,7 @@ MENU_DRAW(DrawFunctionTimeline)
   r32 MouseX = Interface->MousePos.X;
   r32 MouseY = Interface->MousePos.Y;
 
-  u32 FrameCount =  ArrayCount(DebugState->Frames);
+  u32 FrameCount =  DebugState->FrameCount;
   u32 Count = 0;
   debug_frame* Frame = DebugState->Frames + DebugState->CurrentFrameIndex+1;
   debug_frame* SelectedFrame = 0;
@@ -1243,6 +1891,16 @@ MENU_DRAW(DrawFunctionTimeline)
         "Frame %d: %2.2f Sec (%s)", FrameIndex, Frame->WallSecondsElapsed, Block->Record->BlockName);
 
         PushTextAt(MouseX, MouseY+0.02f, StringBuffer, 24, V4(1,1,1,1));
+        if(Block->HasCounters)
+        {
+          u32 Length = 0;
+          for(u32 CounterIndex = 0; CounterIndex < Platform.DEBUGPerformanceCounterCount; ++CounterIndex)
+          {
+            Length += Platform.DEBUGFormatString( StringBuffer + Length, sizeof(StringBuffer) - Length, sizeof(StringBuffer) - Length - 1,
+            "%s %llu  ", Platform.DEBUGPerformanceCounterNames[CounterIndex], Block->Counters.Values[CounterIndex]);
+          }
+          PushTextAt(MouseX, MouseY+0.02f - GetTextLineHeightSize(24), StringBuffer, 24, V4(0,1,1,1));
+        }
       }
       Block = Block->Next;
     }  
@@ -1281,11 +1939,113 @@ MENU_DRAW(DrawFunctionTimeline)
   PushOverlayQuad(Rect, V4(0,0,0,1));
 }
 
+internal void
+FormatBytes(c8* Buffer, midx BufferSize, u64 Bytes)
+{
+  if(Bytes >= Megabytes(1))
+  {
+    Platform.DEBUGFormatString(Buffer, BufferSize, BufferSize-1, "%.1fM", Bytes / (r64) Megabytes(1));
+  }else if(Bytes >= Kilobytes(1)){
+    Platform.DEBUGFormatString(Buffer, BufferSize, BufferSize-1, "%.1fK", Bytes / (r64) Kilobytes(1));
+  }else{
+    Platform.DEBUGFormatString(Buffer, BufferSize, BufferSize-1, "%llu", Bytes);
+  }
+}
+
+MENU_DRAW(DrawArenaStatistics)
+{
+  TIMED_FUNCTION();
+  debug_state* DebugState = DEBUGGetState();
+  rect2f Region = Shrink(Node->Region, 0.01);
+
+  u32 FontSize = 8;
+  r32 LineHeight = GetTextLineHeightSize(FontSize);
+  v4 TextColor = V4(1,1,1,1);
+
+  const c8* Header[] = {"Arena", "InUse", "Peak", "Blocks", "PeakBlocks", "Frame", "PeakFrame", "Align", "Tail", "Temp"};
+  r32 NameWidth = 0.2f;
+  r32 ColWidth = (1.f - NameWidth) / (ArrayCount(Header) - 1);
+
+  auto PushRow = [&](r32 Y, const c8** Cols)
+  {
+    PushTextAt(Region.X, Y, Cols[0], FontSize, TextColor);
+    for(u32 Col = 1; Col < ArrayCount(Header); ++Col)
+    {
+      r32 Right = Region.X + Region.W * (NameWidth + Col * ColWidth);
+      PushTextAt(Right - GetTextWidth(Cols[Col], FontSize), Y, Cols[Col], FontSize, TextColor);
+    }
+  };
+
+  r32 Y = Region.Y + Region.H - LineHeight;
+  PushRow(Y, Header);
+
+  arena_report_entry* HotEntry = 0;
+  for(u32 EntryIndex = 0; EntryIndex < DebugState->ArenaReportCount; ++EntryIndex)
+  {
+    Y -= LineHeight;
+    arena_report_entry* Entry = DebugState->ArenaReport + EntryIndex;
+    arena_stats* Stats = &Entry->Stats;
+
+    c8 Cells[ArrayCount(Header)][16] = {};
+    FormatBytes(Cells[1], sizeof(Cells[1]), Stats->UsedBytes);
+    FormatBytes(Cells[2], sizeof(Cells[2]), Stats->PeakUsedBytes);
+    FormatBytes(Cells[3], sizeof(Cells[3]), Stats->BlockBytes);
+    FormatBytes(Cells[4], sizeof(Cells[4]), Stats->PeakBlockBytes);
+    FormatBytes(Cells[5], sizeof(Cells[5]), Stats->FrameBytesPushed);
+    FormatBytes(Cells[6], sizeof(Cells[6]), Stats->PeakFrameBytesPushed);
+    FormatBytes(Cells[7], sizeof(Cells[7]), Stats->AlignmentBytes);
+    FormatBytes(Cells[8], sizeof(Cells[8]), Entry->TailBytes);
+    Platform.DEBUGFormatString(Cells[9], sizeof(Cells[9]), sizeof(Cells[9])-1, "%d", Stats->PeakTempCount);
+
+    const c8* Cols[ArrayCount(Header)] = {Entry->Name};
+    for(u32 Col = 1; Col < ArrayCount(Header); ++Col)
+    {
+      Cols[Col] = Cells[Col];
+    }
+    PushRow(Y, Cols);
+
+    if(Intersects(Rect2f(Region.X, Y, Region.W, LineHeight), Interface->MousePos))
+    {
+      HotEntry = Entry;
+    }
+  }
+
+  // List where the hovered arena's memory comes from, biggest first
+  if(HotEntry)
+  {
+    arena_stats* Stats = &HotEntry->Stats;
+    u32 Order[ARENA_MAX_CALL_SITE_COUNT] = {};
+    for(u32 Index = 0; Index < Stats->CallSiteCount; ++Index)
+    {
+      u32 Insert = Index;
+      while(Insert > 0 && Stats->CallSites[Order[Insert-1]].Bytes < Stats->CallSites[Index].Bytes)
+      {
+        Order[Insert] = Order[Insert-1];
+        --Insert;
+      }
+      Order[Insert] = Index;
+    }
+
+    r32 TipY = Interface->MousePos.Y - LineHeight;
+    for(u32 Index = 0; Index < Stats->CallSiteCount; ++Index)
+    {
+      arena_call_site* Site = Stats->CallSites + Order[Index];
+      c8 Bytes[16] = {};
+      FormatBytes(Bytes, sizeof(Bytes), Site->Bytes);
+      c8 Line[512] = {};
+      Platform.DEBUGFormatString(Line, sizeof(Line), sizeof(Line)-1, "%s %s(%d) x%d", Bytes, Site->File, Site->Line, Site->PushCount);
+      PushTextAt(Interface->MousePos.X, TipY, Line, FontSize, V4(1,1,0,1));
+      TipY -= LineHeight;
+    }
+  }
+}
+
 void PushDebugOverlay(game_input* GameInput)
 {
   TIMED_FUNCTION();
 
   debug_state* DebugState = DEBUGGetState();
+  WaitForDebugCollation(DebugState);
 
   if(DebugState->Compiling)
   {
@@ -20,28 +20,60 @@ enum class function_sorting
   Descending
 };
 
+// Log-linear histogram of cycle counts. Every power of two is split in 8 buckets so a
+// percentile read back from it is within 12.5% of the real value.
+#define DEBUG_HISTOGRAM_SUB_BUCKET_BITS 3
+#define DEBUG_HISTOGRAM_SUB_BUCKET_COUNT (1 << DEBUG_HISTOGRAM_SUB_BUCKET_BITS)
+#define DEBUG_HISTOGRAM_MAX_EXPONENT 40 // Longer blocks end up in the last bucket
+#define DEBUG_HISTOGRAM_BUCKET_COUNT ((DEBUG_HISTOGRAM_MAX_EXPONENT - DEBUG_HISTOGRAM_SUB_BUCKET_BITS + 1) * DEBUG_HISTOGRAM_SUB_BUCKET_COUNT)
+
+// Sums over all blocks of a record in the frame history. Frames add their blocks as they are
+// collated and take them away again when they are overwritten.
+struct debug_record_stats
+{
+  u32 HitCount;
+  u64 InclusiveCycles;
+  u64 ExclusiveCycles;                                // Minus the time spent in child blocks
+  u32 Histogram[DEBUG_HISTOGRAM_BUCKET_COUNT];        // Inclusive cycles per hit
+  u32 CounterHitCount;                                // Hits that sampled the performance counters
+  u64 Counters[DEBUG_COUNTER_COUNT];
+  debug_record_stats* NextFree;
+};
+
 struct debug_record_entry
 {
   u32 LineNumber;
+  u32 RecordIndex;               // Translation unit and index into the debug table records
   char BlockName[256];
+  debug_record_stats* Stats;
+
+  // Per frame averages and percentiles, refreshed by DrawStatistics
   u32 CycleCount;
+  u32 ExclusiveCycleCount;
   r32 HitCount;
   r32 HCCount;
+  u32 P50;
+  u32 P95;
+  u32 P99;
 };
 
-struct debug_statistics
+// A record reached through one particular chain of parent blocks
+#define MAX_DEBUG_CALL_PATH_COUNT 4096
+#define DEBUG_CALL_PATH_SLOT_COUNT (2 * MAX_DEBUG_CALL_PATH_COUNT)
+#define DEBUG_CALL_PATH_ROOT 0
+struct debug_call_path
 {
-  r32 HitCount;
-  r32 Min;
-  r32 Max;
-  r32 Tot;
+  u32 Parent;
+  u32 Depth;
   debug_record_entry* Record;
+  u32 HitCount;
+  u64 InclusiveCycles;
+  u64 ExclusiveCycles;
 };
 
 // The information for the frame
-#define MAX_BLOCKS_PER_FRAME 16384
+#define DEBUG_BLOCK_CHUNK_SIZE 4096
 #define MAX_THREAD_COUNT 16
-#define MAX_DEBUG_FRAME_COUNT 60
 #define MAX_DEBUG_FUNCTION_COUNT 256
 
 struct debug_block
@@ -50,12 +82,24 @@ struct debug_block
   u32 ThreadIndex;
   u64 BeginClock;
   u64 EndClock;
+  u64 ChildCycles;               // Inclusive cycles of the closed child blocks
+  u32 CallPath;
+  b32 HasCounters;
+  debug_counter_sample Counters; // Holds the opening sample until the block closes, then the difference
   debug_event OpeningEvent;
   debug_block* Parent;
   debug_block* FirstChild;
   debug_block* Next;
 };
 
+// Blocks never move once handed out since they point to each other
+struct debug_block_chunk
+{
+  u32 Count;
+  debug_block_chunk* Next;
+  debug_block Blocks[DEBUG_BLOCK_CHUNK_SIZE];
+};
+
 struct debug_thread
 {
   u32 ID;
@@ -74,16 +118,27 @@ struct debug_frame
 
   u32 FrameBarLaneCount;
 
-  midx MaxBlockCount;
-  debug_block* Blocks;
-  debug_block* FirstFreeBlock;
+  b32 Begun;                      // Set by the frame marker that opens the frame
+  u32 BlockCount;
+  u32 DroppedEventCount;          // Events lost to full per thread event arrays, their blocks are missing or never end
+  debug_block_chunk* FirstChunk;
+  debug_block_chunk* LastChunk;
 
   debug_thread Threads[MAX_THREAD_COUNT];
-
-  vector_list<debug_statistics> Statistics;
 };
 
 
+#define MAX_ARENA_REPORT_COUNT 24
+#define ARENA_REPORT_PATH "..\\data\\arena_report.json"
+#define TRACE_EXPORT_PATH "..\\data\\trace.json"
+
+struct arena_report_entry
+{
+  c8 Name[32];
+  arena_stats Stats;
+  u64 TailBytes;
+};
+
 struct debug_state
 {
   b32 Initialized;
@@ -107,7 +162,21 @@ struct debug_state
   
   b32 ThreadSelected;
   u32 SelectedThreadIndex;
-  debug_frame Frames[MAX_DEBUG_FRAME_COUNT];
+  u32 FrameCount;
+  debug_frame* Frames;
+  debug_block_chunk* FirstFreeChunk;
+
+  // Statistics over the frames currently in the history
+  u32 StatsFrameCount;
+  debug_record_stats* FirstFreeRecordStats;
+  u32 CallPathCount;                // Path zero is the root
+  debug_call_path* CallPaths;
+  u64* CallPathKeys;                // Linear probing on parent path and record index, zero keys are empty
+  u32* CallPathSlots;
+
+  // Set while a worker collates the event array the last frame wrote
+  b32 volatile Collating;
+  u32 CollationEventArrayIndex;
 
   // Keeps a global record of all seen functions and their execution time and hit cout.
   vector_list<debug_record_entry> FunctionList;
@@ -117,7 +186,13 @@ struct debug_state
   function_sorting CycleCountSorted;
   function_sorting HitCountSorted;
   function_sorting CyclePerHitSorted;
+  function_sorting ExclusiveSorted;
+  function_sorting P99Sorted;
   r32 ScrollPercentage;
+
+  // Arena counters as they were at the end of the last frame
+  u32 ArenaReportCount;
+  arena_report_entry ArenaReport[MAX_ARENA_REPORT_COUNT];
 };
 
 inline void DebugRewriteConfigFile();
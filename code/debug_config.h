@@ -1,4 +1,5 @@
 #define MULTI_THREADED 1 // b32
 #define SHOW_COLLISION_POINTS 1 // b32
 #define SHOW_COLLIDER 0 // b32
-#define SHOW_AABB_TREE 0 // b32
\ No newline at end of file
+#define SHOW_AABB_TREE 0 // b32
+#define PROFILER_FRAME_COUNT 60 // u32
\ No newline at end of file
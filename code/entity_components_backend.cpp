@@ -37,6 +37,7 @@ struct component_list
   bitmask32 Type;
   u32 Requirements;
   chunk_list Components;
+  chunk_list ChangeJournal[2]; // Filled with entity_change
 };
 
 
@@ -271,6 +272,20 @@ DoesEntityHoldAllComponents(entity* Entity, bitmask32 Flags)
 }
 
 
+internal void RecordChange(entity_manager* EM, entity_id EntityID, bitmask32 ComponentFlags, entity_change_type Type)
+{
+  u32 ComponentIndex = 0;
+  while(IndexOfLeastSignificantSetBit(ComponentFlags, &ComponentIndex))
+  {
+    Assert(ComponentIndex < EM->ComponentTypeCount);
+    component_list* ComponentList = EM->ComponentTypeVector + ComponentIndex;
+    entity_change* Change = (entity_change*) GetNewBlock(&EM->Arena, &ComponentList->ChangeJournal[EM->ChangeJournalIndex]);
+    Change->ID = EntityID;
+    Change->Type = Type;
+    ComponentFlags -= ComponentList->Type;
+  }
+}
+
 component_list CreateComponentList(memory_arena* Arena, bitmask32 TypeFlag, bitmask32 RequirmetFlags, u32 ComponentSize, u32 ComponentCountPerChunk)
 {
   component_list Result = {};
@@ -278,6 +293,8 @@ component_list CreateComponentList(memory_arena* Arena, bitmask32 TypeFlag, bitm
   Result.Requirements = RequirmetFlags;
   u32 TotalSizePerBlock = sizeof(component_head) + ComponentSize;
   Result.Components = NewChunkList(Arena, TotalSizePerBlock, ComponentCountPerChunk);
+  Result.ChangeJournal[0] = NewChunkList(Arena, sizeof(entity_change), ComponentCountPerChunk);
+  Result.ChangeJournal[1] = NewChunkList(Arena, sizeof(entity_change), ComponentCountPerChunk);
   return Result;
 }
 
@@ -310,6 +327,7 @@ void NewComponents(entity_manager* EM, entity_id* EntityID, u32 ComponentFlags)
   bitmask32 NewComponentFlags = (~Entity->ComponentFlags) & TotalRequirements;
 
   CreateAndInsertNewComponents(EM, Entity, NewComponentFlags);
+  RecordChange(EM, Entity->ID, NewComponentFlags, ENTITY_CHANGE_NEW);
 }
 
 // Get a single component from an entity
@@ -552,6 +570,9 @@ void DeleteComponents(entity_manager* EM, entity_id* EntityID, bitmask32 Compone
          (Entity->ComponentFlags != 0 && Entity->FirstComponentLink != 0))
 
   EndTemporaryMemory(TempMem);
+
+  // Recorded after the temporary memory is released since the journal may grow into EM->Arena
+  RecordChange(EM, Entity->ID, TotalRequirements, ENTITY_CHANGE_DELETED);
 }
 
 void DeleteEntities(entity_manager* EM, u32 Count, entity_id* EntityID)
@@ -581,5 +602,30 @@ void DeleteEntity(entity_manager* EM, entity_id* EntityID)
     
   }
 
+  RecordChange(EM, Entity->ID, ComponentFlags, ENTITY_CHANGE_DELETED);
   FreeBlock(&EM->EntityList, (bptr) Entity);
+}
+
+void MarkChanged(entity_manager* EM, entity_id* EntityID, bitmask32 ComponentFlags)
+{
+  entity* Entity = GetEntityFromID(EM, EntityID);
+  Assert((Entity->ComponentFlags & ComponentFlags) == ComponentFlags);
+  RecordChange(EM, Entity->ID, ComponentFlags, ENTITY_CHANGE_MODIFIED);
+}
+
+void SwapChangeJournals(entity_manager* EM)
+{
+  EM->ChangeJournalIndex = !EM->ChangeJournalIndex;
+  for(u32 Index = 0; Index < EM->ComponentTypeCount; ++Index)
+  {
+    Clear(&EM->ComponentTypeVector[Index].ChangeJournal[EM->ChangeJournalIndex]);
+  }
+}
+
+chunk_list_iterator GetChangeJournal(entity_manager* EM, bitmask32 ComponentFlag)
+{
+  Assert(GetSetBitCount(ComponentFlag) == 1);
+  component_list* ComponentList = GetComponentList(EM, ComponentFlag);
+  chunk_list_iterator Result = BeginIterator(&ComponentList->ChangeJournal[!EM->ChangeJournalIndex]);
+  return Result;
 }
\ No newline at end of file
@@ -39,6 +39,9 @@ struct entity_manager
 
   u32 ComponentTypeCount;
   component_list* ComponentTypeVector;
+
+  // Index of the change journal currently being recorded to, the other one holds last frames changes
+  u32 ChangeJournalIndex;
 };
 
 struct entity_manager_definition
@@ -96,4 +99,28 @@ bptr GetComponent(entity_manager* EM, filtered_entity_iterator* ComponentList, b
 
 void DeleteComponent(entity_manager* EM, entity_id* EntityID, bitmask32 ComponentFlag);
 void DeleteEntity(entity_manager* EM, entity_id* EntityID);
-void DeleteEntities(entity_manager* EM, u32 Count, entity_id* EntityID);
\ No newline at end of file
+void DeleteEntities(entity_manager* EM, u32 Count, entity_id* EntityID);
+
+
+// Change tracking
+// Each component type has a journal of changes recorded by NewComponents, DeleteComponents,
+// DeleteEntity and MarkChanged. The journals are double buffered, SwapChangeJournals is called once
+// at the start of each frame and consumers then iterate last frames changes with GetChangeJournal.
+enum entity_change_type
+{
+  ENTITY_CHANGE_NEW      = 1<<0,
+  ENTITY_CHANGE_MODIFIED = 1<<1,
+  ENTITY_CHANGE_DELETED  = 1<<2,
+};
+
+// NOTE: The ID of a ENTITY_CHANGE_DELETED entry is stale, don't try to get components from it
+struct entity_change
+{
+  entity_id ID;
+  entity_change_type Type;
+};
+
+void MarkChanged(entity_manager* EM, entity_id* EntityID, bitmask32 ComponentFlags);
+void SwapChangeJournals(entity_manager* EM);
+// Iterate with: while(entity_change* Change = (entity_change*) Next(&Iterator))
+chunk_list_iterator GetChangeJournal(entity_manager* EM, bitmask32 ComponentFlag);
@@ -464,9 +464,64 @@ void RunUnitTestsA(memory_arena* Arena)
 }
 
 
+u32 CountChanges(entity_manager* EntityManager, bitmask32 ComponentFlag, entity_change_type Type)
+{
+  u32 Result = 0;
+  chunk_list_iterator Iterator = GetChangeJournal(EntityManager, ComponentFlag);
+  while(entity_change* Change = (entity_change*) Next(&Iterator))
+  {
+    if(Change->Type == Type)
+    {
+      Result++;
+    }
+  }
+  return Result;
+}
+
+void RunChangeJournalTests(memory_arena* Arena)
+{
+  ScopedMemory ScopedMem = ScopedMemory(Arena);
+  entity_manager* EntityManager = CreateEntityManager(4, 2, 2, 2, 2, 2);
+
+  // Changes are visible the frame after they were recorded
+  entity_id EntityA = NewEntity(EntityManager, TEST_COMPONENT_FLAG_E);
+  entity_id EntityB = NewEntity(EntityManager, TEST_COMPONENT_FLAG_B);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_A, ENTITY_CHANGE_NEW) == 0);
+
+  SwapChangeJournals(EntityManager);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_A, ENTITY_CHANGE_NEW) == 1);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_B, ENTITY_CHANGE_NEW) == 1);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_C, ENTITY_CHANGE_NEW) == 1);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_D, ENTITY_CHANGE_NEW) == 0);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_E, ENTITY_CHANGE_NEW) == 1);
+
+  // Deleting C cascades to E, A remains
+  MarkChanged(EntityManager, &EntityB, TEST_COMPONENT_FLAG_B);
+  DeleteComponents(EntityManager, &EntityA, TEST_COMPONENT_FLAG_C);
+  SwapChangeJournals(EntityManager);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_A, ENTITY_CHANGE_NEW) == 0);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_A, ENTITY_CHANGE_DELETED) == 0);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_B, ENTITY_CHANGE_MODIFIED) == 1);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_C, ENTITY_CHANGE_DELETED) == 1);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_E, ENTITY_CHANGE_DELETED) == 1);
+
+  DeleteEntity(EntityManager, &EntityA);
+  DeleteEntity(EntityManager, &EntityB);
+  SwapChangeJournals(EntityManager);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_A, ENTITY_CHANGE_DELETED) == 1);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_B, ENTITY_CHANGE_DELETED) == 1);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_B, ENTITY_CHANGE_MODIFIED) == 0);
+
+  // Nothing happened this frame
+  SwapChangeJournals(EntityManager);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_A, ENTITY_CHANGE_DELETED) == 0);
+  Assert(CountChanges(EntityManager, TEST_COMPONENT_FLAG_B, ENTITY_CHANGE_DELETED) == 0);
+}
+
 void RunUnitTests(memory_arena* Arena)
 {
   RunUnitTestsA(Arena);
+  RunChangeJournalTests(Arena);
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,517 @@
+#include "font_cache.h"
+
+// Shelf height of each size bucket, glyph boxes are sorted into the first one they fit in
+global_variable u32 FontCacheShelfHeights[FONT_CACHE_BUCKET_COUNT] = {16, 32, 64, 170};
+
+internal inline u64
+GetGlyphKey(u32 Font, u32 SizePx, u32 Codepoint)
+{
+  u64 Result = ((u64) Font << 32) | ((u64) SizePx << 24) | (u64) Codepoint;
+  return Result;
+}
+
+internal inline u32
+GetGlyphHomeSlot(u64 Key)
+{
+  u32 Result = (u32) ((Key * 0x9E3779B97F4A7C15ull) >> 32) & (FONT_CACHE_SLOT_COUNT - 1);
+  return Result;
+}
+
+internal u32
+FindGlyphSlot(font_cache* FontCache, u64 Key)
+{
+  u32 Slot = GetGlyphHomeSlot(Key);
+  while(FontCache->SlotKeys[Slot])
+  {
+    if(FontCache->SlotKeys[Slot] == Key)
+    {
+      return Slot;
+    }
+    Slot = (Slot + 1) & (FONT_CACHE_SLOT_COUNT - 1);
+  }
+  return FONT_CACHE_NO_GLYPH;
+}
+
+internal void
+InsertGlyphSlot(font_cache* FontCache, u64 Key, u32 Glyph)
+{
+  u32 Slot = GetGlyphHomeSlot(Key);
+  while(FontCache->SlotKeys[Slot])
+  {
+    Slot = (Slot + 1) & (FONT_CACHE_SLOT_COUNT - 1);
+  }
+  FontCache->SlotKeys[Slot] = Key;
+  FontCache->SlotGlyphs[Slot] = Glyph;
+}
+
+// Backward shift deletion, moves later entries of the probe run up so lookups need no tombstones
+internal void
+RemoveGlyphSlot(font_cache* FontCache, u64 Key)
+{
+  const u32 Mask = FONT_CACHE_SLOT_COUNT - 1;
+  u32 Hole = FindGlyphSlot(FontCache, Key);
+  Assert(Hole != FONT_CACHE_NO_GLYPH);
+  u32 Slot = Hole;
+  while(true)
+  {
+    Slot = (Slot + 1) & Mask;
+    u64 SlotKey = FontCache->SlotKeys[Slot];
+    if(!SlotKey)
+    {
+      break;
+    }
+    u32 Home = GetGlyphHomeSlot(SlotKey);
+    // The entry can move if its home slot is not between the hole and where it sits now
+    if(((Slot - Home) & Mask) >= ((Slot - Hole) & Mask))
+    {
+      FontCache->SlotKeys[Hole] = SlotKey;
+      FontCache->SlotGlyphs[Hole] = FontCache->SlotGlyphs[Slot];
+      Hole = Slot;
+    }
+  }
+  FontCache->SlotKeys[Hole] = 0;
+}
+
+internal void
+MarkPageDirty(font_cache_page* Page, u32 MinY, u32 MaxY)
+{
+  if(Page->Dirty)
+  {
+    Page->DirtyMinY = Minimum(Page->DirtyMinY, MinY);
+    Page->DirtyMaxY = Maximum(Page->DirtyMaxY, MaxY);
+  }else{
+    Page->Dirty = true;
+    Page->DirtyMinY = MinY;
+    Page->DirtyMaxY = MaxY;
+  }
+}
+
+internal void
+EvictShelf(font_cache* FontCache, game_asset_manager* AssetManager, u32 PageIndex, u32 ShelfIndex)
+{
+  font_cache_page* Page = FontCache->Pages + PageIndex;
+  font_cache_shelf* Shelf = Page->Shelves + ShelfIndex;
+  u32 GlyphIndex = Shelf->FirstGlyph;
+  while(GlyphIndex != FONT_CACHE_NO_GLYPH)
+  {
+    cached_glyph* Glyph = FontCache->Glyphs + GlyphIndex;
+    u32 Next = Glyph->NextOnShelf;
+    RemoveGlyphSlot(FontCache, Glyph->Key);
+    Glyph->Key = 0;
+    Glyph->NextOnShelf = FontCache->FreeGlyph;
+    FontCache->FreeGlyph = GlyphIndex;
+    GlyphIndex = Next;
+  }
+  Shelf->FirstGlyph = FONT_CACHE_NO_GLYPH;
+  Shelf->CursorX = 0;
+  ++FontCache->Generation;
+
+  // Clear the old texels so nothing bleeds into the padding of new glyphs
+  bitmap* Bitmap = GetAsset(AssetManager, Page->Bitmap);
+  u32 MinY = ShelfIndex * Page->ShelfHeight;
+  u32 MaxY = MinY + Page->ShelfHeight;
+  utils::ZeroSize(FONT_CACHE_PAGE_DIM * Page->ShelfHeight * sizeof(u32),
+                  (u32*) Bitmap->Pixels + MinY * FONT_CACHE_PAGE_DIM);
+  MarkPageDirty(Page, MinY, MaxY);
+}
+
+internal u32
+CreatePage(font_cache* FontCache, game_asset_manager* AssetManager)
+{
+  Assert(FontCache->PageCount < FONT_CACHE_MAX_PAGE_COUNT);
+  u32 PageIndex = FontCache->PageCount++;
+  font_cache_page* Page = FontCache->Pages + PageIndex;
+
+  c8 Name[32] = {};
+  Platform.DEBUGFormatString(Name, ArrayCount(Name), ArrayCount(Name)-1, "font_cache_page_%d", PageIndex);
+  PushBitmapData(AssetManager, Name, FONT_CACHE_PAGE_DIM, FONT_CACHE_PAGE_DIM, 32, 0, false);
+  GetHandle(AssetManager, Name, &Page->Bitmap);
+  AssetManager->BitmapKeeper[Page->Bitmap.Value].Runtime = true;
+  return PageIndex;
+}
+
+// Gives the page to Bucket with all shelves free
+internal void
+ResetPage(font_cache* FontCache, game_asset_manager* AssetManager, u32 PageIndex, u32 Bucket)
+{
+  font_cache_page* Page = FontCache->Pages + PageIndex;
+  for(u32 ShelfIndex = 0; ShelfIndex < Page->ShelfCount; ++ShelfIndex)
+  {
+    EvictShelf(FontCache, AssetManager, PageIndex, ShelfIndex);
+  }
+  for(u32 BucketIndex = 0; BucketIndex < FONT_CACHE_BUCKET_COUNT; ++BucketIndex)
+  {
+    if(FontCache->OpenPage[BucketIndex] == PageIndex)
+    {
+      FontCache->OpenPage[BucketIndex] = FONT_CACHE_NO_GLYPH;
+    }
+  }
+  Page->Bucket = Bucket;
+  Page->ShelfHeight = FontCacheShelfHeights[Bucket];
+  Page->ShelfCount = 0;
+}
+
+internal b32
+IsPageInUse(font_cache* FontCache, font_cache_page* Page)
+{
+  for(u32 ShelfIndex = 0; ShelfIndex < Page->ShelfCount; ++ShelfIndex)
+  {
+    if(Page->Shelves[ShelfIndex].LastUsedFrame == FontCache->CurrentFrame)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Finds a shelf in Bucket with Width texels left. Returns false if everything that could make
+// room is drawn from this frame.
+internal b32
+FindShelf(font_cache* FontCache, game_asset_manager* AssetManager, u32 Bucket, u32 Width, u32* PageResult, u32* ShelfResult)
+{
+  u32 OpenPage = FontCache->OpenPage[Bucket];
+  if(OpenPage != FONT_CACHE_NO_GLYPH)
+  {
+    font_cache_shelf* Shelf = FontCache->Pages[OpenPage].Shelves + FontCache->OpenShelf[Bucket];
+    if(Shelf->CursorX + Width <= FONT_CACHE_PAGE_DIM)
+    {
+      *PageResult = OpenPage;
+      *ShelfResult = FontCache->OpenShelf[Bucket];
+      return true;
+    }
+  }
+
+  u32 ShelfHeight = FontCacheShelfHeights[Bucket];
+  u32 PageIndex = FONT_CACHE_NO_GLYPH;
+  u32 ShelfIndex = FONT_CACHE_NO_GLYPH;
+
+  // Unused shelf in one of the buckets pages
+  for(u32 Index = 0; Index < FontCache->PageCount; ++Index)
+  {
+    font_cache_page* Page = FontCache->Pages + Index;
+    if(Page->Bucket == Bucket && (Page->ShelfCount + 1) * ShelfHeight <= FONT_CACHE_PAGE_DIM)
+    {
+      PageIndex = Index;
+      ShelfIndex = Page->ShelfCount++;
+      break;
+    }
+  }
+
+  // A new page
+  if(PageIndex == FONT_CACHE_NO_GLYPH && FontCache->PageCount < FONT_CACHE_MAX_PAGE_COUNT)
+  {
+    PageIndex = CreatePage(FontCache, AssetManager);
+    ResetPage(FontCache, AssetManager, PageIndex, Bucket);
+    ShelfIndex = FontCache->Pages[PageIndex].ShelfCount++;
+  }
+
+  // The least recently used shelf of the bucket
+  if(PageIndex == FONT_CACHE_NO_GLYPH)
+  {
+    u32 OldestFrame = FontCache->CurrentFrame;
+    for(u32 Index = 0; Index < FontCache->PageCount; ++Index)
+    {
+      font_cache_page* Page = FontCache->Pages + Index;
+      if(Page->Bucket != Bucket)
+      {
+        continue;
+      }
+      for(u32 Shelf = 0; Shelf < Page->ShelfCount; ++Shelf)
+      {
+        if(Page->Shelves[Shelf].LastUsedFrame < OldestFrame)
+        {
+          OldestFrame = Page->Shelves[Shelf].LastUsedFrame;
+          PageIndex = Index;
+          ShelfIndex = Shelf;
+        }
+      }
+    }
+    if(PageIndex != FONT_CACHE_NO_GLYPH)
+    {
+      EvictShelf(FontCache, AssetManager, PageIndex, ShelfIndex);
+    }
+  }
+
+  // The least recently used page of another bucket
+  if(PageIndex == FONT_CACHE_NO_GLYPH)
+  {
+    u32 OldestFrame = FontCache->CurrentFrame;
+    for(u32 Index = 0; Index < FontCache->PageCount; ++Index)
+    {
+      font_cache_page* Page = FontCache->Pages + Index;
+      if(Page->Bucket == Bucket || IsPageInUse(FontCache, Page))
+      {
+        continue;
+      }
+      u32 LastUsedFrame = 0;
+      for(u32 Shelf = 0; Shelf < Page->ShelfCount; ++Shelf)
+      {
+        LastUsedFrame = Maximum(LastUsedFrame, Page->Shelves[Shelf].LastUsedFrame);
+      }
+      if(LastUsedFrame < OldestFrame)
+      {
+        OldestFrame = LastUsedFrame;
+        PageIndex = Index;
+      }
+    }
+    if(PageIndex == FONT_CACHE_NO_GLYPH)
+    {
+      return false;
+    }
+    ResetPage(FontCache, AssetManager, PageIndex, Bucket);
+    ShelfIndex = FontCache->Pages[PageIndex].ShelfCount++;
+  }
+
+  font_cache_shelf* Shelf = FontCache->Pages[PageIndex].Shelves + ShelfIndex;
+  Shelf->CursorX = 0;
+  Shelf->FirstGlyph = FONT_CACHE_NO_GLYPH;
+  Shelf->LastUsedFrame = 0;
+  FontCache->OpenPage[Bucket] = PageIndex;
+  FontCache->OpenShelf[Bucket] = ShelfIndex;
+  *PageResult = PageIndex;
+  *ShelfResult = ShelfIndex;
+  return true;
+}
+
+// Makes room for one more glyph by evicting the least recently used shelf of any bucket
+internal u32
+AllocateGlyph(font_cache* FontCache, game_asset_manager* AssetManager)
+{
+  if(FontCache->FreeGlyph == FONT_CACHE_NO_GLYPH && FontCache->GlyphCount == FONT_CACHE_MAX_GLYPH_COUNT)
+  {
+    u32 OldestFrame = FontCache->CurrentFrame;
+    u32 PageIndex = FONT_CACHE_NO_GLYPH;
+    u32 ShelfIndex = 0;
+    for(u32 Index = 0; Index < FontCache->PageCount; ++Index)
+    {
+      font_cache_page* Page = FontCache->Pages + Index;
+      for(u32 Shelf = 0; Shelf < Page->ShelfCount; ++Shelf)
+      {
+        if(Page->Shelves[Shelf].FirstGlyph != FONT_CACHE_NO_GLYPH &&
+           Page->Shelves[Shelf].LastUsedFrame < OldestFrame)
+        {
+          OldestFrame = Page->Shelves[Shelf].LastUsedFrame;
+          PageIndex = Index;
+          ShelfIndex = Shelf;
+        }
+      }
+    }
+    if(PageIndex == FONT_CACHE_NO_GLYPH)
+    {
+      return FONT_CACHE_NO_GLYPH;
+    }
+    EvictShelf(FontCache, AssetManager, PageIndex, ShelfIndex);
+  }
+
+  u32 Result = FontCache->FreeGlyph;
+  if(Result != FONT_CACHE_NO_GLYPH)
+  {
+    FontCache->FreeGlyph = FontCache->Glyphs[Result].NextOnShelf;
+  }else{
+    Result = FontCache->GlyphCount++;
+  }
+  return Result;
+}
+
+font_cache* CreateFontCache(memory_arena* Arena)
+{
+  font_cache* Result = PushStruct(Arena, font_cache);
+  // Frame zero is what fresh shelves start at, so it must never count as the current frame
+  Result->CurrentFrame = 1;
+  Result->FreeGlyph = FONT_CACHE_NO_GLYPH;
+  for(u32 Bucket = 0; Bucket < FONT_CACHE_BUCKET_COUNT; ++Bucket)
+  {
+    Result->OpenPage[Bucket] = FONT_CACHE_NO_GLYPH;
+  }
+  return Result;
+}
+
+u32 AddFont(font_cache* FontCache, c8* Name, u8* Data, midx DataSize)
+{
+  Assert(FontCache->FontCount < FONT_CACHE_MAX_FONT_COUNT);
+  u32 Result = FontCache->FontCount++;
+  cached_font* Font = FontCache->Fonts + Result;
+  str::CopyStrings(str::StringLength(Name), Name, ArrayCount(Font->Name)-1, Font->Name);
+  Font->Data = Data;
+  Font->DataSize = DataSize;
+  s32 InitResult = stbtt_InitFont(&Font->Info, Data, stbtt_GetFontOffsetForIndex(Data, 0));
+  Assert(InitResult);
+  return Result;
+}
+
+font_metrics GetFontMetrics(font_cache* FontCache, u32 Font, u32 SizePx)
+{
+  Assert(Font < FontCache->FontCount);
+  stbtt_fontinfo* Info = &FontCache->Fonts[Font].Info;
+  s32 Ascent, Descent, LineGap;
+  stbtt_GetFontVMetrics(Info, &Ascent, &Descent, &LineGap);
+  r32 Scale = stbtt_ScaleForPixelHeight(Info, (r32) SizePx);
+
+  font_metrics Result = {};
+  Result.FontHeightPx = (r32) SizePx;
+  Result.Ascent = Ascent * Scale;
+  Result.Descent = Descent * Scale;
+  Result.LineGap = LineGap * Scale;
+  return Result;
+}
+
+cached_glyph* GetGlyph(game_asset_manager* AssetManager, u32 Font, u32 SizePx, u32 Codepoint)
+{
+  font_cache* FontCache = AssetManager->FontCache;
+  Assert(Font < FontCache->FontCount);
+  SizePx = Clamp(SizePx, FONT_CACHE_MIN_SIZE_PX, FONT_CACHE_MAX_SIZE_PX);
+
+  u64 Key = GetGlyphKey(Font, SizePx, Codepoint);
+  u32 Slot = FindGlyphSlot(FontCache, Key);
+  if(Slot != FONT_CACHE_NO_GLYPH)
+  {
+    cached_glyph* Glyph = FontCache->Glyphs + FontCache->SlotGlyphs[Slot];
+    if(Glyph->Page != FONT_CACHE_NO_GLYPH)
+    {
+      FontCache->Pages[Glyph->Page].Shelves[Glyph->Shelf].LastUsedFrame = FontCache->CurrentFrame;
+      FontCache->ShelfMask[Glyph->Page] |= 1u << Glyph->Shelf;
+    }
+    return Glyph;
+  }
+
+  stbtt_fontinfo* Info = &FontCache->Fonts[Font].Info;
+  r32 Scale = stbtt_ScaleForPixelHeight(Info, (r32) SizePx);
+  s32 X0, Y0, X1, Y1;
+  stbtt_GetCodepointBitmapBox(Info, Codepoint, Scale, Scale, &X0, &Y0, &X1, &Y1);
+  s32 Advance, LeftSideBearing;
+  stbtt_GetCodepointHMetrics(Info, Codepoint, &Advance, &LeftSideBearing);
+  u32 Width = (u32) (X1 - X0);
+  u32 Height = (u32) (Y1 - Y0);
+
+  u32 GlyphIndex = AllocateGlyph(FontCache, AssetManager);
+  if(GlyphIndex == FONT_CACHE_NO_GLYPH)
+  {
+    ++FontCache->Generation;
+    return 0;
+  }
+
+  cached_glyph* Glyph = FontCache->Glyphs + GlyphIndex;
+  Glyph->Key = Key;
+  Glyph->Char = {};
+  Glyph->Char.xoff = (r32) X0;
+  Glyph->Char.yoff = (r32) Y0;
+  Glyph->Char.xadvance = Scale * Advance;
+  Glyph->Page = FONT_CACHE_NO_GLYPH;
+  Glyph->Shelf = 0;
+  Glyph->NextOnShelf = FONT_CACHE_NO_GLYPH;
+
+  // Blank glyphs like space only need their advance and never take atlas space
+  if(Width && Height)
+  {
+    u32 Bucket = 0;
+    while(Bucket < FONT_CACHE_BUCKET_COUNT && Height + FONT_CACHE_GLYPH_PADDING > FontCacheShelfHeights[Bucket])
+    {
+      ++Bucket;
+    }
+    u32 PageIndex = 0;
+    u32 ShelfIndex = 0;
+    if(Bucket == FONT_CACHE_BUCKET_COUNT ||
+       !FindShelf(FontCache, AssetManager, Bucket, Width + FONT_CACHE_GLYPH_PADDING, &PageIndex, &ShelfIndex))
+    {
+      Glyph->Key = 0;
+      Glyph->NextOnShelf = FontCache->FreeGlyph;
+      FontCache->FreeGlyph = GlyphIndex;
+      ++FontCache->Generation;
+      return 0;
+    }
+
+    font_cache_page* Page = FontCache->Pages + PageIndex;
+    font_cache_shelf* Shelf = Page->Shelves + ShelfIndex;
+    u32 X = Shelf->CursorX;
+    u32 Y = ShelfIndex * Page->ShelfHeight;
+    Shelf->CursorX += Width + FONT_CACHE_GLYPH_PADDING;
+    Shelf->LastUsedFrame = FontCache->CurrentFrame;
+    FontCache->ShelfMask[PageIndex] |= 1u << ShelfIndex;
+    Glyph->Page = PageIndex;
+    Glyph->Shelf = ShelfIndex;
+    Glyph->NextOnShelf = Shelf->FirstGlyph;
+    Shelf->FirstGlyph = GlyphIndex;
+
+    Glyph->Char.x0 = (u16) X;
+    Glyph->Char.y0 = (u16) Y;
+    Glyph->Char.x1 = (u16) (X + Width);
+    Glyph->Char.y1 = (u16) (Y + Height);
+
+    ScopedScratch Scratch;
+    u8* Coverage = PushArray(Scratch.Arena, Width * Height, u8, NoClear());
+    stbtt_MakeCodepointBitmap(Info, Coverage, Width, Height, Width, Scale, Scale, Codepoint);
+
+    // Same texel layout as the baked font maps had, coverage in all four channels
+    bitmap* Bitmap = GetAsset(AssetManager, Page->Bitmap);
+    for(u32 Row = 0; Row < Height; ++Row)
+    {
+      u8* Src = Coverage + Row * Width;
+      u32* Dst = (u32*) Bitmap->Pixels + (Y + Row) * FONT_CACHE_PAGE_DIM + X;
+      for(u32 Column = 0; Column < Width; ++Column)
+      {
+        u32 Value = Src[Column];
+        Dst[Column] = Value | (Value << 8) | (Value << 16) | (Value << 24);
+      }
+    }
+    MarkPageDirty(Page, Y, Y + Height);
+  }
+
+  InsertGlyphSlot(FontCache, Key, GlyphIndex);
+  return Glyph;
+}
+
+void ClearShelfMask(font_cache* FontCache)
+{
+  utils::ZeroSize(sizeof(FontCache->ShelfMask), FontCache->ShelfMask);
+}
+
+void CopyShelfMask(font_cache* FontCache, u32* Mask)
+{
+  utils::Copy(sizeof(FontCache->ShelfMask), FontCache->ShelfMask, Mask);
+}
+
+void TouchShelves(font_cache* FontCache, u32* Mask)
+{
+  for(u32 PageIndex = 0; PageIndex < FontCache->PageCount; ++PageIndex)
+  {
+    u32 Bits = Mask[PageIndex];
+    bit_scan_result BitScan = FindLeastSignificantSetBit(Bits);
+    while(BitScan.Found)
+    {
+      FontCache->Pages[PageIndex].Shelves[BitScan.Index].LastUsedFrame = FontCache->CurrentFrame;
+      Bits &= ~(1u << BitScan.Index);
+      BitScan = FindLeastSignificantSetBit(Bits);
+    }
+  }
+}
+
+void FlushFontCache(game_asset_manager* AssetManager)
+{
+  font_cache* FontCache = AssetManager->FontCache;
+  for(u32 PageIndex = 0; PageIndex < FontCache->PageCount; ++PageIndex)
+  {
+    font_cache_page* Page = FontCache->Pages + PageIndex;
+    if(!Page->Dirty)
+    {
+      continue;
+    }
+    Page->Dirty = false;
+
+    rect2f Region = Rect2f(0, (r32) Page->DirtyMinY, FONT_CACHE_PAGE_DIM, (r32) (Page->DirtyMaxY - Page->DirtyMinY));
+    bitmap_keeper* BitmapKeeper = AssetManager->BitmapKeeper + Page->Bitmap.Value;
+    if(IsUploadPending(AssetManager, asset_type::BITMAP, Page->Bitmap.Value))
+    {
+      // The queued upload reads the keeper when it runs, so widening its region is enough.
+      // Without a region it uploads the whole page anyway.
+      if(BitmapKeeper->UseSubRegion)
+      {
+        r32 MinY = Minimum(BitmapKeeper->SubRegion.Y, Region.Y);
+        r32 MaxY = Maximum(BitmapKeeper->SubRegion.Y + BitmapKeeper->SubRegion.H, Region.Y + Region.H);
+        BitmapKeeper->SubRegion = Rect2f(0, MinY, FONT_CACHE_PAGE_DIM, MaxY - MinY);
+      }
+    }else{
+      Reupload(AssetManager, Page->Bitmap, Region);
+    }
+  }
+  ++FontCache->CurrentFrame;
+}
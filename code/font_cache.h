@@ -0,0 +1,121 @@
+#pragma once
+
+#include "types.h"
+#include "assets.h"
+
+// Glyph cache.
+// Glyphs are rasterized with stb_truetype the first time a (font, size, codepoint) is drawn and
+// packed left to right on shelves in atlas pages. A page only holds shelves of one height (its
+// size bucket) so small glyphs don't waste the rows of large ones. When a bucket is out of room
+// the shelf that was least recently drawn from is evicted together with its glyphs.
+// Pages are ordinary bitmaps so text goes through Push2DQuad like any other texture. Rasterized
+// glyphs are uploaded once per frame in FlushFontCache.
+
+#define FONT_CACHE_PAGE_DIM 512           // Must match the texture array size in the GL layer
+#define FONT_CACHE_MAX_PAGE_COUNT 8
+#define FONT_CACHE_MAX_FONT_COUNT 4
+#define FONT_CACHE_MAX_GLYPH_COUNT 4096
+#define FONT_CACHE_SLOT_COUNT (2 * FONT_CACHE_MAX_GLYPH_COUNT)
+#define FONT_CACHE_MIN_SIZE_PX 4
+#define FONT_CACHE_MAX_SIZE_PX 128
+#define FONT_CACHE_GLYPH_PADDING 1
+#define FONT_CACHE_MIN_SHELF_HEIGHT 16
+#define FONT_CACHE_MAX_SHELF_COUNT (FONT_CACHE_PAGE_DIM / FONT_CACHE_MIN_SHELF_HEIGHT)
+#define FONT_CACHE_BUCKET_COUNT 4
+#define FONT_CACHE_NO_GLYPH 0xFFFFFFFF
+
+static_assert(FONT_CACHE_MAX_SHELF_COUNT <= 32, "Shelf masks are one u32 per page");
+
+#define DEFAULT_FONT 0
+
+struct cached_glyph
+{
+  u64 Key;
+  stbtt_bakedchar Char;   // Position in the page and metrics in the same form stbtt_BakeFontBitmap gives
+  u32 Page;
+  u32 Shelf;
+  u32 NextOnShelf;        // Also links the free list
+};
+
+struct font_cache_shelf
+{
+  u32 CursorX;
+  u32 FirstGlyph;
+  u32 LastUsedFrame;
+};
+
+struct font_cache_page
+{
+  bitmap_handle Bitmap;
+  u32 Bucket;
+  u32 ShelfHeight;
+  u32 ShelfCount;       // Shelves in use, they are handed out top to bottom
+  font_cache_shelf Shelves[FONT_CACHE_MAX_SHELF_COUNT];
+
+  // Texels written since the last flush
+  b32 Dirty;
+  u32 DirtyMinY;
+  u32 DirtyMaxY;
+};
+
+struct cached_font
+{
+  c8 Name[64];
+  u8* Data;
+  midx DataSize;
+  stbtt_fontinfo Info;
+};
+
+struct font_metrics
+{
+  r32 FontHeightPx;
+  r32 Ascent;
+  r32 Descent;
+  r32 LineGap;
+};
+
+struct font_cache
+{
+  u32 CurrentFrame;
+  u32 Generation;     // Bumped when glyphs are evicted or could not be added, recorded glyph quads may be stale then
+
+  u32 FontCount;
+  cached_font Fonts[FONT_CACHE_MAX_FONT_COUNT];
+
+  u32 PageCount;
+  font_cache_page Pages[FONT_CACHE_MAX_PAGE_COUNT];
+
+  // Shelf each bucket is currently filling, FONT_CACHE_NO_GLYPH if none
+  u32 OpenPage[FONT_CACHE_BUCKET_COUNT];
+  u32 OpenShelf[FONT_CACHE_BUCKET_COUNT];
+
+  // One bit per shelf drawn from since the last ClearShelfMask, lets recorded text keep its shelves alive
+  u32 ShelfMask[FONT_CACHE_MAX_PAGE_COUNT];
+
+  u32 GlyphCount;
+  u32 FreeGlyph;
+  cached_glyph Glyphs[FONT_CACHE_MAX_GLYPH_COUNT];
+
+  // Linear probing on the glyph key, zero keys are empty
+  u64 SlotKeys[FONT_CACHE_SLOT_COUNT];
+  u32 SlotGlyphs[FONT_CACHE_SLOT_COUNT];
+};
+
+font_cache* CreateFontCache(memory_arena* Arena);
+
+// Data has to stay valid as long as the cache. Returns the font index.
+u32 AddFont(font_cache* FontCache, c8* Name, u8* Data, midx DataSize);
+
+font_metrics GetFontMetrics(font_cache* FontCache, u32 Font, u32 SizePx);
+
+// Rasterizes the glyph if it is not cached. Returns 0 if there was no room left this frame.
+cached_glyph* GetGlyph(game_asset_manager* AssetManager, u32 Font, u32 SizePx, u32 Codepoint);
+
+// Recording the glyphs drawn between ClearShelfMask and CopyShelfMask lets TouchShelves mark their
+// shelves as drawn this frame without looking the glyphs up again.
+void ClearShelfMask(font_cache* FontCache);
+void CopyShelfMask(font_cache* FontCache, u32* Mask);
+void TouchShelves(font_cache* FontCache, u32* Mask);
+
+// Queues uploads of glyphs rasterized this frame, called once at the end of the frame
+void FlushFontCache(game_asset_manager* AssetManager);
@@ -11,18 +11,24 @@ MENU_UPDATE_CHILD_REGIONS(RootUpdateChildRegions);
 MENU_UPDATE_CHILD_REGIONS(UpdateSplitChildRegions);
 MENU_UPDATE_CHILD_REGIONS(UpdateGridChildRegions);
 MENU_UPDATE_CHILD_REGIONS(UpdateTabWindowChildRegions);
+MENU_UPDATE_CHILD_REGIONS(UpdateListChildRegions);
 
 MENU_DRAW(DrawFunctionTimeline);
 MENU_DRAW(DrawStatistics);
 MENU_DRAW(DrawFrameFunctions);
+MENU_DRAW(DrawArenaStatistics);
 
 MENU_EVENT_CALLBACK(DebugToggleButton);
 MENU_EVENT_CALLBACK(DebugRecompileButton);
+MENU_EVENT_CALLBACK(DebugDumpArenasButton);
+MENU_EVENT_CALLBACK(DebugDumpTraceButton);
+MENU_EVENT_CALLBACK(DebugBakeAssetsButton);
 
 MENU_EVENT_CALLBACK(InitiateTabDrag);
 MENU_EVENT_CALLBACK(InitiateWindowDrag);
 MENU_EVENT_CALLBACK(InitiateSplitWindowBorderDrag);
 MENU_EVENT_CALLBACK(InitiateBorderDrag);
+MENU_EVENT_CALLBACK(ListScroll);
 
 MENU_UPDATE_FUNCTION(TabDragUpdate);
 MENU_UPDATE_FUNCTION(WindowDragUpdate);
@@ -55,15 +61,21 @@ void _ReinitiatePool(function_pool* Pool)
     NewFunPtr(UpdateSplitChildRegions)
     NewFunPtr(UpdateGridChildRegions)
     NewFunPtr(UpdateTabWindowChildRegions)
+    NewFunPtr(UpdateListChildRegions)
     NewFunPtr(DrawFunctionTimeline)
     NewFunPtr(DrawStatistics)
     NewFunPtr(DrawFrameFunctions)
+    NewFunPtr(DrawArenaStatistics)
     NewFunPtr(DebugToggleButton)
     NewFunPtr(DebugRecompileButton)
+    NewFunPtr(DebugDumpArenasButton)
+    NewFunPtr(DebugDumpTraceButton)
+    NewFunPtr(DebugBakeAssetsButton)
     NewFunPtr(InitiateTabDrag)
     NewFunPtr(InitiateWindowDrag)
     NewFunPtr(InitiateSplitWindowBorderDrag)
     NewFunPtr(InitiateBorderDrag)
+    NewFunPtr(ListScroll)
     NewFunPtr(TabDragUpdate)
     NewFunPtr(WindowDragUpdate)
     NewFunPtr(RootBorderDragUpdate)
@@ -182,6 +182,29 @@ FindLeastSignificantSetBit( u32 Value )
   return Result;
 }
 
+inline bit_scan_result
+FindMostSignificantSetBit64( u64 Value )
+{
+  bit_scan_result Result = {};
+
+#if COMPILER_MSVC
+  Result.Found = _BitScanReverse64( (unsigned long*) &Result.Index, Value);
+#else
+  for(s32 Test = 63; Test >= 0; Test--)
+  {
+    u64 mask = ((u64)1 << Test);
+    if( (Value & mask ) != 0)
+    {
+      Result.Index = Test;
+      Result.Found = true;
+      break;
+    }
+  }
+
+#endif
+  return Result;
+}
+
 inline u32 GetSetBitCount(u32 Value)
 {
   bit_scan_result BitScan = FindLeastSignificantSetBit(Value);
@@ -3,6 +3,53 @@
 #include "platform.h"
 #include "utility_macros.h"
 
+#if HANDMADE_INTERNAL
+
+// Pushes are attributed to the file and line of the Push macro
+#define ARENA_CALL_SITE __FILE__, __LINE__,
+#define ARENA_CALL_SITE_PARAMS const c8* CallSiteFile, u32 CallSiteLine,
+#define ARENA_CALL_SITE_ARGS CallSiteFile, CallSiteLine,
+#define ARENA_MAX_CALL_SITE_COUNT 16
+
+struct arena_call_site
+{
+  const c8* File;
+  u32 Line;
+  u32 PushCount;
+  u64 Bytes;
+};
+
+struct arena_stats
+{
+  u64 PushCount;
+  u64 BytesPushed;          // Requested bytes over the life of the arena
+  u64 FrameBytesPushed;     // Requested bytes since the last EndArenaStatsFrame
+  u64 PeakFrameBytesPushed;
+  u64 AlignmentBytes;       // Padding inserted in front of aligned pushes
+  u64 BlocksAllocated;
+
+  u32 BlockCount;
+  u64 BlockBytes;           // Size of the blocks the arena holds right now
+  u64 UsedBytes;            // Bytes pushed into those blocks, padding included
+  u64 PeakBlockBytes;
+  u64 PeakUsedBytes;
+  s32 PeakTempCount;
+
+  // Busiest call sites. When the table is full a new site replaces the one with the fewest bytes,
+  // whose bytes move to Other
+  u32 CallSiteCount;
+  arena_call_site CallSites[ARENA_MAX_CALL_SITE_COUNT];
+  u64 OtherBytes;
+};
+
+#else
+
+#define ARENA_CALL_SITE
+#define ARENA_CALL_SITE_PARAMS
+#define ARENA_CALL_SITE_ARGS
+
+#endif
+
 struct memory_arena
 {
   platform_memory_block *CurrentBlock;
@@ -10,6 +57,10 @@ struct memory_arena
 
   u64 AllocationFlags;
   s32 TempCount;
+
+#if HANDMADE_INTERNAL
+  arena_stats Stats;
+#endif
 };
 
 struct temporary_memory
@@ -114,11 +165,21 @@ NonRestoredArena( void )
   return(Params);
 }
 
+// For big arenas that are touched every frame. Blocks are rounded to whole large pages.
+inline arena_bootstrap_params
+LargePageArena( uintptr_t MinimumBlockSize = PLATFORM_LARGE_PAGE_SIZE )
+{
+  arena_bootstrap_params Params = DefaultBootstrapParams();
+  Params.AllocationFlags = PlatformMemory_LargePages;
+  Params.MinimumBlockSize = MinimumBlockSize;
+  return(Params);
+}
+
 // TODO(casey): Optional "clear" parameter!!!!
-#define PushStruct(Arena, type, ...)                   (type *)PushSize_( Arena,         sizeof(type), ## __VA_ARGS__ )
-#define PushArray(Arena, Count, type, ...)             (type *)PushSize_( Arena, (Count)*sizeof(type), ## __VA_ARGS__ )
-#define PushSize(Arena, Size, ...)                             PushSize_( Arena, Size,                 ## __VA_ARGS__ )
-#define PushCopy(Arena, Size, Source, ...)  utils::Copy(Size, Source, PushSize_( Arena, Size,          ## __VA_ARGS__ ))
+#define PushStruct(Arena, type, ...)                   (type *)PushSize_( ARENA_CALL_SITE Arena,         sizeof(type), ## __VA_ARGS__ )
+#define PushArray(Arena, Count, type, ...)             (type *)PushSize_( ARENA_CALL_SITE Arena, (Count)*sizeof(type), ## __VA_ARGS__ )
+#define PushSize(Arena, Size, ...)                             PushSize_( ARENA_CALL_SITE Arena, Size,                 ## __VA_ARGS__ )
+#define PushCopy(Arena, Size, Source, ...)  utils::Copy(Size, Source, PushSize_( ARENA_CALL_SITE Arena, Size,          ## __VA_ARGS__ ))
 
 inline midx
 GetEffectiveSizeFor( memory_arena *Arena, midx SizeInit, arena_push_params Params = DefaultArenaParams() )
@@ -131,8 +192,73 @@ GetEffectiveSizeFor( memory_arena *Arena, midx SizeInit, arena_push_params Param
   return( Size );
 }
 
+#if HANDMADE_INTERNAL
+inline void
+RecordArenaCallSite( arena_stats* Stats, const c8* File, u32 Line, midx Size )
+{
+  arena_call_site* Site = 0;
+  arena_call_site* Smallest = 0;
+  for( u32 Index = 0; Index < Stats->CallSiteCount && !Site; ++Index )
+  {
+    arena_call_site* Candidate = Stats->CallSites + Index;
+    if( Candidate->Line == Line && Candidate->File == File )
+    {
+      Site = Candidate;
+    }
+    else if( !Smallest || Candidate->Bytes < Smallest->Bytes )
+    {
+      Smallest = Candidate;
+    }
+  }
+
+  if( !Site )
+  {
+    if( Stats->CallSiteCount < ARENA_MAX_CALL_SITE_COUNT )
+    {
+      Site = Stats->CallSites + Stats->CallSiteCount++;
+    }
+    else
+    {
+      // Sites only count what they pushed since they entered the table
+      Site = Smallest;
+      Stats->OtherBytes += Site->Bytes;
+    }
+    Site->File = File;
+    Site->Line = Line;
+    Site->PushCount = 0;
+    Site->Bytes = 0;
+  }
+
+  ++Site->PushCount;
+  Site->Bytes += Size;
+}
+
+// Called once a frame by whoever reports on the arena
+inline void
+EndArenaStatsFrame( memory_arena* Arena )
+{
+  arena_stats* Stats = &Arena->Stats;
+  Stats->PeakFrameBytesPushed = Maximum( Stats->PeakFrameBytesPushed, Stats->FrameBytesPushed );
+  Stats->FrameBytesPushed = 0;
+}
+
+// Free space left behind in blocks that are no longer the current one
+inline u64
+GetArenaTailBytes( memory_arena* Arena )
+{
+  u64 Result = 0;
+  platform_memory_block* Block = Arena->CurrentBlock ? Arena->CurrentBlock->ArenaPrev : 0;
+  while( Block )
+  {
+    Result += Block->Size - Block->Used;
+    Block = Block->ArenaPrev;
+  }
+  return Result;
+}
+#endif
+
 inline void *
-PushSize_( memory_arena *Arena, midx SizeInit, arena_push_params Params = DefaultArenaParams() )
+PushSize_( ARENA_CALL_SITE_PARAMS memory_arena *Arena, midx SizeInit, arena_push_params Params = DefaultArenaParams() )
 {
   void *Result = 0;
 
@@ -159,11 +285,23 @@ PushSize_( memory_arena *Arena, midx SizeInit, arena_push_params Params = Defaul
     }
 
     midx BlockSize = Maximum( Size, Arena->MinimumBlockSize );
+    if( ( Arena->AllocationFlags & PlatformMemory_LargePages ) &&
+       !( Arena->AllocationFlags & ( PlatformMemory_OverflowCheck | PlatformMemory_UnderflowCheck ) ) )
+    {
+      BlockSize = AlignPow2( (BlockSize + PLATFORM_MEMORY_BLOCK_HEADER_SIZE), PLATFORM_LARGE_PAGE_SIZE ) - PLATFORM_MEMORY_BLOCK_HEADER_SIZE;
+    }
 
     platform_memory_block *NewBlock =
         Platform.AllocateMemory( BlockSize, Arena->AllocationFlags );
     NewBlock->ArenaPrev = Arena->CurrentBlock;
     Arena->CurrentBlock = NewBlock;
+
+#if HANDMADE_INTERNAL
+    ++Arena->Stats.BlocksAllocated;
+    ++Arena->Stats.BlockCount;
+    Arena->Stats.BlockBytes += NewBlock->Size;
+    Arena->Stats.PeakBlockBytes = Maximum( Arena->Stats.PeakBlockBytes, Arena->Stats.BlockBytes );
+#endif
   }
 
   Assert( ( Arena->CurrentBlock->Used + Size ) <= Arena->CurrentBlock->Size );
@@ -174,6 +312,17 @@ PushSize_( memory_arena *Arena, midx SizeInit, arena_push_params Params = Defaul
 
   Assert( Size >= SizeInit );
 
+#if HANDMADE_INTERNAL
+  arena_stats* Stats = &Arena->Stats;
+  ++Stats->PushCount;
+  Stats->BytesPushed += SizeInit;
+  Stats->FrameBytesPushed += SizeInit;
+  Stats->AlignmentBytes += Size - SizeInit;
+  Stats->UsedBytes += Size;
+  Stats->PeakUsedBytes = Maximum( Stats->PeakUsedBytes, Stats->UsedBytes );
+  RecordArenaCallSite( Stats, CallSiteFile, CallSiteLine, SizeInit );
+#endif
+
   if( Params.Flags & ArenaFlag_ClearToZero )
   {
     utils::ZeroSize( SizeInit, Result );
@@ -193,6 +342,10 @@ BeginTemporaryMemory( memory_arena *Arena )
 
   ++Arena->TempCount;
 
+#if HANDMADE_INTERNAL
+  Arena->Stats.PeakTempCount = Maximum( Arena->Stats.PeakTempCount, Arena->TempCount );
+#endif
+
   return( Result );
 }
 
@@ -201,6 +354,11 @@ FreeLastBlock( memory_arena *Arena )
 {
   platform_memory_block *Free = Arena->CurrentBlock;
   Arena->CurrentBlock = Free->ArenaPrev;
+#if HANDMADE_INTERNAL
+  --Arena->Stats.BlockCount;
+  Arena->Stats.BlockBytes -= Free->Size;
+  Arena->Stats.UsedBytes -= Free->Used;
+#endif
   Platform.DeallocateMemory( Free );
 }
 
@@ -216,6 +374,9 @@ EndTemporaryMemory( temporary_memory TempMem )
   if( Arena->CurrentBlock )
   {
       Assert( Arena->CurrentBlock->Used >= TempMem.Used );
+#if HANDMADE_INTERNAL
+      Arena->Stats.UsedBytes -= Arena->CurrentBlock->Used - TempMem.Used;
+#endif
       Arena->CurrentBlock->Used = TempMem.Used;
       Assert( Arena->TempCount > 0 );
   }
@@ -272,17 +433,122 @@ struct ScopedMemory
   }
 };
 
-#define BootstrapPushStruct( type, Member, ... ) (type*) BootstrapPushSize_( sizeof( type ), OffsetOf(type, Member), ## __VA_ARGS__ )
+// Pushes a larger copy of Array, the new elements are zero. The old array is left in the arena.
+#define GrowArray(Arena, Array, OldCount, NewCount, type) (type*) GrowArray_( ARENA_CALL_SITE Arena, Array, sizeof(type), OldCount, NewCount )
+inline void*
+GrowArray_( ARENA_CALL_SITE_PARAMS memory_arena* Arena, void* Array, midx ElementSize, u32 OldCount, u32 NewCount )
+{
+  Assert( NewCount >= OldCount );
+  void* Result = PushSize_( ARENA_CALL_SITE_ARGS Arena, NewCount * ElementSize );
+  if( Array )
+  {
+    utils::Copy( OldCount * ElementSize, Array, Result );
+  }
+  return Result;
+}
+
+#define BootstrapPushStruct( type, Member, ... ) (type*) BootstrapPushSize_( ARENA_CALL_SITE sizeof( type ), OffsetOf(type, Member), ## __VA_ARGS__ )
 inline void *
-BootstrapPushSize_( uintptr_t StructSize, uintptr_t OffsetToArena,
+BootstrapPushSize_( ARENA_CALL_SITE_PARAMS uintptr_t StructSize, uintptr_t OffsetToArena,
                     arena_bootstrap_params BootstrapParams = DefaultBootstrapParams(),
                     arena_push_params Params = DefaultArenaParams() )
 {
   memory_arena Bootstrap = {};
   Bootstrap.AllocationFlags = BootstrapParams.AllocationFlags;
   Bootstrap.MinimumBlockSize = BootstrapParams.MinimumBlockSize;
-  void* Struct = PushSize( &Bootstrap, StructSize, Params );
+  void* Struct = PushSize_( ARENA_CALL_SITE_ARGS &Bootstrap, StructSize, Params );
   *(memory_arena*) ( (u8*) Struct + OffsetToArena ) = Bootstrap;
 
   return(Struct);
-}
\ No newline at end of file
+}
+
+// Scratch arenas.
+// Every thread owns SCRATCH_ARENA_COUNT arenas for short lived work, so jobs don't share the
+// TransientArena and nested temporary scopes can't unwind each other. GetScratch skips the arenas
+// passed as conflicts, usually the arena the caller pushes its results on. Scopes on one scratch
+// arena must end in the reverse order they began, like any temporary_memory.
+#define SCRATCH_THREAD_COUNT 5    // Main thread and the workers, same order as game_memory::ThreadID
+#define SCRATCH_ARENA_COUNT 2
+
+struct scratch_pool
+{
+  u32 ThreadIDs[SCRATCH_THREAD_COUNT];
+  memory_arena Arenas[SCRATCH_THREAD_COUNT][SCRATCH_ARENA_COUNT];
+};
+
+// Set by the game every frame since statics are reset when the game code is reloaded
+global_variable scratch_pool* GlobalScratchPool = 0;
+
+inline void
+InitializeScratchPool( scratch_pool* Pool, u32* ThreadIDs )
+{
+  *Pool = {};
+  for( u32 ThreadIndex = 0; ThreadIndex < SCRATCH_THREAD_COUNT; ++ThreadIndex )
+  {
+    Pool->ThreadIDs[ThreadIndex] = ThreadIDs[ThreadIndex];
+    for( u32 ArenaIndex = 0; ArenaIndex < SCRATCH_ARENA_COUNT; ++ArenaIndex )
+    {
+      memory_arena* Arena = &Pool->Arenas[ThreadIndex][ArenaIndex];
+      SetMinimumBlockSize( Arena, Megabytes(1) );
+      // Each thread allocates its own scratch blocks, keep them on its node
+      Arena->AllocationFlags = PlatformMemory_NodeLocal;
+    }
+  }
+}
+
+inline temporary_memory
+GetScratch( memory_arena** Conflicts = 0, u32 ConflictCount = 0 )
+{
+  Assert( GlobalScratchPool );
+  u32 ThreadID = GetThreadID();
+  u32 ThreadIndex = 0;
+  while( ThreadIndex < SCRATCH_THREAD_COUNT && GlobalScratchPool->ThreadIDs[ThreadIndex] != ThreadID )
+  {
+    ++ThreadIndex;
+  }
+  Assert( ThreadIndex < SCRATCH_THREAD_COUNT );
+
+  memory_arena* Result = 0;
+  for( u32 ArenaIndex = 0; ArenaIndex < SCRATCH_ARENA_COUNT && !Result; ++ArenaIndex )
+  {
+    memory_arena* Candidate = &GlobalScratchPool->Arenas[ThreadIndex][ArenaIndex];
+    b32 IsConflict = false;
+    for( u32 ConflictIndex = 0; ConflictIndex < ConflictCount; ++ConflictIndex )
+    {
+      IsConflict |= ( Conflicts[ConflictIndex] == Candidate );
+    }
+    if( !IsConflict )
+    {
+      Result = Candidate;
+    }
+  }
+  Assert( Result );
+
+  // NOTE: Keep the first block alive so ending the scope doesn't hand it back to the OS every time
+  if( !Result->CurrentBlock )
+  {
+    PushSize( Result, 0, NoClear() );
+  }
+  return BeginTemporaryMemory( Result );
+}
+
+inline void
+ReleaseScratch( temporary_memory Scratch )
+{
+  EndTemporaryMemory( Scratch );
+}
+
+struct ScopedScratch
+{
+  temporary_memory TempMem;
+  memory_arena* Arena;
+  ScopedScratch(memory_arena* Conflict = 0)
+  {
+    TempMem = GetScratch(&Conflict, Conflict ? 1 : 0);
+    Arena = TempMem.Arena;
+  }
+  ~ScopedScratch()
+  {
+    ReleaseScratch(TempMem);
+  }
+};
@@ -352,6 +352,40 @@ menu_functions GetGridFunctions()
   return Result;
 }
 
+// Rows are laid out from the top, the slots are placed where their bound item is
+MENU_UPDATE_CHILD_REGIONS( UpdateListChildRegions )
+{
+  list_node* List = GetListNode(Parent);
+  rect2f ParentRegion = Parent->Region;
+  r32 ItemWidth = ParentRegion.W / List->Columns;
+  r32 Top = ParentRegion.Y + ParentRegion.H;
+
+  container_node* Child = Parent->FirstChild;
+  u32 SlotIndex = 0;
+  while(Child)
+  {
+    Assert(SlotIndex < List->SlotCount);
+    u32 Item = List->BoundItems[SlotIndex++];
+    if(Item == LIST_NO_ITEM)
+    {
+      Child->Region = Rect2f(ParentRegion.X, ParentRegion.Y, 0, 0);
+    }else{
+      // Until the list is rebound after a scroll items may sit above the first row
+      s32 Row = (s32) (Item / List->Columns) - (s32) List->FirstRow;
+      u32 Column = Item % List->Columns;
+      Child->Region = Rect2f(ParentRegion.X + Column * ItemWidth, Top - (Row + 1) * List->ItemHeight, ItemWidth, List->ItemHeight);
+    }
+    Child = Next(Child);
+  }
+}
+
+menu_functions GetListFunctions()
+{
+  menu_functions Result = GetDefaultFunctions();
+  Result.UpdateChildRegions = DeclareFunction(menu_get_region, UpdateListChildRegions);
+  return Result;
+}
+
 menu_functions GetMenuFunction(container_type Type)
 {
   switch(Type)
@@ -364,6 +398,7 @@ menu_functions GetMenuFunction(container_type Type)
     case container_type::TabWindow: return GetTabWindowFunctions();
     case container_type::Tab:       return GetDefaultFunctions();
     case container_type::Plugin:    return GetDefaultFunctions();
+    case container_type::List:      return GetListFunctions();
 
     default: Assert(0);
   }
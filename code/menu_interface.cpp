@@ -1,4 +1,5 @@
 #include "menu_interface.h"
+#include "font_cache.h"
 #include "string.h"
 
 
@@ -16,6 +17,7 @@ GetContainerPayloadSize(container_type Type)
     case container_type::TabWindow: return sizeof(tab_window_node);
     case container_type::Tab:       return sizeof(tab_node);
     case container_type::Plugin:    return sizeof(plugin_node);
+    case container_type::List:      return sizeof(list_node);
     default: INVALID_CODE_PATH;
   }
   return 0;
@@ -30,13 +32,33 @@ GetAttributeSize(container_attribute Attribute)
     case ATTRIBUTE_COLOR:       return sizeof(color_attribute);
     case ATTRIBUTE_TEXT:        return sizeof(text_attribute);
     case ATTRIBUTE_SIZE:        return sizeof(size_attribute);
-    case ATTRIBUTE_MENU_EVENT_HANDLE: return sizeof(menu_event_handle_attribtue);
     case ATTRIBUTE_TEXTURE:     return sizeof(texture_attribute);
     default: INVALID_CODE_PATH;
   }
   return 0; 
 }
 
+internal u32
+GetMaxContainerPayloadSize()
+{
+  u32 Result = 0;
+  for(u32 Type = (u32) container_type::None; Type <= (u32) container_type::List; ++Type)
+  {
+    Result = Maximum(Result, GetContainerPayloadSize((container_type) Type));
+  }
+  return Result;
+}
+
+// Index of the attribute pool and of Node->AttributeData
+inline internal u32
+GetAttributeIndex(container_attribute Attribute)
+{
+  bit_scan_result ScanResult = FindLeastSignificantSetBit((u32) Attribute);
+  Assert(ScanResult.Found);
+  Assert(ScanResult.Index < MENU_ATTRIBUTE_TYPE_COUNT);
+  return ScanResult.Index;
+}
+
 inline container_node*
 Previous(container_node* Node)
 {
@@ -114,6 +136,7 @@ PivotNodes(container_node* ShiftLeft, container_node* ShiftRight)
 
   ShiftLeft->NextSibling = ShiftRight;
   ShiftRight->PreviousSibling = ShiftLeft;
+  MarkLayoutDirty(ShiftLeft, true);
 
   Assert(ShiftRight->PreviousSibling == ShiftLeft);
   Assert(ShiftLeft->NextSibling == ShiftRight);
@@ -163,6 +186,7 @@ ReplaceNode(container_node* Out, container_node* In)
     
     In->PreviousSibling->NextSibling = In;
   }
+  MarkLayoutDirty(In, true);
 
   Out->NextSibling = 0;
   Out->PreviousSibling = 0;
@@ -202,75 +226,85 @@ GetAttributeBatchSize(container_attribute Attri)
 u8* GetAttributePointer(container_node* Node, container_attribute Attri)
 {
   Assert(Attri & Node->Attributes);
-  menu_attribute_header * Attribute = Node->FirstAttribute;
-  u8* Result = 0;
-  while(Attribute)
-  {
-    if(Attribute->Type == Attri)
-    {
-      Result = ( (u8*) Attribute  ) + sizeof(menu_attribute_header);
-      break;
-    }
-    Attribute = Attribute->Next;
-  }
+  u8* Result = Node->AttributeData[GetAttributeIndex(Attri)];
   return Result;
 }
 
 
 container_node* NewContainer(menu_interface* Interface, container_type Type)
 {
-  u32 BaseNodeSize    = sizeof(container_node) + sizeof(memory_link);
-  u32 NodePayloadSize = GetContainerPayloadSize(Type);
-  midx ContainerSize = (BaseNodeSize + NodePayloadSize);
- 
-  container_node* Result = (container_node*) Allocate(&Interface->LinkedMemory, ContainerSize);
+  Assert(sizeof(container_node) + GetContainerPayloadSize(Type) <= Interface->NodePool.BlockSize);
+  container_node* Result = (container_node*) GetNewBlock(Interface->Arena, &Interface->NodePool);
   Result->Type = Type;
   Result->Functions = GetMenuFunction(Type);
+  Result->LayoutFlags = LAYOUT_DIRTY | LAYOUT_ORDER;
 
   return Result;
 }
 
 internal void
-DeleteAllAttributes(menu_interface* Interface, container_node* Node)
+DeleteAttribute(menu_interface* Interface, container_node* Node, container_attribute AttributeType)
 {
-  // TODO: Free attribute data here too?
-  while(Node->FirstAttribute)
-  {
-    menu_attribute_header* Attribute = Node->FirstAttribute;
-    Node->FirstAttribute = Node->FirstAttribute->Next;
-    FreeMemory(&Interface->LinkedMemory, (void*) Attribute);
-  }
-  Node->Attributes = ATTRIBUTE_NONE;
+  Assert(Node->Attributes & (u32)AttributeType);
+
+  u32 AttributeIndex = GetAttributeIndex(AttributeType);
+  FreeBlock(&Interface->AttributePools[AttributeIndex], Node->AttributeData[AttributeIndex]);
+  Node->AttributeData[AttributeIndex] = 0;
+  Node->Attributes =Node->Attributes - (u32)AttributeType;
 }
 
 internal void
-DeleteAttribute(menu_interface* Interface, container_node* Node, container_attribute AttributeType)
+DeleteAllAttributes(menu_interface* Interface, container_node* Node)
 {
-  Assert(Node->Attributes & (u32)AttributeType);
-
-  menu_attribute_header** AttributePtr = &Node->FirstAttribute;
-  while((*AttributePtr)->Type != AttributeType)
+  while(Node->Attributes)
   {
-    AttributePtr = &(*AttributePtr)->Next;
-  }  
-
-  menu_attribute_header* AttributeToRemove = *AttributePtr;
-  *AttributePtr = AttributeToRemove->Next;
-
-  FreeMemory(&Interface->LinkedMemory, (void*) AttributeToRemove);
-  Node->Attributes =Node->Attributes - (u32)AttributeType;
+    bit_scan_result ScanResult = FindLeastSignificantSetBit(Node->Attributes);
+    DeleteAttribute(Interface, Node, (container_attribute)(1 << ScanResult.Index));
+  }
 }
 
 
 internal void CancelAllUpdateFunctions(menu_interface* Interface, container_node* Node )
 {
-  for(u32 i = 0; i < ArrayCount(Interface->UpdateQueue); ++i)
+  for(u32 i = 0; i < Interface->UpdateQueueCount; ++i)
   {
     update_args* Entry = &Interface->UpdateQueue[i];
-    if(Entry->InUse && Entry->Caller == Node)
+    if(Entry->Caller == Node)
+    {
+      Entry->Function = 0;
+    }
+  }
+}
+
+// Deleted nodes are already disconnected so we can't find their tree, every tree is searched
+internal void
+RemoveFromHotLeafs(menu_interface* Interface, container_node* Node)
+{
+  for(menu_tree* Menu = Interface->MenuSentinel.Next; Menu != &Interface->MenuSentinel; Menu = Menu->Next)
+  {
+    u32 HotLeafCount = 0;
+    u32 NewLeafOffset = Menu->NewLeafOffset;
+    for(u32 LeafIndex = 0; LeafIndex < Menu->HotLeafCount; ++LeafIndex)
+    {
+      if(Menu->HotLeafs[LeafIndex] != Node)
+      {
+        Menu->HotLeafs[HotLeafCount++] = Menu->HotLeafs[LeafIndex];
+      }else if(LeafIndex < Menu->NewLeafOffset){
+        --NewLeafOffset;
+      }
+    }
+    Menu->HotLeafCount = HotLeafCount;
+    Menu->NewLeafOffset = NewLeafOffset;
+
+    u32 RemovedHotLeafCount = 0;
+    for(u32 LeafIndex = 0; LeafIndex < Menu->RemovedHotLeafCount; ++LeafIndex)
     {
-      *Entry = {};
+      if(Menu->RemovedHotLeafs[LeafIndex] != Node)
+      {
+        Menu->RemovedHotLeafs[RemovedHotLeafCount++] = Menu->RemovedHotLeafs[LeafIndex];
+      }
     }
+    Menu->RemovedHotLeafCount = RemovedHotLeafCount;
   }
 }
 
@@ -279,8 +313,13 @@ void DeleteContainer( menu_interface* Interface, container_node* Node)
 {
   CancelAllUpdateFunctions(Interface, Node );
   ClearMenuEvents(Interface, Node);
+  RemoveFromHotLeafs(Interface, Node);
   DeleteAllAttributes(Interface, Node);
-  FreeMemory(&Interface->LinkedMemory, (void*) Node);
+  if(Node->Type == container_type::List && GetListNode(Node)->BoundItems)
+  {
+    FreeMemory(&Interface->LinkedMemory, GetListNode(Node)->BoundItems);
+  }
+  FreeBlock(&Interface->NodePool, (bptr) Node);
 }
 
 menu_tree* NewMenuTree(menu_interface* Interface)
@@ -399,19 +438,117 @@ u32_pair UpdateSubTreeDepthAndCount( u32 ParentDepth, container_node* SubTreeRoo
   return Result;
 }
 
-void TreeSensus( menu_tree* Menu )
+internal void
+FreeTreeOrder(menu_interface* Interface, menu_tree* Menu)
+{
+  if(Menu->Nodes)
+  {
+    FreeMemory(&Interface->LinkedMemory, Menu->Nodes);
+    FreeMemory(&Interface->LinkedMemory, Menu->SubTreeEnds);
+    FreeMemory(&Interface->LinkedMemory, Menu->ParentIndices);
+    FreeMemory(&Interface->LinkedMemory, Menu->Rects);
+  }
+  if(Menu->HitGrid.Entries)
+  {
+    FreeMemory(&Interface->LinkedMemory, Menu->HitGrid.Entries);
+  }
+  Menu->MaxNodeCount = 0;
+  Menu->Nodes = 0;
+  Menu->SubTreeEnds = 0;
+  Menu->ParentIndices = 0;
+  Menu->Rects = 0;
+  Menu->HitGrid = {};
+}
+
+// Rebuilds Menu->Nodes. Children are visited last to first, the order the draw and hit passes have always used.
+void TreeSensus( menu_interface* Interface, menu_tree* Menu )
 {
   u32_pair Pair =  UpdateSubTreeDepthAndCount( 0, Menu->Root );
 
   Menu->NodeCount = Pair.a;
   Menu->Depth = Pair.b;
  // Platform.DEBUGPrint("Tree Sensus:  Depth: %d, Count: %d\n", Pair.b, Pair.a);
+
+  if(Menu->NodeCount > Menu->MaxNodeCount)
+  {
+    u32 MaxNodeCount = Maximum(2 * Menu->MaxNodeCount, Menu->NodeCount);
+    FreeTreeOrder(Interface, Menu);
+    Menu->MaxNodeCount = MaxNodeCount;
+    Menu->Nodes = (container_node**) Allocate(&Interface->LinkedMemory, MaxNodeCount * sizeof(container_node*));
+    Menu->SubTreeEnds = (u32*) Allocate(&Interface->LinkedMemory, MaxNodeCount * sizeof(u32));
+    Menu->ParentIndices = (u32*) Allocate(&Interface->LinkedMemory, MaxNodeCount * sizeof(u32));
+    Menu->Rects = (rect2f*) Allocate(&Interface->LinkedMemory, MaxNodeCount * sizeof(rect2f));
+  }
+  Menu->HitGrid.Valid = false;
+
+  container_node* Root = Menu->Root;
+  container_node* Node = Root;
+  u32 NodeIndex = 0;
+  while(Node)
+  {
+    Menu->Nodes[NodeIndex++] = Node;
+    if(Node->FirstChild)
+    {
+      Node = Node->FirstChild;
+      while(Next(Node))
+      {
+        Node = Next(Node);
+      }
+      continue;
+    }
+
+    while(Node != Root && !Previous(Node))
+    {
+      Node = Node->Parent;
+    }
+    Node = (Node == Root) ? 0 : Previous(Node);
+  }
+  Assert(NodeIndex == Menu->NodeCount);
+
+  // A subtree ends at the first following node that is not deeper. Walking backwards the
+  // subtrees below have their ends already and can be jumped over.
+  for(s32 Index = (s32) Menu->NodeCount-1; Index >= 0; --Index)
+  {
+    u32 End = Index + 1;
+    while(End < Menu->NodeCount && Menu->Nodes[End]->Depth > Menu->Nodes[Index]->Depth)
+    {
+      End = Menu->SubTreeEnds[End];
+    }
+    Menu->SubTreeEnds[Index] = End;
+  }
+
+  // The children of a node are found by jumping from subtree to subtree after it
+  Menu->ParentIndices[0] = 0;
+  for(u32 Index = 0; Index < Menu->NodeCount; ++Index)
+  {
+    u32 Child = Index + 1;
+    while(Child < Menu->SubTreeEnds[Index])
+    {
+      Menu->ParentIndices[Child] = Index;
+      Child = Menu->SubTreeEnds[Child];
+    }
+  }
+
+  Root->LayoutFlags &= ~LAYOUT_ORDER;
 }
 
 
+internal void
+FreeDrawCache(menu_interface* Interface, menu_draw_cache* Cache)
+{
+  if(Cache->Commands)
+  {
+    FreeMemory(&Interface->LinkedMemory, Cache->Commands);
+  }
+  if(Cache->Entries)
+  {
+    FreeMemory(&Interface->LinkedMemory, Cache->Entries);
+  }
+  *Cache = {};
+}
+
 void FreeMenuTree(menu_interface* Interface, menu_tree* MenuToFree)
 {
-  TreeSensus(MenuToFree);
   if(MenuToFree == Interface->SpawningWindow)
   {
     Interface->SpawningWindow = GetNextSpawningWindow(Interface);
@@ -420,6 +557,8 @@ void FreeMenuTree(menu_interface* Interface, menu_tree* MenuToFree)
 
   ListRemove( MenuToFree );
   container_node* Root = MenuToFree->Root;
+  FreeDrawCache(Interface, &MenuToFree->DrawCache);
+  FreeTreeOrder(Interface, MenuToFree);
 
   FreeMemory(&Interface->LinkedMemory, (void*)MenuToFree);
 
@@ -492,42 +631,82 @@ rect2f GetSizedParentRegion(size_attribute* SizeAttr, rect2f BaseRegion)
   return Result;
 }
 
-void UpdateRegions( menu_tree* Menu )
+void MarkLayoutDirty(container_node* Node, b32 OrderChanged)
 {
-  temporary_memory TempMem =  BeginTemporaryMemory(GlobalGameState->TransientArena);
+  // The parent lays the node out again. Stacked grids shrink their own region to their content so
+  // they are laid out again from their parent as well.
+  container_node* Dirty = Node->Parent ? Node->Parent : Node;
+  if(Dirty->Type == container_type::Grid && Dirty->Parent)
+  {
+    Dirty = Dirty->Parent;
+  }
+  Dirty->LayoutFlags |= LAYOUT_DIRTY;
+  container_node* Root = Dirty;
+  for(container_node* Ancestor = Dirty->Parent; Ancestor; Ancestor = Ancestor->Parent)
+  {
+    Ancestor->LayoutFlags |= LAYOUT_DIRTY_DESCENDANT;
+    Root = Ancestor;
+  }
+  if(OrderChanged)
+  {
+    Root->LayoutFlags |= LAYOUT_ORDER;
+  }
+}
 
-  u32 StackElementSize = sizeof(container_node*);
-  u32 StackByteSize = Menu->NodeCount * StackElementSize;
+// Makes sure Menu->Nodes matches the tree before it is scanned
+internal void
+UpdateTreeOrder(menu_interface* Interface, menu_tree* Menu)
+{
+  if(Menu->Root->LayoutFlags & LAYOUT_ORDER)
+  {
+    TreeSensus(Interface, Menu);
+  }
+}
 
-  u32 StackCount = 0;
-  container_node** ContainerStack = PushArray(GlobalGameState->TransientArena, Menu->NodeCount, container_node*);
+// Lays out the dirty subtrees of the menu, returns false if nothing in it changed
+b32 UpdateRegions( menu_interface* Interface, menu_tree* Menu )
+{
+  if(!Menu->Root->LayoutFlags)
+  {
+    return false;
+  }
 
-  // Push Root
-  ContainerStack[StackCount++] = Menu->Root;
+  UpdateTreeOrder(Interface, Menu);
 
-  while(StackCount>0)
+  // Parents come before their children so a dirty parent has flagged its children before they are reached
+  u32 NodeIndex = 0;
+  while(NodeIndex < Menu->NodeCount)
   {
-    // Pop new parent from Stack
-    container_node* Parent = ContainerStack[--StackCount];
-    ContainerStack[StackCount] = 0;
-
-    if(HasAttribute(Parent, ATTRIBUTE_SIZE))
+    container_node* Parent = Menu->Nodes[NodeIndex];
+    u32 LayoutFlags = Parent->LayoutFlags;
+    Parent->LayoutFlags = LAYOUT_NONE;
+    if(!LayoutFlags)
     {
-      size_attribute* SizeAttr = (size_attribute*) GetAttributePointer(Parent, ATTRIBUTE_SIZE);
-      Parent->Region = GetSizedParentRegion(SizeAttr, Parent->Region);
+      NodeIndex = Menu->SubTreeEnds[NodeIndex];
+      continue;
     }
 
-    // Update the region of all children and push them to the stack
-    CallFunctionPointer(Parent->Functions.UpdateChildRegions, Parent);
-    container_node* Child = Parent->FirstChild;
-    while(Child)
+    if(LayoutFlags & LAYOUT_DIRTY)
     {
-      ContainerStack[StackCount++] = Child;
-      Child = Next(Child);
+      // Update the region of all children, everything below them has to be laid out again too
+      CallFunctionPointer(Parent->Functions.UpdateChildRegions, Parent);
+      container_node* Child = Parent->FirstChild;
+      while(Child)
+      {
+        if(HasAttribute(Child, ATTRIBUTE_SIZE))
+        {
+          size_attribute* SizeAttr = (size_attribute*) GetAttributePointer(Child, ATTRIBUTE_SIZE);
+          Child->Region = GetSizedParentRegion(SizeAttr, Child->Region);
+        }
+        Child->LayoutFlags |= LAYOUT_DIRTY;
+        Child = Next(Child);
+      }
     }
+    ++NodeIndex;
   }
 
-  EndTemporaryMemory(TempMem);
+  Menu->HitGrid.Valid = false;
+  return true;
 }
 
 void DrawMergeSlots(container_node* Node)
@@ -542,23 +721,123 @@ void DrawMergeSlots(container_node* Node)
   }
 }
 
-// Preorder breadth first.
-void DrawMenu( memory_arena* Arena, menu_interface* Interface, u32 NodeCount, container_node* Container )
+// Grows a draw cache array to hold Count elements. Fails if the cache would get bigger than MENU_DRAW_CACHE_MAX_SIZE.
+internal b32
+ReserveDrawCacheArray(menu_interface* Interface, void** Array, u32* MaxCount, u32 Count, u32 ElementSize)
 {
-  u32 StackElementSize = sizeof(container_node*);
-  u32 StackByteSize = NodeCount * StackElementSize;
+  if(Count <= *MaxCount)
+  {
+    return true;
+  }
 
-  u32 StackCount = 0;
-  container_node** ContainerStack = PushArray(Arena, NodeCount, container_node*);
+  u32 NewMaxCount = Maximum(Maximum(2 * (*MaxCount), Count), 64u);
+  if((midx) NewMaxCount * ElementSize > MENU_DRAW_CACHE_MAX_SIZE)
+  {
+    return false;
+  }
 
-  // Push Root
-  ContainerStack[StackCount++] = Container;
+  void* NewArray = Allocate(&Interface->LinkedMemory, NewMaxCount * ElementSize);
+  if(*Array)
+  {
+    utils::Copy(*MaxCount * ElementSize, *Array, NewArray);
+    FreeMemory(&Interface->LinkedMemory, *Array);
+  }
+  *Array = NewArray;
+  *MaxCount = NewMaxCount;
+  return true;
+}
 
-  while(StackCount>0)
+internal b32
+PushDrawCommand(menu_interface* Interface, menu_draw_cache* Cache, menu_draw_command Command)
+{
+  if(!ReserveDrawCacheArray(Interface, (void**) &Cache->Commands, &Cache->MaxCommandCount, Cache->CommandCount + 1, sizeof(menu_draw_command)))
   {
-    // Pop new parent from Stack
-    container_node* Parent = ContainerStack[--StackCount];
-    ContainerStack[StackCount] = 0;
+    return false;
+  }
+  Cache->Commands[Cache->CommandCount++] = Command;
+  return true;
+}
+
+// Copies the entries pushed to the overlay after Mark into the cache
+internal b32
+RecordDrawEntries(menu_interface* Interface, menu_draw_cache* Cache, render_group* RenderGroup, push_buffer_header* Mark)
+{
+  push_buffer_header* Entry = Mark ? Mark->Next : RenderGroup->First;
+  if(!Entry)
+  {
+    return true;
+  }
+
+  menu_draw_command Command = {};
+  Command.EntryOffset = Cache->EntrySize;
+  while(Entry)
+  {
+    u32 BodySize = RenderTypeToBodySize(Entry->Type);
+    u32 EntrySize = sizeof(render_buffer_entry_type) + BodySize;
+    if(!ReserveDrawCacheArray(Interface, (void**) &Cache->Entries, &Cache->MaxEntrySize, Cache->EntrySize + EntrySize, 1))
+    {
+      return false;
+    }
+    u8* Dst = Cache->Entries + Cache->EntrySize;
+    *(render_buffer_entry_type*) Dst = Entry->Type;
+    utils::Copy(BodySize, GetBody(Entry, u8), Dst + sizeof(render_buffer_entry_type));
+    Cache->EntrySize += EntrySize;
+    ++Command.EntryCount;
+    Entry = Entry->Next;
+  }
+  return PushDrawCommand(Interface, Cache, Command);
+}
+
+internal void
+ReplayDrawCache(menu_interface* Interface, menu_draw_cache* Cache, render_group* RenderGroup)
+{
+  // The recorded glyph quads skip GetGlyph, their shelves must still count as drawn this frame
+  TouchShelves(GlobalGameState->AssetManager->FontCache, Cache->ShelfMask);
+  for(u32 CommandIndex = 0; CommandIndex < Cache->CommandCount; ++CommandIndex)
+  {
+    menu_draw_command* Command = Cache->Commands + CommandIndex;
+    if(Command->Node)
+    {
+      CallFunctionPointer(Command->Node->Functions.Draw, Interface, Command->Node);
+      continue;
+    }
+
+    u8* Entry = Cache->Entries + Command->EntryOffset;
+    for(u32 EntryIndex = 0; EntryIndex < Command->EntryCount; ++EntryIndex)
+    {
+      render_buffer_entry_type Type = *(render_buffer_entry_type*) Entry;
+      Entry += sizeof(render_buffer_entry_type);
+      PushEntryCopy(RenderGroup, Type, Entry);
+      Entry += RenderTypeToBodySize(Type);
+    }
+  }
+}
+
+// Depth first in the order of Menu->Nodes.
+// The tree is only walked when its draw cache is out of date. Otherwise the recorded entries are
+// pushed again and only the nodes with a draw function are called.
+void DrawMenu( menu_interface* Interface, menu_tree* Menu )
+{
+  render_group* RenderGroup = GlobalGameState->RenderCommands->OverlayGroup;
+  font_cache* FontCache = GlobalGameState->AssetManager->FontCache;
+  menu_draw_cache* Cache = &Menu->DrawCache;
+  if(Cache->Valid && Cache->FontGeneration == FontCache->Generation)
+  {
+    ReplayDrawCache(Interface, Cache, RenderGroup);
+    return;
+  }
+
+  // A miss in the font cache while recording changes the generation so the tree is recorded again next frame
+  Cache->Valid = true;
+  Cache->FontGeneration = FontCache->Generation;
+  Cache->CommandCount = 0;
+  Cache->EntrySize = 0;
+  ClearShelfMask(FontCache);
+  push_buffer_header* Mark = RenderGroup->Last;
+
+  for(u32 NodeIndex = 0; NodeIndex < Menu->NodeCount; ++NodeIndex)
+  {
+    container_node* Parent = Menu->Nodes[NodeIndex];
 
     if(HasAttribute(Parent, ATTRIBUTE_COLOR))
     {
@@ -568,7 +847,12 @@ void DrawMenu( memory_arena* Arena, menu_interface* Interface, u32 NodeCount, co
 
     if(Parent->Functions.Draw)
     {
+      menu_draw_command Command = {};
+      Command.Node = Parent;
+      Cache->Valid = Cache->Valid && RecordDrawEntries(Interface, Cache, RenderGroup, Mark);
+      Cache->Valid = Cache->Valid && PushDrawCommand(Interface, Cache, Command);
       CallFunctionPointer(Parent->Functions.Draw, Interface, Parent);  
+      Mark = RenderGroup->Last;
     }
 
     if(HasAttribute(Parent, ATTRIBUTE_TEXT))
@@ -589,66 +873,230 @@ void DrawMenu( memory_arena* Arena, menu_interface* Interface, u32 NodeCount, co
     {
       DrawMergeSlots(Parent);
     }
-    // Update the region of all children and push them to the stack
+  }
+  Cache->Valid = Cache->Valid && RecordDrawEntries(Interface, Cache, RenderGroup, Mark);
+  CopyShelfMask(FontCache, Cache->ShelfMask);
+}
+
+// For changes the layout does not see, like a callback recoloring a node
+internal void
+InvalidateMenuDrawCaches(menu_interface* Interface)
+{
+  for(menu_tree* Menu = Interface->MenuSentinel.Next; Menu != &Interface->MenuSentinel; Menu = Menu->Next)
+  {
+    Menu->DrawCache.Valid = false;
+  }
+}
+
+
+u32 GetIntersectingNodes(menu_tree* Menu, v2 MousePos, u32 MaxCount, container_node** Result)
+{
+  u32 IntersectingLeafCount = 0;
+
+  u32 NodeIndex = 0;
+  while(NodeIndex < Menu->NodeCount)
+  {
+    container_node* Parent = Menu->Nodes[NodeIndex];
+
+    // Nothing below a node the mouse is outside of is checked
+    if(!Intersects(Parent->Region, MousePos))
+    {
+      NodeIndex = Menu->SubTreeEnds[NodeIndex];
+      continue;
+    }
+
+    u32 IntersectingChildren = 0;
     container_node* Child = Parent->FirstChild;
     while(Child)
     {
-      ContainerStack[StackCount++] = Child;
+      if(Intersects(Child->Region, MousePos))
+      {
+        IntersectingChildren++;
+      }
       Child = Next(Child);
+    }  
+
+    if(IntersectingChildren==0)
+    {
+      Assert(IntersectingLeafCount < MaxCount);
+      Result[IntersectingLeafCount++] = Parent;
     }
+    ++NodeIndex;
   }
+  return IntersectingLeafCount;
 }
 
+inline internal u32
+GetHitGridCell(r32 Position, r32 Base, r32 CellSize)
+{
+  r32 Cell = Floor((Position - Base) / CellSize);
+  u32 Result = (u32) Maximum(0.f, Minimum(Cell, (r32) (MENU_HIT_GRID_SIZE - 1)));
+  return Result;
+}
 
-u32 GetIntersectingNodes(u32 NodeCount, container_node* Container, v2 MousePos, u32 MaxCount, container_node** Result)
+internal void
+BuildHitGrid(menu_interface* Interface, menu_tree* Menu)
 {
-  u32 StackElementSize = sizeof(container_node*);
-  u32 StackByteSize = NodeCount * StackElementSize;
+  menu_hit_grid* Grid = &Menu->HitGrid;
+  Grid->Valid = true;
+  Grid->Overflow = false;
+  Grid->Bounds = Menu->Root->Region;
+  if(Grid->Bounds.W <= 0 || Grid->Bounds.H <= 0)
+  {
+    Grid->Overflow = true;
+    return;
+  }
 
-  u32 StackCount = 0;
-  temporary_memory TempMem = BeginTemporaryMemory(GlobalGameState->TransientArena);
-  container_node** ContainerStack = PushArray(GlobalGameState->TransientArena, NodeCount, container_node*);
+  r32 CellW = Grid->Bounds.W / MENU_HIT_GRID_SIZE;
+  r32 CellH = Grid->Bounds.H / MENU_HIT_GRID_SIZE;
 
-  u32 IntersectingLeafCount = 0;
+  // Count the nodes of each cell, CellOffsets[Cell+1] holds the count of Cell until the prefix sum
+  ZeroArray(ArrayCount(Grid->CellOffsets), Grid->CellOffsets);
+  for(u32 NodeIndex = 0; NodeIndex < Menu->NodeCount; ++NodeIndex)
+  {
+    rect2f Rect = Menu->Nodes[NodeIndex]->Region;
+    Menu->Rects[NodeIndex] = Rect;
+    // Intersects on two rects is true when they are apart
+    if(!Intersects(Grid->Bounds, Rect))
+    {
+      u32 X0 = GetHitGridCell(Rect.X, Grid->Bounds.X, CellW);
+      u32 X1 = GetHitGridCell(Rect.X + Rect.W, Grid->Bounds.X, CellW);
+      u32 Y0 = GetHitGridCell(Rect.Y, Grid->Bounds.Y, CellH);
+      u32 Y1 = GetHitGridCell(Rect.Y + Rect.H, Grid->Bounds.Y, CellH);
+      for(u32 Y = Y0; Y <= Y1; ++Y)
+      {
+        for(u32 X = X0; X <= X1; ++X)
+        {
+          ++Grid->CellOffsets[Y * MENU_HIT_GRID_SIZE + X + 1];
+        }
+      }
+    }
+  }
 
-  // Push Root
-  ContainerStack[StackCount++] = Container;
+  u32 CellCount = MENU_HIT_GRID_SIZE * MENU_HIT_GRID_SIZE;
+  for(u32 Cell = 0; Cell < CellCount; ++Cell)
+  {
+    Grid->CellOffsets[Cell + 1] += Grid->CellOffsets[Cell];
+  }
 
-  while(StackCount>0)
+  u32 EntryCount = Grid->CellOffsets[CellCount];
+  if(EntryCount > MENU_HIT_GRID_MAX_ENTRY_COUNT)
   {
-    // Pop new parent from Stack
-    container_node* Parent = ContainerStack[--StackCount];
-    ContainerStack[StackCount] = 0;
+    Grid->Overflow = true;
+    return;
+  }
+  if(EntryCount > Grid->MaxEntryCount)
+  {
+    if(Grid->Entries)
+    {
+      FreeMemory(&Interface->LinkedMemory, Grid->Entries);
+    }
+    Grid->MaxEntryCount = Minimum(Maximum(2 * Grid->MaxEntryCount, EntryCount), (u32) MENU_HIT_GRID_MAX_ENTRY_COUNT);
+    Grid->Entries = (u32*) Allocate(&Interface->LinkedMemory, Grid->MaxEntryCount * sizeof(u32));
+  }
 
-    // Check if mouse is inside the child region and push those to the stack.
-    if(Intersects(Parent->Region, MousePos))
+  // Nodes are added in order so every cell lists parents before their children
+  u32 Cursors[MENU_HIT_GRID_SIZE * MENU_HIT_GRID_SIZE];
+  CopyArray(CellCount, Grid->CellOffsets, Cursors);
+  for(u32 NodeIndex = 0; NodeIndex < Menu->NodeCount; ++NodeIndex)
+  {
+    rect2f Rect = Menu->Rects[NodeIndex];
+    if(!Intersects(Grid->Bounds, Rect))
     {
-      u32 IntersectingChildren = 0;
-      container_node* Child = Parent->FirstChild;
-      while(Child)
+      u32 X0 = GetHitGridCell(Rect.X, Grid->Bounds.X, CellW);
+      u32 X1 = GetHitGridCell(Rect.X + Rect.W, Grid->Bounds.X, CellW);
+      u32 Y0 = GetHitGridCell(Rect.Y, Grid->Bounds.Y, CellH);
+      u32 Y1 = GetHitGridCell(Rect.Y + Rect.H, Grid->Bounds.Y, CellH);
+      for(u32 Y = Y0; Y <= Y1; ++Y)
       {
-        if(Intersects(Child->Region, MousePos))
+        for(u32 X = X0; X <= X1; ++X)
         {
-          ContainerStack[StackCount++] = Child;
-          IntersectingChildren++;
+          Grid->Entries[Cursors[Y * MENU_HIT_GRID_SIZE + X]++] = NodeIndex;
         }
-        Child = Next(Child);
-      }  
+      }
+    }
+  }
+}
+
+// Finds the index of Node in the sorted Indices, or Count if it is not there
+internal u32
+FindSortedIndex(u32 Count, u32* Indices, u32 Node)
+{
+  u32 Low = 0;
+  u32 High = Count;
+  while(Low < High)
+  {
+    u32 Middle = (Low + High) / 2;
+    if(Indices[Middle] < Node)
+    {
+      Low = Middle + 1;
+    }else{
+      High = Middle;
+    }
+  }
+  u32 Result = (Low < Count && Indices[Low] == Node) ? Low : Count;
+  return Result;
+}
+
+// Same result as GetIntersectingNodes but only the nodes in the cell under the mouse are tested.
+// A node is reached if it and all its parents contain the mouse, reached nodes without reached
+// children are the hot leafs.
+internal u32
+GetIntersectingNodesFromGrid(menu_tree* Menu, v2 MousePos, u32 MaxCount, container_node** Result)
+{
+  menu_hit_grid* Grid = &Menu->HitGrid;
+  if(!Intersects(Grid->Bounds, MousePos))
+  {
+    return 0;
+  }
+
+  u32 X = GetHitGridCell(MousePos.X, Grid->Bounds.X, Grid->Bounds.W / MENU_HIT_GRID_SIZE);
+  u32 Y = GetHitGridCell(MousePos.Y, Grid->Bounds.Y, Grid->Bounds.H / MENU_HIT_GRID_SIZE);
+  u32 Cell = Y * MENU_HIT_GRID_SIZE + X;
+  u32 CandidateCount = Grid->CellOffsets[Cell + 1] - Grid->CellOffsets[Cell];
+  u32* Candidates = Grid->Entries + Grid->CellOffsets[Cell];
 
-      if(IntersectingChildren==0)
+  ScopedMemory Memory(GlobalGameState->TransientArena);
+  u32* Hits = PushArray(GlobalGameState->TransientArena, CandidateCount, u32, NoClear());
+  b32* HasReachedChild = PushArray(GlobalGameState->TransientArena, CandidateCount, b32);
+  u32 HitCount = 0;
+  for(u32 CandidateIndex = 0; CandidateIndex < CandidateCount; ++CandidateIndex)
+  {
+    u32 NodeIndex = Candidates[CandidateIndex];
+    if(!Intersects(Menu->Rects[NodeIndex], MousePos))
+    {
+      continue;
+    }
+
+    // Parents come first so they are already in Hits if they were reached
+    if(NodeIndex != 0)
+    {
+      u32 Parent = FindSortedIndex(HitCount, Hits, Menu->ParentIndices[NodeIndex]);
+      if(Parent == HitCount)
       {
-        Assert(IntersectingLeafCount < MaxCount);
-        Result[IntersectingLeafCount++] = Parent;
+        continue;
       }
+      HasReachedChild[Parent] = true;
+    }
+    Hits[HitCount++] = NodeIndex;
+  }
+
+  u32 IntersectingLeafCount = 0;
+  for(u32 HitIndex = 0; HitIndex < HitCount; ++HitIndex)
+  {
+    if(!HasReachedChild[HitIndex])
+    {
+      Assert(IntersectingLeafCount < MaxCount);
+      Result[IntersectingLeafCount++] = Menu->Nodes[Hits[HitIndex]];
     }
   }
-  EndTemporaryMemory(TempMem);
   return IntersectingLeafCount;
 }
 
 container_node* ConnectNodeToFront(container_node* Parent, container_node* NewNode)
 {
   NewNode->Parent = Parent;
+  MarkLayoutDirty(NewNode, true);
 
   if(!Parent->FirstChild){
     Parent->FirstChild = NewNode;
@@ -666,6 +1114,7 @@ container_node* ConnectNodeToFront(container_node* Parent, container_node* NewNo
 container_node* ConnectNodeToBack(container_node* Parent, container_node* NewNode)
 {
   NewNode->Parent = Parent;
+  MarkLayoutDirty(NewNode, true);
 
   if(!Parent->FirstChild){
     Parent->FirstChild = NewNode;
@@ -688,6 +1137,7 @@ void DisconnectNode(container_node* Node)
   if(Parent)
   {
     Assert(Parent->FirstChild);
+    MarkLayoutDirty(Node, true);
     if(Node->PreviousSibling)
     {
       Node->PreviousSibling->NextSibling = Node->NextSibling;  
@@ -866,9 +1316,9 @@ r32 PrintTree(u32 Count, container_node** HotLeafs, r32 YStart, u32 FontSize, r3
 void PrintHotLeafs(menu_interface* Interface)
 {
   u32 FontSize = 8;
-  stb_font_map* FontMap = GetFontMap(GlobalGameState->AssetManager, FontSize);
+  font_metrics Metrics = GetFontMetrics(GlobalGameState->AssetManager->FontCache, DEFAULT_FONT, FontSize);
   game_window_size WindowSize = GameGetWindowSize();
-  r32 HeightStep = (FontMap->Ascent - FontMap->Descent)/WindowSize.HeightPx;
+  r32 HeightStep = (Metrics.Ascent - Metrics.Descent)/WindowSize.HeightPx;
   r32 WidthStep  = 0.02;
   r32 YOff = 1 - 2*HeightStep;
 
@@ -946,18 +1396,13 @@ void * PushAttribute(menu_interface* Interface, container_node* Node, container_
   Assert(!(Node->Attributes & AttributeType));
 
   Node->Attributes = Node->Attributes | AttributeType;
-  menu_attribute_header** HeaderPtr = &Node->FirstAttribute;
-  while(*HeaderPtr)
+  u32 AttributeIndex = GetAttributeIndex(AttributeType);
+  Node->AttributeData[AttributeIndex] = GetNewBlock(Interface->Arena, &Interface->AttributePools[AttributeIndex]);
+  void* Result = (void*) Node->AttributeData[AttributeIndex];
+  if(AttributeType == ATTRIBUTE_SIZE)
   {
-    menu_attribute_header* Header = *HeaderPtr;
-    HeaderPtr = &(Header->Next);
+    MarkLayoutDirty(Node);
   }
-
-  u32 TotalSize = sizeof(menu_attribute_header) + GetAttributeSize(AttributeType);
-  menu_attribute_header* Attr =  (menu_attribute_header*) Allocate(&Interface->LinkedMemory, TotalSize);
-  Attr->Type = AttributeType;
-  *HeaderPtr = Attr;
-  void* Result = (void*)(((u8*)Attr) + sizeof(menu_attribute_header));
   return Result;
 }
 
@@ -980,26 +1425,9 @@ void MoveAttribute(container_node* From, container_node* To, container_attribute
   Assert(HasAttribute(From, AttributeType));
   Assert(!HasAttribute(To, AttributeType));
 
-  menu_attribute_header** AttributePtr = &From->FirstAttribute;
-  while((*AttributePtr)->Type != AttributeType)
-  {
-    AttributePtr = &(*AttributePtr)->Next;
-  }
-
-  menu_attribute_header* AttributeToMove = *AttributePtr;
-  *AttributePtr = AttributeToMove->Next;
-
-  menu_attribute_header* DstAttribute = To->FirstAttribute;
-  if(To->FirstAttribute)
-  {
-    while(DstAttribute->Next)
-    {
-      DstAttribute = DstAttribute->Next;
-    }
-    DstAttribute->Next = AttributeToMove;
-  }else{
-    To->FirstAttribute = AttributeToMove;
-  }
+  u32 AttributeIndex = GetAttributeIndex(AttributeType);
+  To->AttributeData[AttributeIndex] = From->AttributeData[AttributeIndex];
+  From->AttributeData[AttributeIndex] = 0;
 
   From->Attributes = From->Attributes - (u32)AttributeType;
   To->Attributes = To->Attributes + (u32)AttributeType;
@@ -1046,93 +1474,71 @@ void UpdateFrameBorder( menu_interface* Interface, border_leaf* Border )
 
 void _PushToUpdateQueue(menu_interface* Interface, container_node* Caller, update_function** Function, void* Data)
 {
-  update_args* Entry = 0;
-  for (u32 i = 0; i < ArrayCount(Interface->UpdateQueue); ++i)
-  {
-    Entry = &Interface->UpdateQueue[i];
-    if(!Entry->InUse)
-    {
-      break;
-    }
-  }
-  Assert(!Entry->InUse);
-
+  Assert(Interface->UpdateQueueCount < ArrayCount(Interface->UpdateQueue));
+  update_args* Entry = &Interface->UpdateQueue[Interface->UpdateQueueCount++];
   Entry->Interface = Interface;
   Entry->Caller = Caller;
-  Entry->InUse = true;
   Entry->Function = Function;
   Entry->Data = Data;
 }
 
 #define PushToUpdateQueue(Interface, Caller, FunctionName, Data) _PushToUpdateQueue(Interface, Caller, DeclareFunction(update_function, FunctionName), (void*) Data)
 
-void RegisterEventWithNode(menu_interface* Interface, container_node* Node, u32 Handle)
+menu_event* GetMenuEvent(menu_interface* Interface, u32 Slot)
 {
-  menu_event_handle_attribtue* EventHandles = (menu_event_handle_attribtue*) PushOrGetAttribute(Interface, Node, ATTRIBUTE_MENU_EVENT_HANDLE);
-  EventHandles->Handles[EventHandles->HandleCount++] = Handle;
-}
-
-
-// From http://burtleburtle.net/bob/hash/integer.html
-umm IntegerHash(umm a)
-{
-    a = (a ^ 61) ^ (a >> 16);
-    a = a + (a << 3);
-    a = a ^ (a >> 4);
-    a = a * 0x27d4eb2d;
-    a = a ^ (a >> 15);
-    return a;
-}
-umm PointerToHash(void* Ptr)
-{
-  umm Val = (umm) Ptr;
-  umm Result = IntegerHash(Val);
-  return Result;
+  Assert(Slot < Interface->EventSlotCount);
+  menu_event* Event = Interface->Events + Slot;
+  return Event;
 }
 
-u32 GetEmptyMenuEventHandle(menu_interface* Interface, container_node* CallerNode)
+// Takes a slot from the free list or the end of the array, doubling the array when it is full.
+internal u32
+NewMenuEventSlot(menu_interface* Interface)
 {
-  u32 MaxEventCount = ArrayCount(Interface->MenuEventCallbacks);
-  Interface->MenuEventCallbackCount++;
-  Assert(Interface->MenuEventCallbackCount < MaxEventCount);
-  u32 Hash = (u32)(PointerToHash((void*)CallerNode) % MaxEventCount);
-  menu_event* Event = &Interface->MenuEventCallbacks[Hash];
-  u32 Handle = Hash;
-  while(Event->Active)
+  u32 Slot = 0;
+  if(Interface->FirstFreeEvent)
   {
-    ++Event;
-    ++Handle;
-    if(Handle >= MaxEventCount)
+    Slot = Interface->FirstFreeEvent - 1;
+    Interface->FirstFreeEvent = GetMenuEvent(Interface, Slot)->Next;
+  }else{
+    if(Interface->EventSlotCount == Interface->MaxEventCount)
     {
-      Handle = 0;
-      Event = Interface->MenuEventCallbacks;
+      u32 MaxEventCount = Maximum(2 * Interface->MaxEventCount, 64);
+      menu_event* Events = (menu_event*) Allocate(&Interface->LinkedMemory, MaxEventCount * sizeof(menu_event));
+      if(Interface->Events)
+      {
+        utils::Copy(Interface->EventSlotCount * sizeof(menu_event), Interface->Events, Events);
+        FreeMemory(&Interface->LinkedMemory, Interface->Events);
+      }
+      Interface->Events = Events;
+      Interface->MaxEventCount = MaxEventCount;
     }
+    Slot = Interface->EventSlotCount++;
   }
-  ListInsertBefore(&Interface->EventSentinel, Event);
-  return Handle;
-}
-
-menu_event* GetMenuEvent(menu_interface* Interface, u32 Handle)
-{
-  Assert(Handle < ArrayCount(Interface->MenuEventCallbacks));
-  menu_event* Event = &Interface->MenuEventCallbacks[Handle];
-  return Event;
+  Interface->EventCount++;
+  return Slot;
 }
 
 void _RegisterMenuEvent(menu_interface* Interface, menu_event_type EventType, container_node* CallerNode, void* Data, menu_event_callback** Callback,  menu_event_callback** OnDelete)
 {
-
-  u32 Index = GetEmptyMenuEventHandle(Interface, CallerNode);
-  menu_event* Event  = GetMenuEvent(Interface, Index);
-  Assert(!Event->Active);
+  u32 Slot = NewMenuEventSlot(Interface);
+  menu_event* Event = GetMenuEvent(Interface, Slot);
   Event->Active = true;
-  Event->Index = Index;
   Event->CallerNode = CallerNode;
   Event->EventType = EventType;
   Event->Callback = Callback;
   Event->OnDelete = OnDelete;
   Event->Data = Data;
-  RegisterEventWithNode(Interface, CallerNode, Index);
+  Event->Next = 0;
+
+  // Appended so events of a node are called in the order they were registered
+  u32* Link = &CallerNode->FirstEvent[(u32) EventType];
+  while(*Link)
+  {
+    Link = &GetMenuEvent(Interface, *Link - 1)->Next;
+  }
+  *Link = Slot + 1;
+  Interface->EventTypeCounts[(u32) EventType]++;
 }
 
 MENU_UPDATE_FUNCTION(SplitWindowBorderUpdate)
@@ -1150,6 +1556,7 @@ MENU_UPDATE_FUNCTION(SplitWindowBorderUpdate)
   }else{
     Border->Position += (Interface->MousePos.Y - Interface->PreviousMousePos.Y)/SplitNode->Region.H;
   }
+  MarkLayoutDirty(BorderNode);
   
   return Interface->MouseLeftButton.Active;
 }
@@ -1168,6 +1575,7 @@ MENU_UPDATE_FUNCTION(RootBorderDragUpdate)
   }else{
     Border->Position += Interface->MousePos.Y - Interface->PreviousMousePos.Y;
   }
+  MarkLayoutDirty(CallerNode);
   return Interface->MouseLeftButton.Active;
 }
 
@@ -1194,106 +1602,69 @@ container_node* CreateBorderNode(menu_interface* Interface, b32 Vertical, r32 Po
   return Result;
 }
 
-b32 IsPointerInArray(u32 ArrayCount, container_node** NodeArray, container_node* NodeToCheck, u32* Position)
+// The previous hot leafs have the stamp of the last update of the tree. Leafs still carrying it
+// exist since last update, the others are new. Previous leafs not restamped were removed.
+internal void UpdateHotLeafs(menu_interface* Interface, menu_tree* Menu)
 {
-  b32 Result = false;
-  for (u32 i = 0; i < ArrayCount; ++i)
+  memory_arena* Arena = GlobalGameState->TransientArena;
+  ScopedMemory Memory(Arena);
+
+  // Get all new intersecting nodes. The grid only holds settled regions, while a layout is pending the tree is walked.
+  u32 HotLeafsMaxCount = ArrayCount(Menu->HotLeafs);
+  container_node** CurrentHotLeafs = (container_node**) PushArray(Arena, HotLeafsMaxCount, container_node*, NoClear());
+  UpdateTreeOrder(Interface, Menu);
+  if(!Menu->Root->LayoutFlags && !Menu->HitGrid.Valid)
   {
-    container_node* Node = NodeArray[i];
-    if(Node == NodeToCheck)
-    {
-      Result = true;
-      *Position = i;
-      break;
-    }
+    BuildHitGrid(Interface, Menu);
   }
-  return Result;
-}
-
-// Destroys NewHotLeafs;
-void SortHotLeafs(u32 OldHotLeafCount,   container_node** OldHotLeafs,
-                  u32 NewHotLeafCount,   container_node** NewHotLeafs,
-                  u32* NewCount,      container_node** New,
-                  u32* RemovedCount,  container_node** Removed,
-                  u32* ExistingCount, container_node** Existing)
-{
-  u32 NrNew = 0;
-  u32 NrRemoved = 0;
-  u32 NrExisting = 0;
 
-  // Put all ptr's that exist in both arrays in Existing
-  // And remove it from OldHotLeafs and NewHotLeafs
-  for (u32 i = 0; i < OldHotLeafCount; ++i)
+  u32 CurrentHotLeafCount = 0;
+  if(!Menu->Root->LayoutFlags && !Menu->HitGrid.Overflow)
   {
-    container_node* Leaf = OldHotLeafs[i];
-    u32 Position = 0;
-    if(IsPointerInArray(NewHotLeafCount, NewHotLeafs, Leaf, &Position))
-    {
-      Existing[NrExisting++] = Leaf;
-      NewHotLeafs[Position] = 0;
-      OldHotLeafs[i] = 0;
-    }
+    CurrentHotLeafCount = GetIntersectingNodesFromGrid(Menu, Interface->MousePos, HotLeafsMaxCount, CurrentHotLeafs);
+  }else{
+    CurrentHotLeafCount = GetIntersectingNodes(Menu, Interface->MousePos, HotLeafsMaxCount, CurrentHotLeafs);
   }
-  // The leftover ptr's in NewHotLeafs gets put in New
-  for (u32 i = 0; i < NewHotLeafCount; ++i)
+
+  Assert(CurrentHotLeafCount < HotLeafsMaxCount);
+
+  u32 PreviousStamp = Menu->HotLeafStamp;
+  u32 Stamp = ++Interface->HotLeafStamp;
+  Menu->HotLeafStamp = Stamp;
+
+  u32 NewCount = 0;
+  u32 ExistingCount = 0;
+  container_node** New = PushArray(Arena, HotLeafsMaxCount, container_node*, NoClear());
+  container_node** Existing = PushArray(Arena, HotLeafsMaxCount, container_node*, NoClear());
+  for(u32 LeafIndex = 0; LeafIndex < CurrentHotLeafCount; ++LeafIndex)
   {
-    if(NewHotLeafs[i])
+    container_node* Leaf = CurrentHotLeafs[LeafIndex];
+    if(PreviousStamp && Leaf->HotLeafStamp == PreviousStamp)
     {
-      New[NrNew++] = NewHotLeafs[i];
+      Existing[ExistingCount++] = Leaf;
+    }else{
+      New[NewCount++] = Leaf;
     }
+    Leaf->HotLeafStamp = Stamp;
   }
-  // The leftover ptr's in OldHotLeafs gets put in Removed
-  for (u32 i = 0; i < OldHotLeafCount; ++i)
+
+  u32 RemovedCount = 0;
+  for(u32 LeafIndex = 0; LeafIndex < Menu->HotLeafCount; ++LeafIndex)
   {
-    if(OldHotLeafs[i])
+    container_node* Leaf = Menu->HotLeafs[LeafIndex];
+    if(Leaf->HotLeafStamp != Stamp)
     {
-      Removed[NrRemoved++] = OldHotLeafs[i];
+      Assert(RemovedCount < ArrayCount(Menu->RemovedHotLeafs));
+      Menu->RemovedHotLeafs[RemovedCount++] = Leaf;
     }
   }
- 
-  *NewCount = NrNew;
-  *RemovedCount = NrRemoved;
-  *ExistingCount = NrExisting;
-}
-
-internal void UpdateHotLeafs(menu_interface* Interface, menu_tree* Menu)
-{
-  memory_arena* Arena = GlobalGameState->TransientArena;
-  ScopedMemory Memory(Arena);
-
-  // Get all new intersecting nodes
-  u32 HotLeafsMaxCount = ArrayCount(Menu->HotLeafs);
-  container_node** CurrentHotLeafs = (container_node**) PushArray(Arena, HotLeafsMaxCount, container_node*);
-  u32 CurrentHotLeafCount = GetIntersectingNodes(Menu->NodeCount, Menu->Root, Interface->MousePos, HotLeafsMaxCount, CurrentHotLeafs);
-
-  Assert(CurrentHotLeafCount < HotLeafsMaxCount);
-
-  container_node** OldHotLeafs = (container_node**) PushCopy(Arena, HotLeafsMaxCount, Menu->HotLeafs);
-  
-  // Sort the newly gathered hot leafs into "new", "existing", "removed"
-  u32 RemovedHotLeafsMaxCount = ArrayCount(Menu->RemovedHotLeafs);
-
-  u32 NewCount = 0;
-  u32 RemovedCount = 0;
-  u32 ExistingCount = 0;
-  container_node** New = PushArray(Arena, HotLeafsMaxCount, container_node*);
-  container_node** Existing = PushArray(Arena, HotLeafsMaxCount, container_node*);
-  container_node** Removed = PushArray(Arena, RemovedHotLeafsMaxCount, container_node*);
-  SortHotLeafs(Menu->HotLeafCount,  OldHotLeafs,
-               CurrentHotLeafCount, CurrentHotLeafs,
-               &NewCount,           New,
-               &RemovedCount,       Removed,
-               &ExistingCount,      Existing);
+  Menu->RemovedHotLeafCount = RemovedCount;
 
   Assert(NewCount + ExistingCount < HotLeafsMaxCount);
   CopyArray( ExistingCount, Existing, Menu->HotLeafs);
   CopyArray( NewCount, New, Menu->HotLeafs+ExistingCount);
   Menu->HotLeafCount = NewCount + ExistingCount;
   Menu->NewLeafOffset = ExistingCount;
-  
-  Assert(RemovedCount < RemovedHotLeafsMaxCount);
-  CopyArray( RemovedCount, Removed, Menu->RemovedHotLeafs);
-  Menu->RemovedHotLeafCount = RemovedCount;
 }
 
 
@@ -1374,7 +1745,7 @@ internal u32 FillArrayWithTabs(u32 MaxArrSize, container_node* TabArr[], menu_tr
   u32 StackCount = 0;
   u32 TabCount = 0;
 
-  container_node** ContainerStack = PushArray(GlobalGameState->TransientArena, MaxArrSize, container_node*);
+  container_node** ContainerStack = PushArray(GlobalGameState->TransientArena, MaxArrSize, container_node*, NoClear());
 
   // Push StartNode
   ContainerStack[StackCount++] = StartNode;
@@ -1563,6 +1934,7 @@ MENU_UPDATE_FUNCTION(WindowDragUpdate)
     UpdateFrameBorder(Interface, Border);
     Child = Next(Child);
   }
+  MarkLayoutDirty(Menu->Root);
   
   UpdateMergableAttribute(Interface, CallerNode);
 
@@ -1595,30 +1967,39 @@ MENU_EVENT_CALLBACK(InitiateWindowDrag)
 }
 
 
-void DeregisterEvent(menu_interface* Interface, u32 Handle)
+internal void
+FreeMenuEvent(menu_interface* Interface, u32 Slot)
 {
-  menu_event* Event = GetMenuEvent(Interface, Handle);
-  Interface->MenuEventCallbackCount--;
-  ListRemove(Event);
-  if(Event->OnDelete)
+  menu_event* Event = GetMenuEvent(Interface, Slot);
+  Assert(Event->Active);
+  menu_event Freed = *Event;
+  Interface->EventCount--;
+  Interface->EventTypeCounts[(u32) Freed.EventType]--;
+
+  *Event = {};
+  Event->Generation = Freed.Generation + 1;
+  Event->Next = Interface->FirstFreeEvent;
+  Interface->FirstFreeEvent = Slot + 1;
+
+  // OnDelete may register new events and move the event array
+  if(Freed.OnDelete)
   {
-    CallFunctionPointer(Event->OnDelete, Interface, Event->CallerNode, Event->Data);
+    CallFunctionPointer(Freed.OnDelete, Interface, Freed.CallerNode, Freed.Data);
   }
-  *Event = {};
 }
 
 void ClearMenuEvents(menu_interface* Interface, container_node* Node)
 {
-  if(HasAttribute(Node, ATTRIBUTE_MENU_EVENT_HANDLE))
+  for(u32 EventType = 0; EventType < MENU_EVENT_TYPE_COUNT; ++EventType)
   {
-    menu_event_handle_attribtue* EventHandles = (menu_event_handle_attribtue*) GetAttributePointer(Node, ATTRIBUTE_MENU_EVENT_HANDLE);
-    for(u32 Idx = 0; Idx < EventHandles->HandleCount; ++Idx)
+    u32 Link = Node->FirstEvent[EventType];
+    Node->FirstEvent[EventType] = 0;
+    while(Link)
     {
-      u32 Handle = EventHandles->Handles[Idx];
-      DeregisterEvent(Interface, Handle);
-      EventHandles->Handles[Idx] = 0;
+      u32 Slot = Link - 1;
+      Link = GetMenuEvent(Interface, Slot)->Next;
+      FreeMenuEvent(Interface, Slot);
     }
-    EventHandles->HandleCount = 0;  
   }
 }
 
@@ -1648,9 +2029,7 @@ menu_tree* CreateNewRootContainer(menu_interface* Interface, container_node* Bas
     ConnectNodeToBack(Root->Root, BaseWindow); // Body
   }
 
-  TreeSensus(Root);
-
-  UpdateRegions(Root);
+  UpdateRegions(Interface, Root);
 
   UpdateHotLeafs(Interface, Root);
 
@@ -1825,6 +2204,8 @@ internal void GetInput(game_input* GameInput, menu_interface* Interface)
     Interface->MenuVisible = !Interface->MenuVisible;
   }
 
+  Interface->MouseScroll = GameInput->Mouse.dZ;
+
   Update(&Interface->MouseLeftButton, GameInput->Mouse.Button[PlatformMouseButton_Left].Active);
   if(Interface->MouseLeftButton.Edge)
   {
@@ -1837,27 +2218,34 @@ internal void GetInput(game_input* GameInput, menu_interface* Interface)
   }
 }
 
-internal b32 CallMouseExitFunctions(menu_interface* Interface, menu_tree* Menu)
+// Calls the events of the given type on the leafs and all their ancestors
+internal b32 CallMenuEventFunctions(menu_interface* Interface, u32 LeafCount, container_node** Leafs, menu_event_type EventType)
 {
   b32 FunctionCalled = false;
-  for (u32 i = 0; i < Menu->RemovedHotLeafCount; ++i)
+  if(!Interface->EventTypeCounts[(u32) EventType])
+  {
+    return FunctionCalled;
+  }
+
+  for (u32 i = 0; i < LeafCount; ++i)
   {
-    container_node* Node = Menu->RemovedHotLeafs[i];
+    container_node* Node = Leafs[i];
     while(Node)
     {
-      if(HasAttribute(Node,ATTRIBUTE_MENU_EVENT_HANDLE))
+      u32 Link = Node->FirstEvent[(u32) EventType];
+      u32 Generation = Link ? GetMenuEvent(Interface, Link - 1)->Generation : 0;
+      while(Link)
       {
-        menu_event_handle_attribtue* Attr = (menu_event_handle_attribtue*) GetAttributePointer(Node, ATTRIBUTE_MENU_EVENT_HANDLE);
-        for(u32 Idx = 0; Idx < Attr->HandleCount; ++Idx)
+        menu_event* Event = GetMenuEvent(Interface, Link - 1);
+        if(!Event->Active || Event->Generation != Generation)
         {
-          u32 Handle = Attr->Handles[Idx];
-          menu_event* Event =   GetMenuEvent(Interface, Handle);
-          if(Event->EventType == menu_event_type::MouseExit)
-          {
-            FunctionCalled = true;
-            CallFunctionPointer(Event->Callback, Interface, Node, Event->Data);
-          }
+          // Freed by an earlier callback, and maybe reused by another node or event type
+          break;
         }
+        Link = Event->Next;
+        Generation = Link ? GetMenuEvent(Interface, Link - 1)->Generation : 0;
+        FunctionCalled = true;
+        CallFunctionPointer(Event->Callback, Interface, Node, Event->Data);
       }
       Node = Node->Parent;
     }
@@ -1865,129 +2253,230 @@ internal b32 CallMouseExitFunctions(menu_interface* Interface, menu_tree* Menu)
   return FunctionCalled;
 }
 
-internal b32 CallMouseEnterFunctions(menu_interface* Interface, menu_tree* Menu)
+internal void UpdateFocusWindow(menu_interface* Interface)
 {
-  b32 FunctionCalled = false;
-  u32 NewLeafCount = Menu->HotLeafCount - Menu->NewLeafOffset;
-  for (u32 i = Menu->NewLeafOffset; i < NewLeafCount; ++i)
+  if(Interface->MouseLeftButton.Edge)
   {
-    container_node* Node = Menu->HotLeafs[i];
-    while(Node)
+    if(Interface->MouseLeftButton.Active )
     {
-      if(HasAttribute(Node,ATTRIBUTE_MENU_EVENT_HANDLE))
+      menu_tree* MenuFocusWindow = 0;
+      menu_tree* Menu = Interface->MenuSentinel.Next;
+      while(Menu != &Interface->MenuSentinel)
       {
-        menu_event_handle_attribtue* Attr = (menu_event_handle_attribtue*) GetAttributePointer(Node, ATTRIBUTE_MENU_EVENT_HANDLE);
-        for(u32 Idx = 0; Idx < Attr->HandleCount; ++Idx)
+        if(Menu->Visible && Intersects(Menu->Root->Region, Interface->MousePos))
         {
-          u32 Handle = Attr->Handles[Idx];
-          menu_event* Event =   GetMenuEvent(Interface, Handle);
-          if(Event->EventType == menu_event_type::MouseEnter)
-          {
-            FunctionCalled = true;
-            CallFunctionPointer(Event->Callback, Interface, Node, Event->Data);
-          }
+          MenuFocusWindow = Menu;
+          break;
         }
+        Menu = Menu->Next;
       }
-      Node = Node->Parent;
+      SetFocusWindow(Interface, MenuFocusWindow);
     }
   }
-  return FunctionCalled;
 }
 
-internal b32 CallMouseDownFunctions(menu_interface* Interface, menu_tree* Menu)
+internal b32 CallUpdateFunctions(menu_interface* Interface)
 {
   b32 FunctionCalled = false;
-  for (u32 i = 0; i < Menu->HotLeafCount; ++i)
+  // Functions pushed during the loop are called this frame too
+  for (u32 i = 0; i < Interface->UpdateQueueCount; ++i)
   {
-    container_node* Node = Menu->HotLeafs[i];
-    while(Node)
+    update_args* Entry = &Interface->UpdateQueue[i];
+    if(Entry->Function)
     {
-      if(HasAttribute(Node, ATTRIBUTE_MENU_EVENT_HANDLE))
+      FunctionCalled = true;
+      b32 Continue = CallFunctionPointer(Entry->Function, Interface, Entry->Caller, Entry->Data);
+      if(!Continue)
       {
-        menu_event_handle_attribtue* Attr = (menu_event_handle_attribtue*) GetAttributePointer(Node, ATTRIBUTE_MENU_EVENT_HANDLE);
-        for(u32 Idx = 0; Idx < Attr->HandleCount; ++Idx)
-        {
-          u32 Handle = Attr->Handles[Idx];
-          menu_event* Event = GetMenuEvent(Interface, Handle);
-          if(Event->EventType == menu_event_type::MouseDown)
-          {
-            FunctionCalled = true;
-            CallFunctionPointer(Event->Callback, Interface, Node, Event->Data);
-          }
-        }
+        Entry->Function = 0;
       }
-      Node = Node->Parent;
     }
   }
+
+  u32 KeptCount = 0;
+  for (u32 i = 0; i < Interface->UpdateQueueCount; ++i)
+  {
+    if(Interface->UpdateQueue[i].Function)
+    {
+      Interface->UpdateQueue[KeptCount++] = Interface->UpdateQueue[i];
+    }
+  }
+  Interface->UpdateQueueCount = KeptCount;
   return FunctionCalled;
 }
 
-internal b32 CallMouseUpFunctions(menu_interface* Interface, menu_tree* Menu)
+
+inline internal u32
+GetListVisibleRowCount(container_node* ListNode)
 {
-  b32 FunctionCalled = false;
-  for (u32 i = 0; i < Menu->HotLeafCount; ++i)
+  list_node* List = GetListNode(ListNode);
+  u32 Result = (u32) Maximum(0.f, Floor(ListNode->Region.H / List->ItemHeight));
+  return Result;
+}
+
+inline internal u32
+GetListMaxFirstRow(container_node* ListNode)
+{
+  list_node* List = GetListNode(ListNode);
+  u32 RowCount = (List->ItemCount + List->Columns - 1) / List->Columns;
+  u32 VisibleRowCount = GetListVisibleRowCount(ListNode);
+  u32 Result = RowCount > VisibleRowCount ? RowCount - VisibleRowCount : 0;
+  return Result;
+}
+
+// Matches the slot count to the visible rows and rebinds the slots whose item changed.
+// Returns true if the list has to be laid out again.
+internal b32
+BindListItems(menu_interface* Interface, container_node* ListNode)
+{
+  list_node* List = GetListNode(ListNode);
+  List->FirstRow = Minimum(List->FirstRow, GetListMaxFirstRow(ListNode));
+
+  b32 Changed = false;
+  u32 SlotCount = Minimum(GetListVisibleRowCount(ListNode) * List->Columns, List->ItemCount);
+  if(SlotCount != List->SlotCount)
   {
-    container_node* Node = Menu->HotLeafs[i];
-    while(Node)
+    if(SlotCount > List->MaxSlotCount)
     {
-      if(HasAttribute(Node,ATTRIBUTE_MENU_EVENT_HANDLE))
+      if(List->BoundItems)
       {
-        menu_event_handle_attribtue* Attr = (menu_event_handle_attribtue*) GetAttributePointer(Node, ATTRIBUTE_MENU_EVENT_HANDLE);
-        for(u32 Idx = 0; Idx < Attr->HandleCount; ++Idx)
-        {
-          u32 Handle = Attr->Handles[Idx];
-          menu_event* Event = GetMenuEvent(Interface, Handle);
-          if(Event->EventType == menu_event_type::MouseUp)
-          {
-            FunctionCalled = true;
-            CallFunctionPointer(Event->Callback, Interface, Node, Event->Data);
-          }
-        }
+        FreeMemory(&Interface->LinkedMemory, List->BoundItems);
       }
-      Node = Node->Parent;
+      List->MaxSlotCount = Maximum(2 * List->MaxSlotCount, SlotCount);
+      List->BoundItems = (u32*) Allocate(&Interface->LinkedMemory, List->MaxSlotCount * sizeof(u32));
+    }
+
+    for(u32 SlotIndex = List->SlotCount; SlotIndex < SlotCount; ++SlotIndex)
+    {
+      ConnectNodeToBack(ListNode, NewContainer(Interface));
+    }
+    for(u32 SlotIndex = SlotCount; SlotIndex < List->SlotCount; ++SlotIndex)
+    {
+      container_node* LastSlot = ListNode->FirstChild;
+      while(Next(LastSlot))
+      {
+        LastSlot = Next(LastSlot);
+      }
+      DeleteMenuSubTree(Interface, LastSlot);
+    }
+
+    // Item to slot mapping depends on the slot count, everything is rebound
+    for(u32 SlotIndex = 0; SlotIndex < SlotCount; ++SlotIndex)
+    {
+      List->BoundItems[SlotIndex] = LIST_NO_ITEM;
     }
+    List->SlotCount = SlotCount;
+    Changed = true;
   }
-  return FunctionCalled;
-}
 
-internal void UpdateFocusWindow(menu_interface* Interface)
-{
-  if(Interface->MouseLeftButton.Edge)
+  u32 FirstItem = List->FirstRow * List->Columns;
+  container_node* Slot = ListNode->FirstChild;
+  for(u32 SlotIndex = 0; SlotIndex < SlotCount; ++SlotIndex)
   {
-    if(Interface->MouseLeftButton.Active )
+    u32 Item = FirstItem + (SlotIndex + SlotCount - FirstItem % SlotCount) % SlotCount;
+    if(Item >= List->ItemCount)
     {
-      menu_tree* MenuFocusWindow = 0;
-      menu_tree* Menu = Interface->MenuSentinel.Next;
-      while(Menu != &Interface->MenuSentinel)
+      Item = LIST_NO_ITEM;
+    }
+    if(List->BoundItems[SlotIndex] != Item)
+    {
+      DeleteAllAttributes(Interface, Slot);
+      if(Item != LIST_NO_ITEM)
       {
-        if(Menu->Visible && Intersects(Menu->Root->Region, Interface->MousePos))
-        {
-          MenuFocusWindow = Menu;
-          break;
-        }
-        Menu = Menu->Next;
+        CallFunctionPointer(List->FillItem, Interface, Slot, Item, List->Data);
       }
-      SetFocusWindow(Interface, MenuFocusWindow);
+      List->BoundItems[SlotIndex] = Item;
+      Changed = true;
     }
+    Slot = Next(Slot);
+  }
+
+  if(Changed)
+  {
+    MarkLayoutDirty(ListNode->FirstChild ? ListNode->FirstChild : ListNode);
   }
+  return Changed;
 }
 
-internal void CallUpdateFunctions(menu_interface* Interface)
+internal b32
+BindMenuLists(menu_interface* Interface, menu_tree* Menu)
 {
-  for (u32 i = 0; i < ArrayCount(Interface->UpdateQueue); ++i)
+  UpdateTreeOrder(Interface, Menu);
+
+  b32 Result = false;
+  u32 NodeIndex = 0;
+  while(NodeIndex < Menu->NodeCount)
   {
-    update_args* Entry = &Interface->UpdateQueue[i];
-    if(Entry->InUse)
+    container_node* Node = Menu->Nodes[NodeIndex];
+    if(Node->Type == container_type::List)
     {
-      b32 Continue = CallFunctionPointer(Entry->Function, Interface, Entry->Caller, Entry->Data);
-      if(!Continue)
-      {
-        *Entry = {};
-      }
+      Result = BindListItems(Interface, Node) || Result;
+      // The slots may have been deleted, and lists are not nested in slots
+      NodeIndex = Menu->SubTreeEnds[NodeIndex];
+    }else{
+      ++NodeIndex;
     }
   }
+  return Result;
+}
+
+MENU_EVENT_CALLBACK(ListScroll)
+{
+  list_node* List = GetListNode(CallerNode);
+  s32 FirstRow = (s32) List->FirstRow - (s32) (3 * Interface->MouseScroll);
+  FirstRow = Minimum(Maximum(FirstRow, 0), (s32) GetListMaxFirstRow(CallerNode));
+  if((u32) FirstRow != List->FirstRow)
+  {
+    List->FirstRow = (u32) FirstRow;
+    MarkLayoutDirty(CallerNode->FirstChild ? CallerNode->FirstChild : CallerNode);
+  }
+}
+
+container_node* _CreateList(menu_interface* Interface, u32 ItemCount, r32 ItemHeight, u32 Columns, menu_list_item** FillItem, void* Data)
+{
+  Assert(ItemHeight > 0);
+  Assert(Columns > 0);
+  container_node* Result = NewContainer(Interface, container_type::List);
+  list_node* List = GetListNode(Result);
+  List->ItemCount = ItemCount;
+  List->Columns = Columns;
+  List->ItemHeight = ItemHeight;
+  List->FillItem = FillItem;
+  List->Data = Data;
+  RegisterMenuEvent(Interface, menu_event_type::MouseScroll, Result, 0, ListScroll, 0);
+  return Result;
+}
+
+// Also call it when the items changed without the count changing, all slots are filled again
+void SetListItemCount(container_node* ListNode, u32 ItemCount)
+{
+  list_node* List = GetListNode(ListNode);
+  List->ItemCount = ItemCount;
+  for(u32 SlotIndex = 0; SlotIndex < List->SlotCount; ++SlotIndex)
+  {
+    List->BoundItems[SlotIndex] = LIST_NO_ITEM;
+  }
+  MarkLayoutDirty(ListNode->FirstChild ? ListNode->FirstChild : ListNode);
 }
 
+u32 GetListItemAt(container_node* ListNode, v2 Position)
+{
+  list_node* List = GetListNode(ListNode);
+  u32 Result = LIST_NO_ITEM;
+  if(Intersects(ListNode->Region, Position))
+  {
+    r32 Top = ListNode->Region.Y + ListNode->Region.H;
+    u32 Row = (u32) Floor((Top - Position.Y) / List->ItemHeight);
+    u32 Column = (u32) Floor((Position.X - ListNode->Region.X) / (ListNode->Region.W / List->Columns));
+    Column = Minimum(Column, List->Columns - 1);
+    if(Row < GetListVisibleRowCount(ListNode))
+    {
+      u32 Item = (List->FirstRow + Row) * List->Columns + Column;
+      Result = Item < List->ItemCount ? Item : LIST_NO_ITEM;
+    }
+  }
+  return Result;
+}
 
 void UpdateAndRenderMenuInterface(game_input* GameInput, menu_interface* Interface)
 { 
@@ -1999,6 +2488,17 @@ void UpdateAndRenderMenuInterface(game_input* GameInput, menu_interface* Interfa
     return;
   }
 
+  game_window_size WindowSize = GameGetWindowSize();
+  if(WindowSize.WidthPx != Interface->WindowWidthPx || WindowSize.HeightPx != Interface->WindowHeightPx)
+  {
+    Interface->WindowWidthPx = WindowSize.WidthPx;
+    Interface->WindowHeightPx = WindowSize.HeightPx;
+    for(menu_tree* Menu = Interface->MenuSentinel.Next; Menu != &Interface->MenuSentinel; Menu = Menu->Next)
+    {
+      MarkLayoutDirty(Menu->Root);
+    }
+  }
+
   // Updates all the hot leaf struct for the active window windows
   menu_tree* Menu = Interface->MenuSentinel.Next;
   while(Menu != &Interface->MenuSentinel)
@@ -2020,29 +2520,35 @@ void UpdateAndRenderMenuInterface(game_input* GameInput, menu_interface* Interfa
   b32 MouseExitCalled = false;
   b32 MouseDownCalled = false;
   b32 MouseUpCalled = false;
+  b32 MouseScrollCalled = false;
   while(Menu != &Interface->MenuSentinel)
   {
     // If CallMouseEnter/ExitFunctions returns true, it means that a function wass successfully called
     // We only want to call it on the top most window
     if(!MouseExitCalled)
     {
-      MouseExitCalled = CallMouseExitFunctions(Interface, Menu);
+      MouseExitCalled = CallMenuEventFunctions(Interface, Menu->RemovedHotLeafCount, Menu->RemovedHotLeafs, menu_event_type::MouseExit);
     }
     if(!MouseEnterCalled)
     {
-      MouseEnterCalled = CallMouseEnterFunctions(Interface, Menu);
+      MouseEnterCalled = CallMenuEventFunctions(Interface, Menu->HotLeafCount - Menu->NewLeafOffset, Menu->HotLeafs + Menu->NewLeafOffset, menu_event_type::MouseEnter);
     }
 
     if(Menu->Visible)
     {
       if(!MouseDownCalled && Interface->MouseLeftButton.Edge && Interface->MouseLeftButton.Active)
       {
-        MouseDownCalled = CallMouseDownFunctions(Interface, Menu);  
+        MouseDownCalled = CallMenuEventFunctions(Interface, Menu->HotLeafCount, Menu->HotLeafs, menu_event_type::MouseDown);
       }
 
       if(!MouseUpCalled && Interface->MouseLeftButton.Edge && !Interface->MouseLeftButton.Active)
       {
-        MouseUpCalled = CallMouseUpFunctions(Interface, Menu);  
+        MouseUpCalled = CallMenuEventFunctions(Interface, Menu->HotLeafCount, Menu->HotLeafs, menu_event_type::MouseUp);
+      }
+
+      if(!MouseScrollCalled && Interface->MouseScroll != 0)
+      {
+        MouseScrollCalled = CallMenuEventFunctions(Interface, Menu->HotLeafCount, Menu->HotLeafs, menu_event_type::MouseScroll);
       }
 
       if(MouseExitCalled && MouseEnterCalled && MouseUpCalled && MouseDownCalled)
@@ -2053,7 +2559,13 @@ void UpdateAndRenderMenuInterface(game_input* GameInput, menu_interface* Interfa
     Menu = Menu->Next;
   }
 
-  CallUpdateFunctions(Interface);
+  b32 UpdateCalled = CallUpdateFunctions(Interface);
+
+  // Callbacks and drags change colors and merge zones straight through the attributes
+  if(MouseEnterCalled || MouseExitCalled || MouseDownCalled || MouseUpCalled || MouseScrollCalled || UpdateCalled)
+  {
+    InvalidateMenuDrawCaches(Interface);
+  }
 
   if(Interface->MenuVisible)
   {
@@ -2062,9 +2574,16 @@ void UpdateAndRenderMenuInterface(game_input* GameInput, menu_interface* Interfa
     {
       if(Menu->Visible)
       {
-        TreeSensus(Menu);
-        UpdateRegions( Menu );
-        DrawMenu( GlobalGameState->TransientArena, Interface, Menu->NodeCount, Menu->Root);
+        if(UpdateRegions( Interface, Menu ))
+        {
+          // Lists know how many rows fit once they are laid out, rebinding them needs another layout
+          if(BindMenuLists(Interface, Menu))
+          {
+            UpdateRegions( Interface, Menu );
+          }
+          Menu->DrawCache.Valid = false;
+        }
+        DrawMenu( Interface, Menu );
         PushNewRenderLevel(GlobalGameState->RenderCommands->OverlayGroup);
       }
       Menu = Menu->Previous;
@@ -2098,11 +2617,17 @@ menu_interface* CreateMenuInterface(memory_arena* Arena, midx MaxMemSize)
 {
   menu_interface* Interface = PushStruct(Arena, menu_interface);
   Interface->LinkedMemory = NewLinkedMemory(Arena, MaxMemSize);
+  Interface->Arena = Arena;
+  Interface->NodePool = NewChunkList(Arena, sizeof(container_node) + GetMaxContainerPayloadSize(), 256);
+  for(u32 AttributeIndex = 0; AttributeIndex < MENU_ATTRIBUTE_TYPE_COUNT; ++AttributeIndex)
+  {
+    container_attribute Attribute = (container_attribute) (1 << AttributeIndex);
+    Interface->AttributePools[AttributeIndex] = NewChunkList(Arena, GetAttributeSize(Attribute), 128);
+  }
   Interface->BorderSize = 0.007;
   Interface->HeaderSize = 0.02;
   Interface->MinSize = 0.2f; 
   ListInitiate(&Interface->MenuSentinel);
-  ListInitiate(&Interface->EventSentinel);
   return Interface;
 }
 
@@ -2165,6 +2690,7 @@ MENU_EVENT_CALLBACK(DropDownMenuButton)
   menu_tree* Menu = (menu_tree*) Data;
   Menu->Root->Region.X = CallerNode->Region.X;
   Menu->Root->Region.Y = CallerNode->Region.Y - Menu->Root->Region.H;
+  MarkLayoutDirty(Menu->Root);
   SetFocusWindow(Interface, Menu);
 }
 
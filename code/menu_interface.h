@@ -5,9 +5,9 @@
 //       + Highlighta den aktiva tabben
 //       + Möjlighet att spara/ladda fönster-layout (behöver serialiseras på något vis)
 //       + Extrahera interface till en egen mapp där olika "logiska"-element får sin egen fil. En fil för radio-button, en för scroll window etc etc
-//       + ListWidget behöver en scrollfunktion
 
 #include "containers/linked_memory.h"
+#include "font_cache.h"
 
 enum class container_type
 {
@@ -18,7 +18,8 @@ enum class container_type
   Grid,
   Plugin,
   TabWindow,
-  Tab
+  Tab,
+  List
 };
 
 enum container_attribute
@@ -28,8 +29,17 @@ enum container_attribute
   ATTRIBUTE_COLOR = 0x2,
   ATTRIBUTE_TEXT = 0x4,
   ATTRIBUTE_SIZE = 0x8,
-  ATTRIBUTE_MENU_EVENT_HANDLE = 0x10,
-  ATTRIBUTE_TEXTURE = 0x20
+  ATTRIBUTE_TEXTURE = 0x10
+};
+#define MENU_ATTRIBUTE_TYPE_COUNT 5
+
+// Regions are kept between frames, only nodes flagged here are laid out again by UpdateRegions
+enum container_layout_flag
+{
+  LAYOUT_NONE = 0x0,
+  LAYOUT_DIRTY = 0x1,            // The regions of the children have to be recomputed
+  LAYOUT_DIRTY_DESCENDANT = 0x2, // Some node below is dirty
+  LAYOUT_ORDER = 0x4             // Set on the tree root when nodes were added, removed or moved
 };
 
 
@@ -45,6 +55,7 @@ const c8* ToString(container_type Type)
     case container_type::Plugin: return "Plugin";
     case container_type::TabWindow: return "TabWindow";
     case container_type::Tab: return "Tab";
+    case container_type::List: return "List";
   }
   return "";
 };
@@ -57,7 +68,6 @@ const c8* ToString(u32 Type)
     case ATTRIBUTE_COLOR: return "Color";
     case ATTRIBUTE_TEXT: return "Text";
     case ATTRIBUTE_SIZE: return "Size";
-    case ATTRIBUTE_MENU_EVENT_HANDLE: return "Event";
     case ATTRIBUTE_TEXTURE: return "Texture";
   }
   return "";
@@ -76,6 +86,7 @@ void FreeMenuTree(menu_interface* Interface,  menu_tree* MenuToFree);
 container_node* ConnectNodeToFront(container_node* Parent, container_node* NewNode);
 container_node* ConnectNodeToBack(container_node* Parent, container_node* NewNode);
 void DisconnectNode(container_node* Node);
+void MarkLayoutDirty(container_node* Node, b32 OrderChanged = false);
 
 container_node* CreateBorderNode(menu_interface* Interface, b32 Vertical=false, r32 Position = 0.5f,  v4 Color =  V4(0,0,0.4,1));
 
@@ -89,9 +100,18 @@ struct update_args
   menu_interface* Interface;
   container_node* Caller;
   void* Data;
-  b32 InUse;
-  update_function** Function;
+  update_function** Function;   // Cleared when the caller is deleted, the entry is removed after the update
+};
+
+enum class menu_event_type
+{
+  MouseUp,
+  MouseDown,
+  MouseEnter,
+  MouseExit,
+  MouseScroll,
 };
+#define MENU_EVENT_TYPE_COUNT 5
 
 #define MENU_UPDATE_CHILD_REGIONS(name) void name(container_node* Parent)
 typedef MENU_UPDATE_CHILD_REGIONS( menu_get_region );
@@ -110,18 +130,14 @@ struct menu_functions
 
 menu_functions GetMenuFunction(container_type Type);
 
-
-struct menu_attribute_header
-{
-  container_attribute Type;
-  menu_attribute_header* Next;
-};
-
 struct container_node
 {
   container_type Type;
   u32 Attributes;
-  menu_attribute_header* FirstAttribute;
+  u8* AttributeData[MENU_ATTRIBUTE_TYPE_COUNT]; // Indexed by the bit of the attribute, points into the attribute pools
+  u32 LayoutFlags;
+  u32 HotLeafStamp;    // Stamp of the last hot leaf update the node was a hot leaf in
+  u32 FirstEvent[MENU_EVENT_TYPE_COUNT]; // Event slot + 1 per event type, zero if the node has none
 
   // Tree Links (Menu Structure)
   u32 Depth;
@@ -172,6 +188,30 @@ struct tab_node
   container_node* Payload;
 };
 
+// Writes item ItemIndex into a recycled list slot. The slot's attributes are deleted before every
+// binding, so push the ones the item needs. Events belong on the list node, GetListItemAt tells which item was hit.
+// Like the other callbacks it has to be listed in function_pointer_pool.h.
+#define MENU_LIST_ITEM(name) void name(struct menu_interface* Interface, struct container_node* Slot, u32 ItemIndex, void* Data)
+typedef MENU_LIST_ITEM( menu_list_item );
+
+#define LIST_NO_ITEM 0xFFFFFFFF
+
+// Only the fully visible rows have nodes. Item I is always bound to slot I % SlotCount so
+// scrolling one row rebinds only the slots of the rows that came into view.
+struct list_node
+{
+  u32 ItemCount;
+  u32 Columns;
+  r32 ItemHeight;
+  u32 FirstRow;                 // Top visible row
+  menu_list_item** FillItem;
+  void* Data;
+
+  u32 SlotCount;
+  u32 MaxSlotCount;
+  u32* BoundItems;              // Item shown by each slot, LIST_NO_ITEM for slots past the last item
+};
+
 struct plugin_node
 {
   char Title[256];
@@ -229,12 +269,6 @@ enum class menu_region_alignment
   BOT
 };
 
-struct menu_event_handle_attribtue
-{
-  u32 HandleCount;
-  u32 Handles[16]; // Can atm "only" have 16 events per node
-};
-
 enum class menu_size_type
 {
   RELATIVE_,
@@ -271,6 +305,47 @@ typedef MENU_LOSING_FOCUS( menu_losing_focus );
 #define MENU_GAINING_FOCUS(name) void name(struct menu_interface* Interface, struct menu_tree* Menu)
 typedef MENU_GAINING_FOCUS( menu_gaining_focus );
 
+// A run of recorded overlay entries, or a node whose draw function has to run again each frame
+struct menu_draw_command
+{
+  container_node* Node;
+  u32 EntryCount;
+  u32 EntryOffset;
+};
+
+#define MENU_DRAW_CACHE_MAX_SIZE Kilobytes(256) // Trees drawing more than this are drawn from scratch each frame
+
+// What DrawMenu pushed for a tree, replayed while neither the tree nor the font cache changed
+struct menu_draw_cache
+{
+  b32 Valid;
+  u32 FontGeneration;
+  u32 ShelfMask[FONT_CACHE_MAX_PAGE_COUNT];   // Font cache shelves the recorded text was drawn from
+
+  u32 CommandCount;
+  u32 MaxCommandCount;
+  menu_draw_command* Commands;
+
+  u32 EntrySize;
+  u32 MaxEntrySize;
+  u8* Entries;          // Entry type followed by the entry body
+};
+
+#define MENU_HIT_GRID_SIZE 16
+#define MENU_HIT_GRID_MAX_ENTRY_COUNT 65536 // Trees overlapping more cells than this are hit tested by walking the tree
+
+// Coarse grid over the root region. Each cell lists the nodes overlapping it, in the order of
+// menu_tree::Nodes, so a mouse query only tests the nodes in one cell.
+struct menu_hit_grid
+{
+  b32 Valid;               // Cleared when the layout or the node order changes
+  b32 Overflow;            // Too many entries or an empty root, the tree is walked instead
+  rect2f Bounds;
+  u32 CellOffsets[MENU_HIT_GRID_SIZE * MENU_HIT_GRID_SIZE + 1];
+  u32 MaxEntryCount;
+  u32* Entries;            // Indices into menu_tree::Nodes
+};
+
 struct menu_tree
 {
   b32 Visible;
@@ -279,6 +354,17 @@ struct menu_tree
   u32 Depth;
   container_node* Root;
 
+  // Depth first order of the nodes, rebuilt by TreeSensus. Subtrees are contiguous and
+  // SubTreeEnds holds the index one past the last node below each node.
+  u32 MaxNodeCount;
+  container_node** Nodes;
+  u32* SubTreeEnds;
+  u32* ParentIndices;
+  rect2f* Rects;       // Node regions copied when the hit grid is built
+
+  menu_hit_grid HitGrid;
+  u32 HotLeafStamp;    // Stamp of the last hot leaf update of this tree
+
   u32 HotLeafCount;
   u32 NewLeafOffset;  
   container_node* HotLeafs[64];
@@ -290,6 +376,8 @@ struct menu_tree
 
   menu_losing_focus** LosingFocus;
   menu_gaining_focus** GainingFocus;
+
+  menu_draw_cache DrawCache;
 };
 
 MENU_LOSING_FOCUS(DefaultLosingFocus)
@@ -302,25 +390,18 @@ MENU_GAINING_FOCUS(DefaultGainingFocus)
 
 }
 
-enum class menu_event_type
-{
-  MouseUp,
-  MouseDown,
-  MouseEnter,
-  MouseExit,
-};
-
+// Events are referred to by slot so the event array can grow. A node lists its events per type,
+// linked through Next, and freed slots are linked the same way.
 struct menu_event
 {
-  u32 Index;
   b32 Active;
+  u32 Generation;                 // Bumped when the slot is freed, so a link read before a callback can tell if it went stale
   container_node* CallerNode;
   menu_event_type EventType;
   menu_event_callback** Callback;
   menu_event_callback** OnDelete; // Can be used to do cleanup on Data if the node requires it.
   void* Data;
-  menu_event* Next;
-  menu_event* Previous;
+  u32 Next;                       // Slot + 1 of the next event in the list, zero ends it
 };
 
 struct menu_interface
@@ -336,6 +417,9 @@ struct menu_interface
   menu_tree MenuSentinel;
 
   linked_memory LinkedMemory;
+  memory_arena* Arena;
+  chunk_list NodePool;                                    // Node followed by the largest payload
+  chunk_list AttributePools[MENU_ATTRIBUTE_TYPE_COUNT];   // One per attribute type
   //u32 ActiveMemory;
   //u32 MaxMemSize;
   //u8* MemoryBase;
@@ -348,15 +432,26 @@ struct menu_interface
   binary_signal_state TAB;
   v2 MouseLeftButtonPush;
   v2 MouseLeftButtonRelese;
+  r32 MouseScroll;            // Wheel notches this frame, positive away from the user
 
   r32 BorderSize;
   r32 HeaderSize;
   r32 MinSize;
 
-  menu_event EventSentinel;
-  u32 MenuEventCallbackCount;
-  menu_event MenuEventCallbacks[64];
+  // Everything is laid out again when the window changes size
+  r32 WindowWidthPx;
+  r32 WindowHeightPx;
 
+  u32 HotLeafStamp;    // Bumped for every hot leaf update so each update has its own stamp
+
+  u32 EventCount;
+  u32 EventSlotCount;                            // Slots handed out, free or not
+  u32 MaxEventCount;
+  u32 FirstFreeEvent;                            // Slot + 1
+  menu_event* Events;
+  u32 EventTypeCounts[MENU_EVENT_TYPE_COUNT];    // Types nobody listens to are not dispatched
+
+  u32 UpdateQueueCount;
   update_args UpdateQueue[64];
 };
 
@@ -402,6 +497,12 @@ inline tab_node* GetTabNode(container_node* Container)
   tab_node* Result = (tab_node*) GetContainerPayload(Container);
   return Result;
 }
+inline list_node* GetListNode(container_node* Container)
+{
+  Assert(Container->Type == container_type::List);
+  list_node* Result = (list_node*) GetContainerPayload(Container);
+  return Result;
+}
 
 container_node* Next( container_node* Node );
 container_node* Previous( container_node* Node );
@@ -413,6 +514,12 @@ menu_tree* RegisterMenu(menu_interface* Interface, const c8* Name);
 void RegisterWindow(menu_interface* Interface, menu_tree* DropDownMenu, container_node* Plugin);
 void ToggleWindow(menu_interface* Interface, char* WindowName);
 
+container_node* _CreateList(menu_interface* Interface, u32 ItemCount, r32 ItemHeight, u32 Columns, menu_list_item** FillItem, void* Data);
+#define CreateList(Interface, ItemCount, ItemHeight, Columns, FillItem, Data) \
+    _CreateList(Interface, ItemCount, ItemHeight, Columns, DeclareFunction(menu_list_item, FillItem), (void*) Data)
+void SetListItemCount(container_node* ListNode, u32 ItemCount);
+u32 GetListItemAt(container_node* ListNode, v2 Position);
+
 void _RegisterMenuEvent(menu_interface* Interface, menu_event_type EventType, container_node* CallerNode, void* Data, menu_event_callback** Callback,  menu_event_callback** OnDelete);
 #define RegisterMenuEvent(Interface, EventType, CallerNode, Data, Callback, OnDeleteCallback ) \
     _RegisterMenuEvent(Interface, EventType, CallerNode, (void*) Data,                         \
@@ -7,34 +7,173 @@
 #include "breadboard_entity_components.h"
 #include "assets.h"
 
-v4 ParseNumbers(char* String)
+// Powers of ten that are exactly representable as doubles
+global_variable r64 ExactPowersOfTen[23] =
 {
-  char* Start = str::FindFirstNotOf( " \t", String );
-  char WordBuffer[STR_MAX_WORD_LENGTH];
-  s32 CoordinateIdx = 0;
-  v4 Result = V4(0,0,0,1);
-  while( Start )
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Parses a decimal number like "-12.5e-3" starting at *ScanPtr and leaves *ScanPtr after it.
+// Up to 19 significant digits are gathered in an integer and scaled by one exact power of ten,
+// which gives the correctly rounded result as long as the mantissa fits in 53 bits and the
+// exponent is within 22 (Clinger's fast path). That covers every number an exporter writes
+// with float precision. Other numbers are scaled in steps and may be off by an ulp.
+internal r64 ParseReal64(char** ScanPtr, char* End)
+{
+  char* Scan = *ScanPtr;
+  while( (Scan < End) && ((*Scan == ' ') || (*Scan == '\t')) ){ ++Scan; }
+
+  b32 Negative = false;
+  if( (Scan < End) && ((*Scan == '-') || (*Scan == '+')) )
   {
-    Assert(CoordinateIdx < 4);
+    Negative = (*Scan == '-');
+    ++Scan;
+  }
+
+  u64 Mantissa = 0;
+  u32 DigitCount = 0;
+  s32 Exponent = 0;
+  while( (Scan < End) && ((u32)(*Scan - '0') < 10) )
+  {
+    if(DigitCount < 19)
+    {
+      Mantissa = 10*Mantissa + (*Scan - '0');
+      DigitCount += (Mantissa != 0);
+    }else{
+      ++Exponent;
+    }
+    ++Scan;
+  }
 
-    char* End = str::FindFirstOf( " \t", Start);
+  if( (Scan < End) && (*Scan == '.') )
+  {
+    ++Scan;
+    while( (Scan < End) && ((u32)(*Scan - '0') < 10) )
+    {
+      if(DigitCount < 19)
+      {
+        Mantissa = 10*Mantissa + (*Scan - '0');
+        DigitCount += (Mantissa != 0);
+        --Exponent;
+      }
+      ++Scan;
+    }
+  }
 
-    size_t WordLength = ( End ) ? (End - Start) : str::StringLength(Start);
+  if( (Scan < End) && ((*Scan == 'e') || (*Scan == 'E')) )
+  {
+    ++Scan;
+    b32 NegativeExponent = false;
+    if( (Scan < End) && ((*Scan == '-') || (*Scan == '+')) )
+    {
+      NegativeExponent = (*Scan == '-');
+      ++Scan;
+    }
+    s32 ExplicitExponent = 0;
+    while( (Scan < End) && ((u32)(*Scan - '0') < 10) )
+    {
+      if(ExplicitExponent < 10000)
+      {
+        ExplicitExponent = 10*ExplicitExponent + (*Scan - '0');
+      }
+      ++Scan;
+    }
+    Exponent += NegativeExponent ? -ExplicitExponent : ExplicitExponent;
+  }
 
-    Assert(WordLength < STR_MAX_WORD_LENGTH);
+  *ScanPtr = Scan;
 
-    utils::Copy( WordLength, Start, WordBuffer );
-    WordBuffer[WordLength] = '\0';
+  r64 Result = (r64) Mantissa;
+  if( Mantissa != 0 )
+  {
+    if( (Mantissa < (1ull << 53)) && (Exponent >= -22) && (Exponent <= 22) )
+    {
+      Result = (Exponent < 0) ? Result / ExactPowersOfTen[-Exponent] : Result * ExactPowersOfTen[Exponent];
+    }else{
+      while( Exponent > 22 && Result < 1e300 )
+      {
+        Result *= ExactPowersOfTen[22];
+        Exponent -= 22;
+      }
+      while( Exponent < -22 && Result > 1e-300 )
+      {
+        Result /= ExactPowersOfTen[22];
+        Exponent += 22;
+      }
+      if(Exponent > 22 || Exponent < -22)
+      {
+        Result = (Exponent > 0) ? Result * 1e300 : 0;
+      }else{
+        Result = (Exponent < 0) ? Result / ExactPowersOfTen[-Exponent] : Result * ExactPowersOfTen[Exponent];
+      }
+    }
+  }
 
-    r64 value = str::StringToReal64(WordBuffer);
-    Result.E[CoordinateIdx++] = (r32) value;
+  return Negative ? -Result : Result;
+}
 
-    Start = (End) ? str::FindFirstNotOf(" \t", End) : End;
+// Parses an unsigned integer at *ScanPtr and leaves *ScanPtr after it.
+internal u32 ParseU32(char** ScanPtr, char* End)
+{
+  char* Scan = *ScanPtr;
+  u32 Result = 0;
+  while( (Scan < End) && ((u32)(*Scan - '0') < 10) )
+  {
+    Result = 10*Result + (*Scan - '0');
+    ++Scan;
   }
+  *ScanPtr = Scan;
+  return Result;
+}
 
+// Parses up to four space separated numbers in [Scan, End). Missing coordinates default to (0,0,0,1).
+internal v4 ParseNumbers(char* Scan, char* End)
+{
+  v4 Result = V4(0,0,0,1);
+  s32 CoordinateIdx = 0;
+  while( Scan < End )
+  {
+    while( (Scan < End) && ((*Scan == ' ') || (*Scan == '\t')) ){ ++Scan; }
+    if(Scan == End)
+    {
+      break;
+    }
+
+    Assert(CoordinateIdx < 4);
+    char* NumberStart = Scan;
+    Result.E[CoordinateIdx++] = (r32) ParseReal64(&Scan, End);
+    Assert(Scan != NumberStart);
+  }
   return Result;
 }
 
+v4 ParseNumbers(char* String)
+{
+  return ParseNumbers(String, String + str::StringLength(String));
+}
+
+// Returns the first '\n' in [Scan, End), or End. Checks 16 bytes at a time.
+internal char* FindLineEnd(char* Scan, char* End)
+{
+#if COMPILER_MSVC
+  __m128i Newline = _mm_set1_epi8('\n');
+  while( End - Scan >= 16 )
+  {
+    __m128i Chunk = _mm_loadu_si128((__m128i*) Scan);
+    u32 Mask = (u32) _mm_movemask_epi8(_mm_cmpeq_epi8(Chunk, Newline));
+    if(Mask)
+    {
+      bit_scan_result BitScan = FindLeastSignificantSetBit(Mask);
+      return Scan + BitScan.Index;
+    }
+    Scan += 16;
+  }
+#endif
+  while( (Scan < End) && (*Scan != '\n') ){ ++Scan; }
+  return Scan;
+}
+
 struct obj_start_string
 {
   u32 Enum;
@@ -273,44 +412,71 @@ bool GetTrimmedLine( char* SrcLineStart, char* SrcLineEnd, u32* DstLength, char*
   return true;
 }
 
-void TriangulateLine(fifo_queue<u32>* Queue, fifo_queue<u32>* ResultQueue)
+struct obj_line
+{
+  u32 Type;
+  char* Data;   // Statement data with leading whitespace removed
+  char* End;
+};
+
+// Finds the next statement starting at *ScanPtr and advances *ScanPtr to the line after it.
+// Vertex, face and group lines are read in place from the file buffer, the rare ones are copied
+// to LineBuffer and classified by GetOBJDataType.
+internal obj_line NextOBJLine(char** ScanPtr, char* FileEnd, char* LineBuffer)
 {
-  // Triangulate:
-  // We can assume the original .obj file has right handed
-  // orientation to their faecs.
-  //  4--3             3      4--3
-  //  |  | becomes    /|  and | /
-  //  |  |           / |      |/
-  //  1--2          1--2      1
-  //  Make sure they're righthanded
-  if(Queue->GetSize() <= 3)
+  char* Line = *ScanPtr;
+  char* LineEnd = FindLineEnd(Line, FileEnd);
+  *ScanPtr = (LineEnd < FileEnd) ? LineEnd + 1 : FileEnd;
+
+  while( (LineEnd > Line) && (LineEnd[-1] == '\r') ){ --LineEnd; }
+  while( (Line < LineEnd) && ((*Line == ' ') || (*Line == '\t')) ){ ++Line; }
+
+  obj_line Result = {};
+  Result.Type = OBJ_EMPTY;
+  if( (LineEnd - Line < 2) || (*Line == '#') )
   {
-    while(!Queue->IsEmpty())
-    {
-      ResultQueue->Push(Queue->Pop());
-    }
-    return;
+    return Result;
   }
 
-  // Here we assume the Queue Size is greater than three
-  u32 Triangle[3] = {};
-  Triangle[0] = Queue->Pop();
-  Triangle[1] = Queue->Pop();
-  Triangle[2] = Queue->Pop();
-
-  while(true)
+  Result.End = LineEnd;
+  if( (Line[0] == 'v') && ((Line[1] == ' ') || (Line[1] == '\t')) )
   {
-    ResultQueue->Push(Triangle[0]);
-    ResultQueue->Push(Triangle[1]);
-    ResultQueue->Push(Triangle[2]);
-    if(!Queue->IsEmpty())
-    {
-      Triangle[1] = Triangle[2];
-      Triangle[2] = Queue->Pop();
-    }else{
-      return;
-    }
+    Result.Type = OBJ_GEOMETRIC_VERTICES;
+    Result.Data = Line + 2;
+  }else if( (Line[0] == 'v') && (Line[1] == 't') && (LineEnd - Line > 2) && (Line[2] == ' ') ){
+    Result.Type = OBJ_TEXTURE_VERTICES;
+    Result.Data = Line + 3;
+  }else if( (Line[0] == 'v') && (Line[1] == 'n') && (LineEnd - Line > 2) && (Line[2] == ' ') ){
+    Result.Type = OBJ_VERTEX_NORMALS;
+    Result.Data = Line + 3;
+  }else if( (Line[0] == 'f') && ((Line[1] == ' ') || (Line[1] == '\t')) ){
+    Result.Type = OBJ_FACE;
+    Result.Data = Line + 2;
+  }else if( (Line[0] == 'g') && ((Line[1] == ' ') || (Line[1] == '\t')) ){
+    Result.Type = OBJ_GROUP_NAME;
+    Result.Data = Line + 2;
+  }else{
+    u32 Length = (u32) (LineEnd - Line);
+    Assert(Length < STR_MAX_LINE_LENGTH);
+    utils::Copy( Length, Line, LineBuffer );
+    LineBuffer[Length] = '\0';
+
+    type_string_pair DataType = GetOBJDataType( Length, LineBuffer );
+    Result.Type = DataType.Enum;
+    Result.Data = DataType.String;
+    Result.End = DataType.String ? LineBuffer + Length : 0;
+    return Result;
   }
+
+  while( (Result.Data < Result.End) && ((*Result.Data == ' ') || (*Result.Data == '\t')) ){ ++Result.Data; }
+  return Result;
+}
+
+// "g default" does not open a new group, faces keep going to the active one.
+internal b32 IsNewOBJGroup(obj_line* Line)
+{
+  b32 Result = !str::Contains( 7, "default", (u32) (Line->End - Line->Data), Line->Data );
+  return Result;
 }
 
 struct group_to_parse
@@ -318,111 +484,121 @@ struct group_to_parse
   u32 GroupNameLength;
   char* GroupName;
 
-  fifo_queue<u32> vi;
-  fifo_queue<u32> ti;
-  fifo_queue<u32> ni;
-
   u32 MaterialNameLength;
   char* MaterialName;
-};
 
-void ParseFaceLine(memory_arena* Arena, char* ParsedLine, group_to_parse* ActiveGroup )
-{
-  u32 NrVerticesInFace = str::GetWordCount( ParsedLine );
-  Assert( NrVerticesInFace >= 3);
+  // Counted in the first pass
+  u32 IndexCount;
+  b32 HasTextureIndeces;
+  b32 HasNormalIndeces;
 
-  fifo_queue<u32> vi = fifo_queue<u32>(Arena);
-  fifo_queue<u32> ti = fifo_queue<u32>(Arena);
-  fifo_queue<u32> ni = fifo_queue<u32>(Arena);
+  u32* vi;
+  u32* ti;
+  u32* ni;
+};
 
-  char* Start = ParsedLine;
-  char WordBuffer[STR_MAX_WORD_LENGTH];
-  while( Start )
+// Counts the corners of a face line and which index kinds its first corner has.
+// A face specified with ____ looks like: "_____"
+//   1: Vertice, Texture Vertice and Normals: "10/11/12"
+//   2: Only Vertice and Normals:             "10//12"
+//   3: Only Vertice and Texture Vertice:     "10/11"
+//   4: Only Vertice                          "10"
+internal u32 CountFaceCorners(char* Scan, char* End, b32* HasTexture, b32* HasNormal)
+{
+  u32 SlashCount = 0;
+  b32 EmptyTexture = false;
+  char* FirstCornerEnd = Scan;
+  while( (FirstCornerEnd < End) && (*FirstCornerEnd != ' ') && (*FirstCornerEnd != '\t') )
   {
-    char* End = str::FindFirstOf( " \t", Start);
-
-    size_t WordLength = ( End ) ? (End - Start) : str::StringLength(Start);
-
-    Assert(WordLength < STR_MAX_WORD_LENGTH);
+    if(*FirstCornerEnd == '/')
+    {
+      ++SlashCount;
+      EmptyTexture = EmptyTexture || ((SlashCount == 1) && (FirstCornerEnd + 1 < End) && (FirstCornerEnd[1] == '/'));
+    }
+    ++FirstCornerEnd;
+  }
+  *HasTexture = (SlashCount >= 1) && !EmptyTexture;
+  *HasNormal  = (SlashCount == 2);
 
-    utils::Copy( WordLength, Start, WordBuffer );
-    WordBuffer[WordLength] = '\0';
+  u32 CornerCount = 0;
+  b32 InWord = false;
+  while( Scan < End )
+  {
+    b32 IsSpace = (*Scan == ' ') || (*Scan == '\t');
+    CornerCount += (!IsSpace && !InWord);
+    InWord = !IsSpace;
+    ++Scan;
+  }
+  return CornerCount;
+}
 
-    char* StartNr = WordBuffer;
-    char* EndNr   = 0;
-    u32 IndexType = 0;
+// Parses a face line and writes it as a triangle fan starting at Offset in the groups index arrays.
+// Returns the number of indeces written.
+// We can assume the original .obj file has right handed orientation to their faecs.
+//  4--3             3      4--3
+//  |  | becomes    /|  and | /
+//  |  |           / |      |/
+//  1--2          1--2      1
+internal u32 ParseFaceLine(char* Scan, char* End, group_to_parse* Group, u32 Offset)
+{
+  u32 First[3] = {};
+  u32 Previous[3] = {};
+  u32 CornerCount = 0;
+  u32 Written = 0;
+  while( Scan < End )
+  {
+    while( (Scan < End) && ((*Scan == ' ') || (*Scan == '\t')) ){ ++Scan; }
+    if(Scan == End)
+    {
+      break;
+    }
 
-    while(StartNr)
+    u32 Corner[3] = {};
+    Corner[0] = ParseU32(&Scan, End) - 1;
+    if( (Scan < End) && (*Scan == '/') )
     {
-      EndNr   = str::FindFirstOf("/", StartNr);
-      if(EndNr)
+      ++Scan;
+      if( (Scan < End) && (*Scan != '/') )
       {
-        *EndNr++ = '\0';
+        Corner[1] = ParseU32(&Scan, End) - 1;
       }
-
-      u32 Number = (u32) str::StringToReal64(StartNr)-1;
-      Assert(Number>=0);
-      switch(IndexType)
+      if( (Scan < End) && (*Scan == '/') )
       {
-        // Vertex Index
-        case 0:
-        {
-          vi.Push(Number);
-        }break;
-        // Texture Index
-        case 1:
-        {
-          ti.Push(Number);
-        }break;
-        // Normal Index
-        case 2:
-        {
-          ni.Push(Number);
-        }break;
-
-        default:
-        {
-          INVALID_CODE_PATH
-        }break;
+        ++Scan;
+        Corner[2] = ParseU32(&Scan, End) - 1;
       }
+    }
+    Assert( (Scan == End) || (*Scan == ' ') || (*Scan == '\t') );
 
-      // A face specified with ____ looks like: "_____"
-      //   1: Vertice, Texture Vertice and Normals: "10/11/12"
-      //   2: Only Vertice and Normals:             "10//12"
-      //   3: Only Vertice and Texture Vertice:     "10/11"
-      //   4: Only Vertice                          "10"
-      // Case 1, 3 and 4 is handled by just increasing i sequentially.
-      ++IndexType;
-
-      // Case 2 requires us to increase i two steps skipping case IndexType==1.
-      if( EndNr && *EndNr == '/' )
+    if(CornerCount == 0)
+    {
+      CopyArray(3, Corner, First);
+    }else if(CornerCount >= 2){
+      u32 IndexOffset = Offset + Written;
+      Assert(IndexOffset + 3 <= Group->IndexCount);
+      Group->vi[IndexOffset]     = First[0];
+      Group->vi[IndexOffset + 1] = Previous[0];
+      Group->vi[IndexOffset + 2] = Corner[0];
+      if(Group->ti)
       {
-        ++IndexType;
+        Group->ti[IndexOffset]     = First[1];
+        Group->ti[IndexOffset + 1] = Previous[1];
+        Group->ti[IndexOffset + 2] = Corner[1];
       }
-
-      StartNr = str::FindFirstNotOf("/", EndNr);
-
+      if(Group->ni)
+      {
+        Group->ni[IndexOffset]     = First[2];
+        Group->ni[IndexOffset + 1] = Previous[2];
+        Group->ni[IndexOffset + 2] = Corner[2];
+      }
+      Written += 3;
     }
-
-    Start = (End) ? str::FindFirstNotOf(" \t", End) : End;
+    CopyArray(3, Corner, Previous);
+    ++CornerCount;
   }
 
-  // Make sure we have vertex, texture and normal indeces of the right size.
-  Assert( vi.GetSize() == NrVerticesInFace);
-  Assert((ti.GetSize() == NrVerticesInFace) || (ti.GetSize() == 0) );
-  Assert((ni.GetSize() == NrVerticesInFace) || (ni.GetSize() == 0) );
-
-  TriangulateLine(&vi, &ActiveGroup->vi);
-
-  if(!ti.IsEmpty())
-  {
-    TriangulateLine(&ti, &ActiveGroup->ti);
-  }
-
-  if(!ni.IsEmpty())
-  {
-    TriangulateLine(&ni, &ActiveGroup->ni);
-  }
+  Assert(CornerCount >= 3);
+  return Written;
 }
 
 // makes the packing compact
@@ -998,9 +1174,96 @@ void SetBoundingBox( obj_loaded_file* OBJFile, memory_arena* TempArena )
   }
 }
 
-obj_loaded_file* ReadOBJFile(memory_arena* AssetArena, memory_arena* TempArena, char* FileName)
+// Pass two parses a chunk of whole lines. The offsets are where pass one counted the chunk to start
+// so chunks write to disjoint parts of the final arrays and can be parsed in parallel.
+struct obj_parse_chunk
+{
+  char* Begin;
+  char* End;
+
+  u32 VertexOffset;
+  u32 TextureVertexOffset;
+  u32 NormalOffset;
+  u32 GroupIndex;
+  u32 IndexOffset;
+
+  mesh_data* MeshData;
+  group_to_parse* Groups;
+};
+
+#define OBJ_PARSE_CHUNK_SIZE Megabytes(1)
+#define OBJ_MAX_PARSE_CHUNK_COUNT 256
+
+internal void ParseOBJChunk(obj_parse_chunk* Chunk)
+{
+  char LineBuffer[STR_MAX_LINE_LENGTH];
+
+  mesh_data* MeshData = Chunk->MeshData;
+  u32 VertexIndex = Chunk->VertexOffset;
+  u32 TextureVertexIndex = Chunk->TextureVertexOffset;
+  u32 NormalIndex = Chunk->NormalOffset;
+  group_to_parse* Group = Chunk->Groups + Chunk->GroupIndex;
+  u32 IndexOffset = Chunk->IndexOffset;
+
+  char* ScanPtr = Chunk->Begin;
+  while( ScanPtr < Chunk->End )
+  {
+    obj_line Line = NextOBJLine(&ScanPtr, Chunk->End, LineBuffer);
+    switch( Line.Type )
+    {
+      // Vertices: v x y z
+      case obj_data_types::OBJ_GEOMETRIC_VERTICES:
+      {
+        Assert(VertexIndex < MeshData->nv);
+        MeshData->v[VertexIndex++] = V3(ParseNumbers(Line.Data, Line.End));
+      }break;
+
+      // Vertex Normals: vn i j k
+      case obj_data_types::OBJ_VERTEX_NORMALS:
+      {
+        Assert(NormalIndex < MeshData->nvn);
+        MeshData->vn[NormalIndex++] = V3(ParseNumbers(Line.Data, Line.End));
+      }break;
+
+      // Vertex Textures: vt u v
+      case obj_data_types::OBJ_TEXTURE_VERTICES:
+      {
+        Assert(TextureVertexIndex < MeshData->nvt);
+        MeshData->vt[TextureVertexIndex++] = V2(ParseNumbers(Line.Data, Line.End));
+      }break;
+
+      // Faces: f v1[/vt1][/vn1] v2[/vt2][/vn2] v3[/vt3][/vn3] ...
+      case obj_data_types::OBJ_FACE:
+      {
+        // The default group is dropped if the file has named groups
+        if(Group->vi)
+        {
+          IndexOffset += ParseFaceLine(Line.Data, Line.End, Group, IndexOffset);
+        }
+      }break;
+
+      case obj_data_types::OBJ_GROUP_NAME:
+      {
+        if(IsNewOBJGroup(&Line))
+        {
+          ++Group;
+          IndexOffset = 0;
+        }
+      }break;
+    }
+  }
+}
+
+PLATFORM_WORK_QUEUE_CALLBACK(ParseOBJChunkWork)
 {
+  ParseOBJChunk((obj_parse_chunk*) Data);
+}
 
+// Reads the file in two passes over the file buffer. The first pass counts vertices, groups and
+// triangulated indeces and handles the rare statements. The final arrays are then allocated once and
+// the second pass parses numbers straight into them.
+obj_loaded_file* ReadOBJFile(memory_arena* AssetArena, memory_arena* TempArena, char* FileName)
+{
   thread_context Thread{};
   debug_read_file_result ReadResult = Platform.DEBUGPlatformReadEntireFile(&Thread, FileName);
 
@@ -1010,90 +1273,78 @@ obj_loaded_file* ReadOBJFile(memory_arena* AssetArena, memory_arena* TempArena,
 
   temporary_memory TempMem = BeginTemporaryMemory(TempArena);
 
+  char* FileBegin = ( char* ) ReadResult.Contents;
+  char* FileEnd =  FileBegin + ReadResult.ContentSize;
 
-  fifo_queue<group_to_parse*> GroupToParse = fifo_queue<group_to_parse*>(TempArena);
-  group_to_parse* DefaultGroup = (group_to_parse*) PushStruct(TempArena, group_to_parse);
-  DefaultGroup->vi = fifo_queue<u32>(TempArena);
-  DefaultGroup->ti = fifo_queue<u32>(TempArena);
-  DefaultGroup->ni = fifo_queue<u32>(TempArena);
+  // Many small chunks only add overhead and the work queue has a limited size
+  midx ChunkSize = Maximum( (midx) OBJ_PARSE_CHUNK_SIZE, ReadResult.ContentSize / OBJ_MAX_PARSE_CHUNK_COUNT + 1 );
 
-  group_to_parse* ActiveGroup = DefaultGroup;
+  fifo_queue<group_to_parse*> GroupQueue = fifo_queue<group_to_parse*>(TempArena);
+  fifo_queue<obj_parse_chunk*> ChunkQueue = fifo_queue<obj_parse_chunk*>(TempArena);
 
-  fifo_queue<v3> VerticeBuffer    = fifo_queue<v3>( TempArena );
-  fifo_queue<v3> VerticeNormalBuffer  = fifo_queue<v3>( TempArena );
-  fifo_queue<v2> TextureVerticeBuffer = fifo_queue<v2>( TempArena );
+  group_to_parse* ActiveGroup = (group_to_parse*) PushStruct(TempArena, group_to_parse);
+  GroupQueue.Push(ActiveGroup);
 
-  obj_mtl_data* MaterialFile = 0;
+  obj_parse_chunk* ActiveChunk = (obj_parse_chunk*) PushStruct(TempArena, obj_parse_chunk);
+  ActiveChunk->Begin = FileBegin;
+  ChunkQueue.Push(ActiveChunk);
 
-  char* ScanPtr = ( char* ) ReadResult.Contents;
-  char* FileEnd =  ( char* ) ReadResult.Contents + ReadResult.ContentSize;
+  u32 VertexCount = 0;
+  u32 TextureVertexCount = 0;
+  u32 NormalCount = 0;
+  obj_mtl_data* MaterialFile = 0;
 
+  char* ScanPtr = FileBegin;
   while( ScanPtr < FileEnd )
   {
-    char* ThisLine = ScanPtr;
-    ScanPtr = str::FindFirstOf('\n', ThisLine);
-    ScanPtr = (ScanPtr) ? (ScanPtr + 1) : FileEnd;
-
-    u32 Length = 0;
-    if( !GetTrimmedLine( ThisLine, ScanPtr, &Length, LineBuffer ))
+    if( (midx) (ScanPtr - ActiveChunk->Begin) >= ChunkSize )
     {
-      continue;
+      ActiveChunk->End = ScanPtr;
+      ActiveChunk = (obj_parse_chunk*) PushStruct(TempArena, obj_parse_chunk);
+      ActiveChunk->Begin = ScanPtr;
+      ActiveChunk->VertexOffset = VertexCount;
+      ActiveChunk->TextureVertexOffset = TextureVertexCount;
+      ActiveChunk->NormalOffset = NormalCount;
+      ActiveChunk->GroupIndex = GroupQueue.GetSize() - 1;
+      ActiveChunk->IndexOffset = ActiveGroup->IndexCount;
+      ChunkQueue.Push(ActiveChunk);
     }
 
-    type_string_pair DataType = GetOBJDataType( Length, LineBuffer );
-
-    switch( DataType.Enum )
+    obj_line Line = NextOBJLine(&ScanPtr, FileEnd, LineBuffer);
+    switch( Line.Type )
     {
       case obj_data_types::OBJ_EMPTY:
       {
         continue;
       }break;
 
-      // Vertices: v x y z
-      case obj_data_types::OBJ_GEOMETRIC_VERTICES:
-      {
-        v3 Vert = V3(ParseNumbers(DataType.String));
-        VerticeBuffer.Push(Vert);
-
-      }break;
-
-      // Vertex Normals: vn i j k
-      case obj_data_types::OBJ_VERTEX_NORMALS:
-      {
-        v3 VertNorm = V3(ParseNumbers(DataType.String));
-        VerticeNormalBuffer.Push(VertNorm);
-      }break;
-
-      // Vertex Textures: vt u v
-      case obj_data_types::OBJ_TEXTURE_VERTICES:
-      {
-        v2 TextureVertice = V2( ParseNumbers(DataType.String) );
-        TextureVerticeBuffer.Push( TextureVertice );
-      }break;
+      case obj_data_types::OBJ_GEOMETRIC_VERTICES: { ++VertexCount;        }break;
+      case obj_data_types::OBJ_VERTEX_NORMALS:     { ++NormalCount;        }break;
+      case obj_data_types::OBJ_TEXTURE_VERTICES:   { ++TextureVertexCount; }break;
 
-      // Faces: f v1[/vt1][/vn1] v2[/vt2][/vn2] v3[/vt3][/vn3] ...
       case obj_data_types::OBJ_FACE:
       {
-        ParseFaceLine( TempArena, DataType.String, ActiveGroup );
+        b32 HasTexture = false;
+        b32 HasNormal  = false;
+        u32 CornerCount = CountFaceCorners(Line.Data, Line.End, &HasTexture, &HasNormal);
+        Assert(CornerCount >= 3);
+        Assert( (ActiveGroup->IndexCount == 0) ||
+               ((ActiveGroup->HasTextureIndeces == HasTexture) && (ActiveGroup->HasNormalIndeces == HasNormal)) );
+        ActiveGroup->HasTextureIndeces = HasTexture;
+        ActiveGroup->HasNormalIndeces  = HasNormal;
+        ActiveGroup->IndexCount += 3 * (CornerCount - 2);
       }break;
 
       // Group: name1 name2 ....
       case obj_data_types::OBJ_GROUP_NAME:
       {
-        u32 ObjectNameLength = str::StringLength( DataType.String );
-        if( !str::Contains(7, "default", ObjectNameLength, DataType.String ) )
+        if( IsNewOBJGroup(&Line) )
         {
+          u32 ObjectNameLength = (u32) (Line.End - Line.Data);
           ActiveGroup = (group_to_parse*) PushStruct(TempArena, group_to_parse);
-
           ActiveGroup->GroupNameLength = ObjectNameLength;
-          ActiveGroup->GroupName = (char*) PushArray(TempArena, ObjectNameLength+1, char );
-          str::CopyStrings(ObjectNameLength,  DataType.String, ObjectNameLength, ActiveGroup->GroupName );
-
-          ActiveGroup->vi = fifo_queue<u32>(TempArena);
-          ActiveGroup->ti = fifo_queue<u32>(TempArena);
-          ActiveGroup->ni = fifo_queue<u32>(TempArena);
-
-          GroupToParse.Push( ActiveGroup );
+          ActiveGroup->GroupName = Line.Data;
+          GroupQueue.Push( ActiveGroup );
         }
       }break;
 
@@ -1101,29 +1352,25 @@ obj_loaded_file* ReadOBJFile(memory_arena* AssetArena, memory_arena* TempArena,
       {
         char MTLFileName[STR_MAX_LINE_LENGTH] = {};
 
-        CreateNewFilePath( FileName, DataType.String, sizeof(MTLFileName), MTLFileName );
+        CreateNewFilePath( FileName, Line.Data, sizeof(MTLFileName), MTLFileName );
 
         if(!MaterialFile)
         {
           // Stores materials to Asset Arena
           MaterialFile =  ReadMTLFile(AssetArena, TempArena, MTLFileName);
         }
-
-
       } break;
       case obj_data_types::OBJ_OBJECT_NAME:
       {
         // Unimplemented
-        char* kek = DataType.String;
       } break;
       case obj_data_types::OBJ_MATERIAL_NAME:
       {
-        u32 MaterialNameLength = str::StringLength( DataType.String );
+        u32 MaterialNameLength = str::StringLength( Line.Data );
 
         ActiveGroup->MaterialNameLength = MaterialNameLength;
         ActiveGroup->MaterialName = (char*) PushArray(TempArena, MaterialNameLength+1, char );
-        str::CopyStrings(MaterialNameLength,  DataType.String, MaterialNameLength, ActiveGroup->MaterialName );
-
+        str::CopyStrings(MaterialNameLength,  Line.Data, MaterialNameLength, ActiveGroup->MaterialName );
       } break;
       case obj_data_types::OBJ_SMOOTHING_GROUP:
       {
@@ -1133,59 +1380,67 @@ obj_loaded_file* ReadOBJFile(memory_arena* AssetArena, memory_arena* TempArena,
       default:
       {
         Assert(0);
-
       } break;
     }
-
-  }
-
-  if(ActiveGroup == DefaultGroup)
-  {
-    GroupToParse.Push( DefaultGroup );
   }
-
-  Platform.DEBUGPlatformFreeFileMemory(&Thread, ReadResult.Contents);
+  ActiveChunk->End = FileEnd;
 
   obj_loaded_file* Result = (obj_loaded_file*) PushStruct( AssetArena, obj_loaded_file );
 
   mesh_data* MeshData = (mesh_data*) PushStruct( AssetArena, mesh_data );
-
-  MeshData->nv = VerticeBuffer.GetSize();
-  MeshData->v = (v3*) PushArray(AssetArena, MeshData->nv, v3);
-  for( u32 Index = 0; Index < MeshData->nv; ++Index )
+  MeshData->nv  = VertexCount;
+  MeshData->v   = (v3*) PushArray(AssetArena, MeshData->nv, v3, NoClear());
+  MeshData->nvn = NormalCount;
+  MeshData->vn  = (v3*) PushArray(AssetArena, MeshData->nvn, v3, NoClear());
+  MeshData->nvt = TextureVertexCount;
+  MeshData->vt  = (v2*) PushArray(AssetArena, MeshData->nvt, v2, NoClear());
+
+  // Faces before the first named group are dropped if there are named groups
+  u32 GroupCount = GroupQueue.GetSize();
+  u32 FirstGroup = (GroupCount > 1) ? 1 : 0;
+  group_to_parse* Groups = (group_to_parse*) PushArray(TempArena, GroupCount, group_to_parse);
+  for( u32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex )
   {
-    MeshData->v[Index] = VerticeBuffer.Pop();
+    group_to_parse* Group = Groups + GroupIndex;
+    *Group = *GroupQueue.Pop();
+    if(GroupIndex >= FirstGroup)
+    {
+      Group->vi = (u32*) PushArray( AssetArena, Group->IndexCount, u32, NoClear() );
+      Group->ti = Group->HasTextureIndeces ? (u32*) PushArray( AssetArena, Group->IndexCount, u32, NoClear() ) : 0;
+      Group->ni = Group->HasNormalIndeces  ? (u32*) PushArray( AssetArena, Group->IndexCount, u32, NoClear() ) : 0;
+    }
   }
-  Assert(VerticeBuffer.IsEmpty());
-
 
-  MeshData->nvn = VerticeNormalBuffer.GetSize();
-  MeshData->vn = (v3*) PushArray(AssetArena, MeshData->nvn, v3);
-  for( u32 Index = 0; Index < MeshData->nvn; ++Index )
+  u32 ChunkCount = ChunkQueue.GetSize();
+  obj_parse_chunk* Chunks = (obj_parse_chunk*) PushArray(TempArena, ChunkCount, obj_parse_chunk);
+  for( u32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex )
   {
-    MeshData->vn[Index] = VerticeNormalBuffer.Pop();
+    obj_parse_chunk* Chunk = Chunks + ChunkIndex;
+    *Chunk = *ChunkQueue.Pop();
+    Chunk->MeshData = MeshData;
+    Chunk->Groups = Groups;
   }
-  Assert(VerticeNormalBuffer.IsEmpty());
 
-
-  MeshData->nvt = TextureVerticeBuffer.GetSize();
-  MeshData->vt = (v2*) PushArray(AssetArena, MeshData->nvt, v2);
-  for( u32 Index = 0; Index < MeshData->nvt; ++Index )
+  if(ChunkCount == 1)
   {
-    MeshData->vt[Index] = TextureVerticeBuffer.Pop();
+    ParseOBJChunk(Chunks);
+  }else{
+    for( u32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex )
+    {
+      Platform.PlatformAddEntry(Platform.HighPriorityQueue, ParseOBJChunkWork, Chunks + ChunkIndex);
+    }
+    Platform.PlatformCompleteWorkQueue(Platform.HighPriorityQueue);
   }
-  Assert(TextureVerticeBuffer.IsEmpty());
 
-
-  Result->ObjectCount = GroupToParse.GetSize();
+  Result->ObjectCount = GroupCount - FirstGroup;
   Result->Objects = (obj_group*) PushArray(AssetArena, Result->ObjectCount, obj_group);
   Result->MeshData    = MeshData;
   Result->MaterialData = MaterialFile;
 
-  obj_group* NewGroup = Result->Objects;
-  while( !GroupToParse.IsEmpty() )
+  for( u32 GroupIndex = FirstGroup; GroupIndex < GroupCount; ++GroupIndex )
   {
-    group_to_parse* ParsedGroup = GroupToParse.Pop();
+    group_to_parse* ParsedGroup = Groups + GroupIndex;
+    obj_group* NewGroup = Result->Objects + (GroupIndex - FirstGroup);
 
     NewGroup->GroupNameLength = ParsedGroup->GroupNameLength;
     NewGroup->GroupName = (char*) PushArray( AssetArena, ParsedGroup->GroupNameLength+1, char );
@@ -1200,45 +1455,21 @@ obj_loaded_file* ReadOBJFile(memory_arena* AssetArena, memory_arena* TempArena,
         {
           NewGroup->Material = mtl;
         }
-
       }
     }
 
     mesh_indeces* Indeces = NewGroup->Indeces;
-    Indeces->Count = ParsedGroup->vi.GetSize();
-
-    Indeces->vi    = (u32*) PushArray( AssetArena, Indeces->Count, u32 );
-    for( u32 i = 0; i < Indeces->Count; ++i )
-    {
-      Indeces->vi[i] = ParsedGroup->vi.Pop();
-    }
-
-    if(ParsedGroup->ti.GetSize())
-    {
-      Indeces->ti    = (u32*) PushArray( AssetArena, Indeces->Count, u32 );
-      for( u32 i = 0; i < Indeces->Count; ++i )
-      {
-        Indeces->ti[i] = ParsedGroup->ti.Pop();
-      }
-    }
-
-    if(ParsedGroup->ni.GetSize())
-    {
-      Indeces->ni    = (u32*) PushArray( AssetArena, Indeces->Count, u32 );
-      for( u32 i = 0; i < Indeces->Count; ++i )
-      {
-        Indeces->ni[i] = ParsedGroup->ni.Pop();
-      }
-    }
-
-    NewGroup++;
+    Indeces->Count = ParsedGroup->IndexCount;
+    Indeces->vi = ParsedGroup->vi;
+    Indeces->ti = ParsedGroup->ti;
+    Indeces->ni = ParsedGroup->ni;
   }
 
-  Assert( GroupToParse.IsEmpty() );
+  Platform.DEBUGPlatformFreeFileMemory(&Thread, ReadResult.Contents);
+
   SetBoundingBox(Result, TempArena);
 
   EndTemporaryMemory(TempMem);
 
   return Result;
 }
-
@@ -53,6 +53,11 @@ inline void* AtomicExchangePointer(void** volatile Target, void* New)
   void* Result = _InterlockedExchangePointer(Target,New);
   return Result;
 }
+inline void* AtomicCompareExchangePointer(void* volatile* Target, void* New, void* Expected)
+{
+  void* Result = _InterlockedCompareExchangePointer(Target, New, Expected);
+  return Result;
+}
 inline u32 AtomicCompareExchange(u32 volatile* Value, u32 New, u32 Expected)
 {
   u32 Result = _InterlockedCompareExchange((long volatile *)Value, New, Expected);
@@ -83,6 +88,8 @@ inline u32 AtomicAddu32( u32 volatile* Value, u32 Added)
   u32 Result = _InterlockedExchangeAdd( (long volatile *)Value, Added);
   return(Result);
 }
+// Only stops the compiler from moving memory accesses across it, the cpu may still do it
+#define CompilerBarrier() _ReadWriteBarrier()
 #elif COMPILER_LLVM
 
 #endif
@@ -106,6 +113,14 @@ struct debug_read_file_result
   void* Contents;
 };
 
+// Copy on write view of a whole file. Pages are read in from the file when first touched.
+struct debug_mapped_file
+{
+  u64 ContentSize;
+  void* Contents;
+  u64 OSHandle;
+};
+
 struct debug_process_state
 {
   b32 StartedSuccessfully;
@@ -124,6 +139,16 @@ typedef DEBUG_PLATFORM_FREE_FILE_MEMORY( debug_platfrom_free_file_memory );
 #define DEBUG_PLATFORM_READ_ENTIRE_FILE(name) debug_read_file_result name( thread_context* Thread, c8* Filename )
 typedef DEBUG_PLATFORM_READ_ENTIRE_FILE( debug_platform_read_entire_file );
 
+#define DEBUG_PLATFORM_MAP_FILE(name) debug_mapped_file name( thread_context* Thread, c8* Filename )
+typedef DEBUG_PLATFORM_MAP_FILE( debug_platform_map_file );
+
+#define DEBUG_PLATFORM_UNMAP_FILE(name) void name( thread_context* Thread, debug_mapped_file* File )
+typedef DEBUG_PLATFORM_UNMAP_FILE( debug_platform_unmap_file );
+
+// Last write time of the file in platform units, zero if it doesn't exist
+#define DEBUG_PLATFORM_GET_FILE_WRITE_TIME(name) u64 name( c8* Filename )
+typedef DEBUG_PLATFORM_GET_FILE_WRITE_TIME( debug_platform_get_file_write_time );
+
 #define DEBUG_PLATFORM_WRITE_ENTIRE_FILE(name) b32 name( thread_context* Thread, c8* Filename, u32 MemorySize, void* Memory )
 typedef DEBUG_PLATFORM_WRITE_ENTIRE_FILE( debug_platform_write_entire_file );
 
@@ -142,6 +167,11 @@ typedef DEBUG_PLATFORM_FORMAT_STRING(debug_platform_format_string);
 #define DEBUG_PLATFORM_PRINT(name) void name(const c8* DebugString, ...)
 typedef DEBUG_PLATFORM_PRINT(debug_platform_print);
 
+// Drains the store buffers of every cpu running the process, a full memory barrier on all of
+// them at once. Lets a rarely run reader pair with writers that only use compiler barriers.
+#define DEBUG_PLATFORM_FLUSH_WRITE_BUFFERS(name) void name()
+typedef DEBUG_PLATFORM_FLUSH_WRITE_BUFFERS(debug_platform_flush_write_buffers);
+
 
 #endif // HANDMADE_INTERNAL
 
@@ -168,12 +198,17 @@ SafeTruncateReal32( u32 Value )
   NOTE: Services that the game provides to the platform layer.
 */
 
+enum debug_record_flag
+{
+  DebugRecordFlag_Counters = 0x1, // Events of the record also sample the performance counters
+};
+
 struct debug_record
 {
   char* FileName;
   char* BlockName;
   u32 LineNumber;
-  u32 Reserved;
+  u32 Flags;
 };
 
 enum debug_event_type
@@ -183,10 +218,10 @@ enum debug_event_type
   DebugEvent_EndBlock,
 };
 
-struct threadid_coreindex
+struct threadid_countersample
 {
   u16 ThreadID;
-  u16 CoreIndex;
+  u16 CounterSample;  // One past the index of the thread's counter sample, zero if the event has none
 };
 
 struct debug_event
@@ -194,7 +229,7 @@ struct debug_event
   u64 Clock;
   union
   {
-    threadid_coreindex TC;
+    threadid_countersample TC;
     r32 SecondsElapsed;
   };
   u16 DebugRecordIndex;
@@ -204,46 +239,179 @@ struct debug_event
 
 #define MAX_DEBUG_EVENT_ARRAY_COUNT 2    // How many frames we are tracking
 #define MAX_DEBUG_TRANSLATION_UNITS (2)  // How many translation units we have
-#define MAX_DEBUG_EVENT_COUNT (8*65536)
+#define MAX_DEBUG_THREAD_COUNT 6         // How many threads can record events, the main thread and the five workers
+#define MAX_DEBUG_EVENT_COUNT (16*65536)   // Events per frame, shared by all threads
+#define DEBUG_EVENT_CHUNK_SIZE 4096        // Threads take events from the shared array in chunks this big
+#define DEBUG_EVENT_CHUNK_COUNT (MAX_DEBUG_EVENT_COUNT / DEBUG_EVENT_CHUNK_SIZE)
 #define MAX_DEBUG_RECORD_COUNT (65536)
+#define MAX_DEBUG_COUNTER_SAMPLE_COUNT (4096) // Per thread and frame
+
+// Performance counters read by the platform: thread cycles, then retired instructions and core cycles.
+// The last two need rdpmc from user mode, which only works when the os sets CR4.PCE. The platform
+// probes for it at startup, DEBUGPerformanceCounterCount says how many of the counters are read.
+#define DEBUG_COUNTER_COUNT 3
+struct debug_counter_sample
+{
+  u64 Values[DEBUG_COUNTER_COUNT];
+};
+
+#define DEBUG_PLATFORM_READ_PERFORMANCE_COUNTERS(name) void name(debug_counter_sample* Sample)
+typedef DEBUG_PLATFORM_READ_PERFORMANCE_COUNTERS(debug_platform_read_performance_counters);
+
+// Events recorded by one thread. Only the owning thread writes events and advances EventCount of
+// the current event array, so recording needs no atomics and every thread stays on its own cache lines.
+// The events live in chunks of the table's event array, a thread only takes a new chunk when its last
+// one is full. That keeps the main thread able to use most of the array while the workers record little.
+struct alignas(64) debug_thread_events
+{
+  u32 volatile ThreadID;                                  // Zero while the slot is unclaimed
+  u32 volatile Writing;                                   // Set while the owning thread is in the middle of an event
+  u32 volatile EventCount[MAX_DEBUG_EVENT_ARRAY_COUNT];   // Write cursor into each event array
+  u32 volatile CounterSampleCount[MAX_DEBUG_EVENT_ARRAY_COUNT];
+  u32 volatile DroppedEventCount[MAX_DEBUG_EVENT_ARRAY_COUNT];   // Events that did not fit, they are written to DroppedEvent
+  debug_event DroppedEvent;
+  u16 Chunks[MAX_DEBUG_EVENT_ARRAY_COUNT][DEBUG_EVENT_CHUNK_COUNT]; // Chunk of the event array holding each run of DEBUG_EVENT_CHUNK_SIZE events
+  debug_counter_sample CounterSamples[MAX_DEBUG_EVENT_ARRAY_COUNT][MAX_DEBUG_COUNTER_SAMPLE_COUNT];
+};
 
 struct debug_table
 {
-  // TODO: Were never ensure that writes to the debugevents is complete
-  //       before we swap them
-  u64 volatile EventArrayIndex_EventIndex;    // Two numbers stored in one u64.
-                                              // The high bits "EventArrayIndex" indexes into a frame [0, MAX_DEBUG_EVENT_ARRAY_COUNT]
-                                              // The low bits "EventIndex" says how many events were recorded in that frame, [0,MAX_DEBUG_EVENT_COUNT]
-  u32 CurrentEventArrayIndex;                 // Keep track on which event array we are writing to.
+  u32 volatile CurrentEventArrayIndex;        // Which event array threads are writing to, swapped at the end of each frame
+  debug_platform_read_performance_counters* ReadPerformanceCounters; // Set by the platform, used by records flagged with DebugRecordFlag_Counters
 
   // These are tracked on a per-translation-unit basis
   u32 RecordCount[MAX_DEBUG_TRANSLATION_UNITS];                              // How tracked functions records exist per translation unit
   debug_record Records[MAX_DEBUG_TRANSLATION_UNITS][MAX_DEBUG_RECORD_COUNT]; // Each tracked function or block has an entry here
 
   // These are tracked on a per-frame basis
-  u32 EventCount[MAX_DEBUG_EVENT_ARRAY_COUNT];                               // How many events exists per frame
+  u32 EventCount[MAX_DEBUG_EVENT_ARRAY_COUNT][MAX_DEBUG_THREAD_COUNT];       // How many events each thread wrote to a finished frame
+  u32 DroppedEventCount[MAX_DEBUG_EVENT_ARRAY_COUNT];                        // How many events all threads dropped in a finished frame
+  debug_thread_events Threads[MAX_DEBUG_THREAD_COUNT];
+  u32 volatile EventChunkCount[MAX_DEBUG_EVENT_ARRAY_COUNT];                 // Chunks handed out from each event array
   debug_event Events[MAX_DEBUG_EVENT_ARRAY_COUNT][MAX_DEBUG_EVENT_COUNT];    // Here are actual instances of debug-functions.
 };
 
+inline debug_event*
+GetDebugEvent(debug_table* Table, debug_thread_events* ThreadEvents, u32 ArrayIndex, u32 EventIndex)
+{
+  u32 Chunk = ThreadEvents->Chunks[ArrayIndex][EventIndex / DEBUG_EVENT_CHUNK_SIZE];
+  debug_event* Result = Table->Events[ArrayIndex] + Chunk * DEBUG_EVENT_CHUNK_SIZE + EventIndex % DEBUG_EVENT_CHUNK_SIZE;
+  return Result;
+}
+
+// Returns the slot for event EventIndex of the thread and advances EventIndex. When the thread's
+// chunk is full and the event array has no chunks left the event goes to DroppedEvent and is only counted.
+inline debug_event*
+PushDebugEvent(debug_table* Table, debug_thread_events* ThreadEvents, u32 ArrayIndex, u32* EventIndex)
+{
+  u32 Index = *EventIndex;
+  if(Index % DEBUG_EVENT_CHUNK_SIZE == 0)
+  {
+    u32 Chunk = DEBUG_EVENT_CHUNK_COUNT;
+    if(Table->EventChunkCount[ArrayIndex] < DEBUG_EVENT_CHUNK_COUNT)
+    {
+      Chunk = AtomicAddu32(&Table->EventChunkCount[ArrayIndex], 1);
+    }
+    if(Chunk >= DEBUG_EVENT_CHUNK_COUNT)
+    {
+      ++ThreadEvents->DroppedEventCount[ArrayIndex];
+      return &ThreadEvents->DroppedEvent;
+    }
+    ThreadEvents->Chunks[ArrayIndex][Index / DEBUG_EVENT_CHUNK_SIZE] = (u16) Chunk;
+  }
+  *EventIndex = Index + 1;
+  debug_event* Result = GetDebugEvent(Table, ThreadEvents, ArrayIndex, Index);
+  return Result;
+}
+
 extern debug_table* GlobalDebugTable;
 
 #if HANDMADE_PROFILE
 
+// Each module caches the slot of every thread that records into it
+global_variable thread_local debug_table* ThreadDebugTable;
+global_variable thread_local debug_thread_events* ThreadDebugEvents;
+
+// Slow path, runs the first time a thread records an event into a table
+inline debug_thread_events*
+ClaimDebugThreadEvents(debug_table* Table, u32 ThreadID)
+{
+  debug_thread_events* Result = 0;
+  for(u32 SlotIndex = 0; SlotIndex < MAX_DEBUG_THREAD_COUNT && !Result; ++SlotIndex)
+  {
+    debug_thread_events* Slot = Table->Threads + SlotIndex;
+    u32 SlotThreadID = Slot->ThreadID;
+    if(!SlotThreadID)
+    {
+      SlotThreadID = AtomicCompareExchange(&Slot->ThreadID, ThreadID, 0);
+      if(!SlotThreadID)
+      {
+        SlotThreadID = ThreadID;
+      }
+    }
+    if(SlotThreadID == ThreadID)
+    {
+      Result = Slot;
+    }
+  }
+  Assert(Result); // Raise MAX_DEBUG_THREAD_COUNT
+  return Result;
+}
+
+inline debug_thread_events*
+GetDebugThreadEvents()
+{
+  if(ThreadDebugTable != GlobalDebugTable)
+  {
+    ThreadDebugEvents = ClaimDebugThreadEvents(GlobalDebugTable, GetThreadID());
+    ThreadDebugTable = GlobalDebugTable;
+  }
+  return ThreadDebugEvents;
+}
+
+// Writing is raised before the event array index is read. DEBUGGameFrameEnd swaps the index and
+// then waits for Writing to drop, so no event is still being written to a frame it collates.
 #define RecordDebugEventCommon(RecordIndex, EventType) \
-  u64 ArrayIndex_EventIndex = AtomicAddu64(&GlobalDebugTable->EventArrayIndex_EventIndex, 1); \
-  u32 EventIndex = ArrayIndex_EventIndex & 0xFFFFFFFF; \
-  u32 ArrayIndex = ArrayIndex_EventIndex >> 32; \
-  debug_event* Event = GlobalDebugTable->Events[ArrayIndex] + EventIndex; \
+  debug_thread_events* ThreadEvents = GetDebugThreadEvents(); \
+  ThreadEvents->Writing = 1; \
+  CompilerBarrier(); \
+  u32 ArrayIndex = GlobalDebugTable->CurrentEventArrayIndex; \
+  u32 EventIndex = ThreadEvents->EventCount[ArrayIndex]; \
+  debug_event* Event = PushDebugEvent(GlobalDebugTable, ThreadEvents, ArrayIndex, &EventIndex); \
   Event->Clock = __rdtsc(); \
   Event->DebugRecordIndex = (u16) RecordIndex; \
   Event->TranslationUnit = TRANSLATION_UNIT_INDEX; \
   Event->Type = (u8) EventType;
 
+#define CommitDebugEvent() \
+  CompilerBarrier(); \
+  ThreadEvents->EventCount[ArrayIndex] = EventIndex; \
+  ThreadEvents->Writing = 0;
+
+inline u16
+SampleDebugCounters(debug_thread_events* ThreadEvents, u32 ArrayIndex)
+{
+  u16 Result = 0;
+  u32 SampleIndex = ThreadEvents->CounterSampleCount[ArrayIndex];
+  if(GlobalDebugTable->ReadPerformanceCounters && SampleIndex < MAX_DEBUG_COUNTER_SAMPLE_COUNT)
+  {
+    GlobalDebugTable->ReadPerformanceCounters(ThreadEvents->CounterSamples[ArrayIndex] + SampleIndex);
+    ThreadEvents->CounterSampleCount[ArrayIndex] = SampleIndex + 1;
+    Result = (u16)(SampleIndex + 1);
+  }
+  return Result;
+}
+
 #define RecordDebugEvent( RecordIndex, EventType) \
 {\
   RecordDebugEventCommon( RecordIndex, EventType); \
-  Event->TC.ThreadID = (u16)GetThreadID(); \
-  Event->TC.CoreIndex = 0; \
+  Event->TC.ThreadID = (u16)ThreadEvents->ThreadID; \
+  Event->TC.CounterSample = 0; \
+  if(GlobalDebugTable->Records[TRANSLATION_UNIT_INDEX][RecordIndex].Flags & DebugRecordFlag_Counters) \
+  { \
+    Event->TC.CounterSample = SampleDebugCounters(ThreadEvents, ArrayIndex); \
+  } \
+  CommitDebugEvent(); \
 }
 
 #define FRAME_MARKER(SecondsElapsed) \
@@ -251,6 +419,7 @@ extern debug_table* GlobalDebugTable;
   u32 RecordIndex = __COUNTER__; \
   RecordDebugEventCommon(RecordIndex, DebugEvent_FrameMarker);\
   Event->SecondsElapsed = SecondsElapsed; \
+  CommitDebugEvent(); \
   debug_record* Record = GlobalDebugTable->Records[TRANSLATION_UNIT_INDEX] + RecordIndex; \
   Record->FileName = __FILE__; \
   Record->BlockName = "Frame Marker"; \
@@ -734,8 +903,15 @@ enum platform_memory_block_flags
   PlatformMemory_NotRestored = 0x1,
   PlatformMemory_OverflowCheck = 0x2,
   PlatformMemory_UnderflowCheck = 0x4,
+  PlatformMemory_LargePages = 0x8,    // Back the block with large pages if the OS lets us, ignored with the checks above
+  PlatformMemory_NodeLocal = 0x10,    // Commit the block on the NUMA node of the thread that allocates it
 };
 
+// Size of the platform header in front of each block and of a large page (2MB on x64).
+// Arenas use them to size blocks that fill whole large pages.
+#define PLATFORM_MEMORY_BLOCK_HEADER_SIZE 64
+#define PLATFORM_LARGE_PAGE_SIZE Megabytes(2)
+
 /*
  *  Platform Memory Block (PMB)
  *       01234567
@@ -809,6 +985,8 @@ struct platform_api
     platform_deallocate_memory* DeallocateMemory;
 
     platform_work_queue* HighPriorityQueue;
+    platform_work_queue* LowPriorityQueue;  // Long running background work, only waited on before the game code is unloaded
+    platform_work_queue* DebugQueue;        // Only the profiler collation, so it never waits behind other work
 
     platform_add_entry* PlatformAddEntry;
     platform_complete_all_work* PlatformCompleteWorkQueue;
@@ -817,11 +995,18 @@ struct platform_api
       debug_platform_read_entire_file*       DEBUGPlatformReadEntireFile;
       debug_platfrom_free_file_memory*       DEBUGPlatformFreeFileMemory;
       debug_platform_write_entire_file*      DEBUGPlatformWriteEntireFile;
+      debug_platform_map_file*               DEBUGPlatformMapFile;
+      debug_platform_unmap_file*             DEBUGPlatformUnmapFile;
+      debug_platform_get_file_write_time*    DEBUGPlatformGetFileWriteTime;
       debug_platform_append_to_file*         DEBUGPlatformAppendToFile;
       debug_platform_execute_system_command* DEBUGExecuteSystemCommand;
       debug_platform_get_process_state*      DEBUGGetProcessState;
       debug_platform_format_string*          DEBUGFormatString;
       debug_platform_print*                  DEBUGPrint;
+      debug_platform_flush_write_buffers*    DEBUGFlushWriteBuffers;
+      debug_platform_read_performance_counters* DEBUGReadPerformanceCounters;
+      const c8* DEBUGPerformanceCounterNames[DEBUG_COUNTER_COUNT];
+      u32 DEBUGPerformanceCounterCount;     // The first this many counters are read, the rest stay zero
 
 //     }
 
@@ -838,7 +1023,7 @@ struct game_memory
   struct game_state* GameState;
   struct debug_state* DebugState;
   platform_api PlatformAPI;
-  u32 ThreadID[4];
+  u32 ThreadID[6];
 };
 
 
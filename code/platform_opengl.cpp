@@ -951,20 +951,6 @@ Blend(v4* A, v4* B)
   return Result;
 }
 
-b32 CompareU32Triplet( const u8* DataA, const  u8* DataB)
-{
-  u32* U32A = (u32*) DataA;
-  const u32 A1 = *(U32A+0);
-  const u32 A2 = *(U32A+1);
-  const u32 A3 = *(U32A+2);
-  
-  u32* U32B = (u32*) DataB;
-  const u32 B1 = *(U32B+0);
-  const u32 B2 = *(U32B+1);
-  const u32 B3 = *(U32B+2);
-  
-  return (A1 == B1) && (A2 == B2) && (A3 == B3);
-}
 b32 CompareU32(u8* DataA, u8* DataB)
 {
   const u32 U32A = *( (u32*) DataA);
@@ -972,91 +958,6 @@ b32 CompareU32(u8* DataA, u8* DataB)
   return (U32A == U32B);
 }
 
-u32 PushUnique( u8* Array, const u32 ElementCount, const u32 ElementByteSize,
-               u8* NewElement, b32 (*CompareFunction)(const u8* DataA, const u8* DataB))
-{
-  for( u32 i = 0; i < ElementCount; ++i )
-  {
-    if( CompareFunction(NewElement, Array) )
-    {
-      return i;
-    }
-    Array += ElementByteSize;
-  }
-  
-  // If we didn't find the element we push it to the end
-  utils::Copy(ElementByteSize, NewElement, Array);
-  
-  return ElementCount;
-}
-
-struct gl_vertex_buffer
-{
-  u32 IndexCount;
-  u32* Indeces;
-  u32 VertexCount;
-  opengl_vertex* VertexData;
-};
-
-internal gl_vertex_buffer
-CreateGLVertexBuffer( memory_arena* TemporaryMemory,
-                     const u32 IndexCount,
-                     const u32* VerticeIndeces, const u32* TextureIndeces, const u32* NormalIndeces,
-                     const v3* VerticeData,     const v2* TextureData,     const v3* NormalData)
-{
-  Assert(VerticeIndeces && VerticeData);
-  u32* GLVerticeIndexArray  = PushArray(TemporaryMemory, 3*IndexCount, u32);
-  u32* GLIndexArray         = PushArray(TemporaryMemory, IndexCount, u32);
-  
-  u32 VerticeArrayCount = 0;
-  for( u32 i = 0; i < IndexCount; ++i )
-  {
-    const u32 vidx = VerticeIndeces[i];
-    const u32 tidx = TextureIndeces ? TextureIndeces[i] : 0;
-    const u32 nidx = NormalIndeces  ? NormalIndeces[i]  : 0;
-    u32 NewElement[3] = {vidx, tidx, nidx};
-    u32 Index = PushUnique((u8*)GLVerticeIndexArray, VerticeArrayCount, sizeof(NewElement), (u8*) NewElement,
-                           [](const u8* DataA, const u8* DataB) {
-                             u32* U32A = (u32*) DataA;
-                             const u32 A1 = *(U32A+0);
-                             const u32 A2 = *(U32A+1);
-                             const u32 A3 = *(U32A+2);
-                             u32* U32B = (u32*) DataB;
-                             const u32 B1 = *(U32B+0);
-                             const u32 B2 = *(U32B+1);
-                             const u32 B3 = *(U32B+2);
-                             b32 result = (A1 == B1) && (A2 == B2) && (A3 == B3);
-                             return result;
-                           });
-    if(Index == VerticeArrayCount)
-    {
-      VerticeArrayCount++;
-    }
-    
-  	GLIndexArray[i] = Index;
-  }
-  
-  opengl_vertex* VertexData = PushArray(TemporaryMemory, VerticeArrayCount, opengl_vertex);
-  opengl_vertex* Vertice = VertexData;
-  for( u32 i = 0; i < VerticeArrayCount; ++i )
-  {
-    const u32 vidx = *(GLVerticeIndexArray + 3 * i + 0);
-    const u32 tidx = *(GLVerticeIndexArray + 3 * i + 1);
-    const u32 nidx = *(GLVerticeIndexArray + 3 * i + 2);
-    Vertice->v  = VerticeData[vidx];
-    Vertice->vt = TextureData ? TextureData[tidx] : V2(0,0);
-    Vertice->vn = NormalData  ? NormalData[nidx]  : V3(0,0,0);
-    ++Vertice;
-  }
-  
-  gl_vertex_buffer Result = {};
-  Result.IndexCount = IndexCount;
-  Result.Indeces = GLIndexArray;
-  Result.VertexCount = VerticeArrayCount;
-  Result.VertexData = VertexData;
-  return Result;
-}
-
 void PushObjectToGPU(open_gl* OpenGL, game_asset_manager* AssetManager, object_handle ObjectHandle)
 { 
   buffer_keeper* ObjectKeeper = 0;
@@ -1066,17 +967,27 @@ void PushObjectToGPU(open_gl* OpenGL, game_asset_manager* AssetManager, object_h
   
   temporary_memory TempMem = BeginTemporaryMemory(&AssetManager->AssetArena);
   
-  Assert(Object->Count && Object->vi && Object->ti && Object->ni && MeshData->v && MeshData->vt && MeshData->vn);
-  
-  // Each object within a mesh gets a copy of the mesh, not good.
-  gl_vertex_buffer GLBuffer =  CreateGLVertexBuffer(&AssetManager->AssetArena, 
-                                                    Object->Count,
-                                                    Object->vi,
-                                                    Object->ti,
-                                                    Object->ni,
-                                                    MeshData->v,
-                                                    MeshData->vt,
-                                                    MeshData->vn);
+  gl_vertex_buffer GLBuffer = {};
+  if(Object->Vertices)
+  {
+    // Deduplicated when the asset pack was baked
+    GLBuffer.IndexCount = Object->Count;
+    GLBuffer.Indeces = Object->Indeces;
+    GLBuffer.VertexCount = Object->VertexCount;
+    GLBuffer.VertexData = Object->Vertices;
+  }else{
+    Assert(Object->Count && Object->vi && Object->ti && Object->ni && MeshData->v && MeshData->vt && MeshData->vn);
+  
+    // Each object within a mesh gets a copy of the mesh, not good.
+    GLBuffer = CreateGLVertexBuffer(&AssetManager->AssetArena,
+                                    Object->Count,
+                                    Object->vi,
+                                    Object->ti,
+                                    Object->ni,
+                                    MeshData->v,
+                                    MeshData->vt,
+                                    MeshData->vn);
+  }
   
   
   
@@ -1171,7 +1082,7 @@ void PushBitmapToGPU(open_gl* OpenGL, game_asset_manager* AssetManager, bitmap_h
         u32 W = (u32) BitmapKeeper->SubRegion.W;
         u32 H = (u32) BitmapKeeper->SubRegion.H;
         midx PixelCount = W * H;
-        u32* Pixels = PushArray(&AssetManager->AssetArena, PixelCount, u32);
+        u32* Pixels = PushArray(&AssetManager->AssetArena, PixelCount, u32, NoClear());
 
         CopyBitmapSubregion(X, Y, W, H, RenderTarget->Width, (u32*) RenderTarget->Pixels, Pixels);
 
@@ -1213,7 +1124,7 @@ void PushBitmapToGPU(open_gl* OpenGL, game_asset_manager* AssetManager, bitmap_h
         u32 W = (u32) BitmapKeeper->SubRegion.W;
         u32 H = (u32) BitmapKeeper->SubRegion.H;
         midx PixelCount = W * H;
-        u32* Pixels = PushArray(&AssetManager->AssetArena, PixelCount, u32);
+        u32* Pixels = PushArray(&AssetManager->AssetArena, PixelCount, u32, NoClear());
 
         CopyBitmapSubregion(X, Y, W, H, RenderTarget->Width, (u32*) RenderTarget->Pixels, Pixels);
 
@@ -1291,11 +1202,11 @@ void DrawRenderGroup(open_gl* OpenGL, render_group* RenderGroup, game_asset_mana
       u32 TriangleDataSize         = sizeof(triangle_2d_data)*TriangleCount;
       u32 SpecialTextureSlot = 0;
 
-      quad_2d_data* Quad2DBuffer          = PushArray(&RenderGroup->Arena, Quad2DCount,              quad_2d_data);
-      quad_2d_data* Quad2DColorBuffer     = PushArray(&RenderGroup->Arena, Quad2DColorCount,         quad_2d_data);
-      quad_2d_data* Quad2DSpecialBuffer   = PushArray(&RenderGroup->Arena, Quad2DCountSpecial,       quad_2d_data);
-      circle_2d_data* Circle2DBuffer      = PushArray(&RenderGroup->Arena, ElectricalComponentCount, circle_2d_data);
-      triangle_2d_data* Triangle2DBuffer   = PushArray(&RenderGroup->Arena, TriangleCount,           triangle_2d_data);
+      quad_2d_data* Quad2DBuffer          = PushArray(&RenderGroup->Arena, Quad2DCount,              quad_2d_data, NoClear());
+      quad_2d_data* Quad2DColorBuffer     = PushArray(&RenderGroup->Arena, Quad2DColorCount,         quad_2d_data, NoClear());
+      quad_2d_data* Quad2DSpecialBuffer   = PushArray(&RenderGroup->Arena, Quad2DCountSpecial,       quad_2d_data, NoClear());
+      circle_2d_data* Circle2DBuffer      = PushArray(&RenderGroup->Arena, ElectricalComponentCount, circle_2d_data, NoClear());
+      triangle_2d_data* Triangle2DBuffer   = PushArray(&RenderGroup->Arena, TriangleCount,           triangle_2d_data, NoClear());
       
 
       u32 Quad2DBufferInstanceIndex = 0;
@@ -1451,19 +1362,32 @@ void OpenGLRenderGroupToOutput(game_render_commands* Commands)
   game_asset_manager* AssetManager = Commands->AssetManager;
   open_gl* OpenGL = &Commands->OpenGL;
   
-  for (u32 i = 0; i < AssetManager->ObjectPendingLoadCount; ++i)
+  // Spread uploads over frames so a burst of new assets doesn't cause a hitch.
+  // Anything still queued draws with texture slot 0 until its turn comes.
+  midx UploadedBytes = 0;
+  pending_asset PendingAsset = {};
+  while( (UploadedBytes == 0 || UploadedBytes < AssetManager->UploadBudgetBytes) &&
+         PopPendingUpload(AssetManager, &PendingAsset) )
   {
-    // PushObject
-    PushObjectToGPU(OpenGL, AssetManager, AssetManager->ObjectPendingLoad[i]);
-  }
-  AssetManager->ObjectPendingLoadCount = 0;
-  
-  for (u32 i = 0; i < AssetManager->BitmapPendingLoadCount; ++i)
-  {
-    // PushObject
-    PushBitmapToGPU(OpenGL, AssetManager, AssetManager->BitmapPendingLoad[i]);
+    UploadedBytes += GetUploadSize(AssetManager, PendingAsset);
+    switch(PendingAsset.Type)
+    {
+      case asset_type::OBJECT:
+      {
+        object_handle Handle = {PendingAsset.Handle};
+        PushObjectToGPU(OpenGL, AssetManager, Handle);
+      }break;
+      case asset_type::BITMAP:
+      {
+        bitmap_handle Handle = {PendingAsset.Handle};
+        PushBitmapToGPU(OpenGL, AssetManager, Handle);
+      }break;
+      default:
+      {
+        INVALID_CODE_PATH
+      }
+    }
   }
-  AssetManager->BitmapPendingLoadCount = 0;
   
   r32 R = 0x1E / (r32) 0xFF;
   r32 G = 0x46 / (r32) 0xFF;
@@ -5,6 +5,7 @@
 #include "breadboard_tile.h"
 #include "component_breadboard_components.h"
 #include "random.h"
+#include "font_cache.h"
 
 // TODO: Move to settings
 #define DRAW_HITBOX_AND_POINTS 0
@@ -45,8 +46,9 @@ push_buffer_header* PushNewEntry(render_group* RenderGroup, render_buffer_entry_
   //       If the header is in another memory block as the header they won't be located togeather
   //       in memory.
   //       Alternate solution is to let the header carry a pointer to the body.
+  // Note: The body is not cleared, every Push function has to set all fields of its body.
   u32 BodySize = RenderTypeToBodySize(Type);
-  push_buffer_header* NewEntryHeader = (push_buffer_header*) PushSize(&RenderGroup->Arena, sizeof(push_buffer_header) + BodySize);
+  push_buffer_header* NewEntryHeader = (push_buffer_header*) PushSize(&RenderGroup->Arena, sizeof(push_buffer_header) + BodySize, NoClear());
   NewEntryHeader->Next = 0;
 
   if(!RenderGroup->First)
@@ -68,6 +70,13 @@ void PushNewRenderLevel(render_group* RenderGroup)
   push_buffer_header* Header = PushNewEntry(RenderGroup, render_buffer_entry_type::NEW_LEVEL);
 }
 
+// Pushes an entry recorded from an earlier frame, Body holds RenderTypeToBodySize(Type) bytes
+void PushEntryCopy(render_group* RenderGroup, render_buffer_entry_type Type, void* Body)
+{
+  push_buffer_header* Header = PushNewEntry(RenderGroup, Type);
+  utils::Copy(RenderTypeToBodySize(Type), Body, GetBody(Header, u8));
+}
+
 
 // The rect is drawn with the lower left corner at X and Y of Quadrect. W and H extend right and up.
 //  _________
@@ -82,6 +91,8 @@ void Push2DColoredQuad(render_group* RenderGroup, rect2f QuadRect, v4 Color, r32
   entry_type_2d_quad* Body = GetBody(Header, entry_type_2d_quad);
   Body->Colour = Color;
   Body->QuadRect = QuadRect;
+  Body->UVRect = {};
+  Body->BitmapHandle = {};
   Body->Rotation = Rotation;
   Body->RotationCenterOffset = RotationCenterOffset;
   Recenter(&Body->QuadRect);
@@ -110,6 +121,7 @@ void Push2DQuad(render_group* RenderGroup, rect2f QuadRect, float Rotation, rect
   Body->BitmapHandle = BitmapHandle;
   Body->Colour = Color;
   Body->Rotation = Rotation;
+  Body->RotationCenterOffset = {};
   Recenter(&Body->QuadRect);
 }
 
@@ -127,49 +139,49 @@ void PushTexturedOverlayQuad(rect2f QuadRect,  rect2f UVRect,  bitmap_handle Bit
 
 r32 GetTextLineHeightSize(u32 FontSize)
 {
-  stb_font_map* FontMap = GetFontMap(GlobalGameState->AssetManager, FontSize);
   game_window_size WindowSize = GameGetWindowSize();
-  r32 Result = FontMap->FontHeightPx/ (r32) WindowSize.HeightPx;
+  r32 Result = FontSize / (r32) WindowSize.HeightPx;
   return Result;
 }
 
-r32 GetTextWidth(const c8* String, u32 FontSize)
+// Width in pixels
+internal r32
+GetTextWidthPx(const c8* String, u32 FontSize)
 {
-  stb_font_map* FontMap = GetFontMap(GlobalGameState->AssetManager, FontSize);
-
-  game_window_size WindowSize = GameGetWindowSize();
-  const r32 PixelSize = 1.f / WindowSize.HeightPx;
-
+  game_asset_manager* AssetManager = GlobalGameState->AssetManager;
   r32 Width = 0;
   while (*String != '\0')
   {
-    stbtt_bakedchar* CH = &FontMap->CharData[*String-0x20];
-    Width += CH->xadvance;
-    ++String;
+    u32 Codepoint = str::DecodeUTF8(&String);
+    cached_glyph* Glyph = GetGlyph(AssetManager, DEFAULT_FONT, FontSize, Codepoint);
+    if(Glyph)
+    {
+      Width += Glyph->Char.xadvance;
+    }
   }
-  r32 Result = PixelSize*Width;
+  return Width;
+}
+
+r32 GetTextWidth(const c8* String, u32 FontSize)
+{
+  game_window_size WindowSize = GameGetWindowSize();
+  const r32 PixelSize = 1.f / WindowSize.HeightPx;
+  r32 Result = PixelSize*GetTextWidthPx(String, FontSize);
   return Result;
 }
 
 rect2f GetTextSize(r32 x, r32 y, const c8* String, u32 FontSize)
 {
-  stb_font_map* FontMap = GetFontMap(GlobalGameState->AssetManager, FontSize);
+  font_metrics Metrics = GetFontMetrics(GlobalGameState->AssetManager->FontCache, DEFAULT_FONT, FontSize);
 
   game_window_size WindowSize = GameGetWindowSize();
   const r32 ScreenScaleFactor = 1.f / WindowSize.HeightPx;
 
-  r32 Width = 0;
-  while (*String != '\0')
-  {
-    stbtt_bakedchar* CH = &FontMap->CharData[*String-0x20];
-    Width += CH->xadvance;
-    ++String;
-  }
   rect2f Result = {};
   Result.X = x;
-  Result.Y = y+ScreenScaleFactor*FontMap->Descent;
-  Result.H = ScreenScaleFactor*FontMap->FontHeightPx;
-  Result.W = ScreenScaleFactor*Width;
+  Result.Y = y+ScreenScaleFactor*Metrics.Descent;
+  Result.H = ScreenScaleFactor*Metrics.FontHeightPx;
+  Result.W = ScreenScaleFactor*GetTextWidthPx(String, FontSize);
   return Result;
 }
 
@@ -219,20 +231,23 @@ void PushTextAt(r32 CanPosX, r32 CanPosY, const c8* String, u32 FontSize, v4 Col
   r32 PixelPosX = Floor(CanPosX*WindowSize.HeightPx);
   r32 PixelPosY = Floor(CanPosY*WindowSize.HeightPx);
   game_asset_manager* AssetManager =  GlobalGameState->AssetManager;
-  stb_font_map* FontMap = GetFontMap(GlobalGameState->AssetManager, FontSize);
-
-  bitmap* BitMap = GetAsset(AssetManager, FontMap->BitmapHandle);
-  stbtt_aligned_quad Quad  = {};
+  font_cache* FontCache = AssetManager->FontCache;
 
   const r32 ScreenScaleFactor = 1.f / WindowSize.HeightPx;
 
-  const r32 Ks = 1.f / BitMap->Width;
-  const r32 Kt = 1.f / BitMap->Height;
+  const r32 Ks = 1.f / FONT_CACHE_PAGE_DIM;
+  const r32 Kt = 1.f / FONT_CACHE_PAGE_DIM;
 
   while (*String != '\0')
   {
-    stbtt_bakedchar* CH = &FontMap->CharData[*String-0x20];
-    if(*String != ' ')
+    u32 Codepoint = str::DecodeUTF8(&String);
+    cached_glyph* Glyph = GetGlyph(AssetManager, DEFAULT_FONT, FontSize, Codepoint);
+    if(!Glyph)
+    {
+      continue;
+    }
+    stbtt_bakedchar* CH = &Glyph->Char;
+    if(Glyph->Page != FONT_CACHE_NO_GLYPH)
     {
       rect2f TextureRect = GetSTBBitMapTextureCoords(CH, Ks, Kt);
       rect2f GlyphOffset = GetSTBGlyphRect(PixelPosX,PixelPosY,CH);
@@ -240,16 +255,15 @@ void PushTextAt(r32 CanPosX, r32 CanPosY, const c8* String, u32 FontSize, v4 Col
       GlyphOffset.Y *= ScreenScaleFactor;
       GlyphOffset.W *= ScreenScaleFactor;
       GlyphOffset.H *= ScreenScaleFactor;
-      Push2DQuad(RenderGroup, GlyphOffset, 0, TextureRect,Color, FontMap->BitmapHandle);
+      Push2DQuad(RenderGroup, GlyphOffset, 0, TextureRect,Color, FontCache->Pages[Glyph->Page].Bitmap);
     }
     PixelPosX += CH->xadvance;
-    ++String;
   }
 }
 
 render_group* InitiateRenderGroup()
 {
-  render_group* Result = BootstrapPushStruct(render_group, Arena);
+  render_group* Result = BootstrapPushStruct(render_group, Arena, LargePageArena());
   Result->PushBufferMemory = BeginTemporaryMemory(&Result->Arena);
 
   ResetRenderGroup(Result);
@@ -286,6 +300,7 @@ void PushElectricalComponent_2(entity_manager* EM, component_electrical* Electri
     }break;
     case ElectricalComponentType::Wire:
     {
+      Body->Color = V3(0,0,0);
     }break;
   }
 
@@ -612,7 +627,7 @@ void FillRenderPushBuffer(world* World)
   }
 
   bitmap_handle TileHandle;
-  GetHandle(AssetManager, "TileSheet", &TileHandle);
+  GetHandle(AssetManager, AssetKey("TileSheet"), &TileHandle);
   bitmap* ElectricalComponentSpriteSheet = GetAsset(AssetManager, TileHandle);
 
   r32 SpriteSheetWidth =  (r32) ElectricalComponentSpriteSheet->Width;
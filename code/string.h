@@ -23,6 +23,53 @@ StringLength( const char* String )
   return Count;
 }
 
+// Decodes one UTF-8 sequence and advances String past it.
+// Malformed or overlong sequences decode as U+FFFD one byte at a time.
+internal u32
+DecodeUTF8( const char** String )
+{
+  const u8* Scan = (const u8*) *String;
+  u32 Result = 0xFFFD;
+  u32 Length = 1;
+  u32 MinValue = 0;
+  if(Scan[0] < 0x80)
+  {
+    Result = Scan[0];
+  }else if((Scan[0] & 0xE0) == 0xC0){
+    Result = Scan[0] & 0x1F;
+    Length = 2;
+    MinValue = 0x80;
+  }else if((Scan[0] & 0xF0) == 0xE0){
+    Result = Scan[0] & 0x0F;
+    Length = 3;
+    MinValue = 0x800;
+  }else if((Scan[0] & 0xF8) == 0xF0){
+    Result = Scan[0] & 0x07;
+    Length = 4;
+    MinValue = 0x10000;
+  }
+
+  for(u32 Index = 1; Index < Length; ++Index)
+  {
+    // Also stops at the terminator
+    if((Scan[Index] & 0xC0) != 0x80)
+    {
+      Result = 0xFFFD;
+      Length = 1;
+      break;
+    }
+    Result = (Result << 6) | (Scan[Index] & 0x3F);
+  }
+
+  if(Length > 1 && (Result < MinValue || Result > 0x10FFFF || (Result >= 0xD800 && Result <= 0xDFFF)))
+  {
+    Result = 0xFFFD;
+    Length = 1;
+  }
+  *String += Length;
+  return Result;
+}
+
 internal bool
 BeginsWith( memory_index LookForLength, const char* LookForString, memory_index SearchInLength, const char* SearchInString )
 {
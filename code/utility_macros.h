@@ -140,4 +140,15 @@ namespace utils
     return hash;
   }
 
+  // Finalizer of MurmurHash3, spreads every bit of the key over the whole hash
+  inline u64 murmur_hash_64(u64 key)
+  {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccd;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53;
+    key ^= key >> 33;
+    return key;
+  }
+
 }
\ No newline at end of file
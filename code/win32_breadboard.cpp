@@ -108,6 +108,46 @@ DEBUG_PLATFORM_FORMAT_STRING(DEBUGFormatString)
   return Result;
 }
 
+DEBUG_PLATFORM_FLUSH_WRITE_BUFFERS(DEBUGFlushWriteBuffers)
+{
+  FlushProcessWriteBuffers();
+}
+
+// Fixed function counters, readable from user mode only when the os sets CR4.PCE
+#define WIN32_PMC_FIXED_INSTRUCTIONS 0x40000000
+#define WIN32_PMC_FIXED_CORE_CYCLES  0x40000001
+global_variable b32 GlobalFixedCountersReadable;
+
+internal b32
+Win32CanReadFixedCounters()
+{
+  b32 Result = false;
+  __try
+  {
+    __readpmc(WIN32_PMC_FIXED_INSTRUCTIONS);
+    __readpmc(WIN32_PMC_FIXED_CORE_CYCLES);
+    Result = true;
+  }
+  __except(EXCEPTION_EXECUTE_HANDLER)
+  {
+    Result = false;
+  }
+  return Result;
+}
+
+DEBUG_PLATFORM_READ_PERFORMANCE_COUNTERS(DEBUGReadPerformanceCounters)
+{
+  QueryThreadCycleTime(GetCurrentThread(), Sample->Values + 0);
+  if(GlobalFixedCountersReadable)
+  {
+    Sample->Values[1] = __readpmc(WIN32_PMC_FIXED_INSTRUCTIONS);
+    Sample->Values[2] = __readpmc(WIN32_PMC_FIXED_CORE_CYCLES);
+  }else{
+    Sample->Values[1] = 0;
+    Sample->Values[2] = 0;
+  }
+}
+
 DEBUG_PLATFORM_PRINT(DEBUGPrint)
 {
   va_list args;
@@ -201,6 +241,65 @@ DEBUG_PLATFORM_READ_ENTIRE_FILE(DEBUGPlatformReadEntireFile)
   return Result;
 }
 
+DEBUG_PLATFORM_MAP_FILE(DEBUGPlatformMapFile)
+{
+  debug_mapped_file Result = {};
+  HANDLE FileHandle = CreateFileA(Filename, GENERIC_READ, FILE_SHARE_READ,
+                  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if(FileHandle != INVALID_HANDLE_VALUE)
+  {
+    LARGE_INTEGER FileSize;
+    if(GetFileSizeEx( FileHandle, &FileSize) && FileSize.QuadPart)
+    {
+      // Note: Copy on write so assets pointing into the view can still be modified in memory
+      HANDLE MappingHandle = CreateFileMappingA(FileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+      if(MappingHandle)
+      {
+        Result.Contents = MapViewOfFile(MappingHandle, FILE_MAP_COPY, 0, 0, 0);
+        if(Result.Contents)
+        {
+          Result.ContentSize = FileSize.QuadPart;
+          Result.OSHandle = (u64) MappingHandle;
+        }else{
+          // TODO: Logging
+          CloseHandle(MappingHandle);
+        }
+      }else{
+        // TODO: Logging
+      }
+    }
+
+    // Note: The mapping keeps the file open
+    CloseHandle( FileHandle);
+  }else{
+    // TODO: Logging
+  }
+
+  return Result;
+}
+
+DEBUG_PLATFORM_UNMAP_FILE(DEBUGPlatformUnmapFile)
+{
+  if(File->Contents)
+  {
+    UnmapViewOfFile(File->Contents);
+    CloseHandle((HANDLE) File->OSHandle);
+  }
+  *File = {};
+}
+
+DEBUG_PLATFORM_GET_FILE_WRITE_TIME(DEBUGPlatformGetFileWriteTime)
+{
+  u64 Result = 0;
+  WIN32_FILE_ATTRIBUTE_DATA Data;
+  if(GetFileAttributesExA(Filename, GetFileExInfoStandard, &Data))
+  {
+    Result = ((u64) Data.ftLastWriteTime.dwHighDateTime << 32) | Data.ftLastWriteTime.dwLowDateTime;
+  }
+  return Result;
+}
+
 DEBUG_PLATFORM_WRITE_ENTIRE_FILE(DEBUGPlatformWriteEntireFile)
 {
   bool Result = 0;
@@ -1482,6 +1581,50 @@ Win32IsInLoop(win32_state *aState)
 }
 
 
+// Large pages need the "Lock pages in memory" user right. Without it we keep using regular pages.
+internal void
+Win32EnableLargePages(win32_state* aState)
+{
+  aState->LargePageSize = 0;
+  HANDLE Token;
+  if(OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &Token))
+  {
+    TOKEN_PRIVILEGES Privileges = {};
+    Privileges.PrivilegeCount = 1;
+    Privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    // AdjustTokenPrivileges succeeds without granting anything if the right is missing
+    if(LookupPrivilegeValueA(0, "SeLockMemoryPrivilege", &Privileges.Privileges[0].Luid) &&
+       AdjustTokenPrivileges(Token, FALSE, &Privileges, 0, 0, 0) &&
+       GetLastError() == ERROR_SUCCESS)
+    {
+      aState->LargePageSize = GetLargePageMinimum();
+    }
+    CloseHandle(Token);
+  }
+}
+
+internal void*
+Win32VirtualAlloc(uintptr_t aSize, DWORD aExtraType, u64 aFlags)
+{
+  DWORD Type = MEM_RESERVE | MEM_COMMIT | aExtraType;
+  void* Result = 0;
+  if(aFlags & PlatformMemory_NodeLocal)
+  {
+    PROCESSOR_NUMBER Processor = {};
+    GetCurrentProcessorNumberEx(&Processor);
+    USHORT Node = 0;
+    if(GetNumaProcessorNodeEx(&Processor, &Node))
+    {
+      Result = VirtualAllocExNuma(GetCurrentProcess(), 0, aSize, Type, PAGE_READWRITE, Node);
+    }
+  }
+  if(!Result)
+  {
+    Result = VirtualAlloc(0, aSize, Type, PAGE_READWRITE);
+  }
+  return Result;
+}
+
 // Signature: platform_memory_block* PLATFORM_ALLOCATE_MEMORY(memory_index aSize, u64 aFlags)
 
 PLATFORM_ALLOCATE_MEMORY(Win32AllocateMemory)
@@ -1508,8 +1651,23 @@ PLATFORM_ALLOCATE_MEMORY(Win32AllocateMemory)
         ProtectOffset = PageSize + SizeRoundedUp;
     }
 
-    win32_memory_block* Block = (win32_memory_block*)
-        VirtualAlloc(0, TotalSize, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+    win32_memory_block* Block = 0;
+    if((aFlags & PlatformMemory_LargePages) && GlobalWin32State.LargePageSize &&
+      !(aFlags & (PlatformMemory_UnderflowCheck|PlatformMemory_OverflowCheck)))
+    {
+        // Large pages may be unavailable even with the right once physical memory is fragmented
+        uintptr_t LargeTotalSize = AlignPow2(TotalSize, GlobalWin32State.LargePageSize);
+        Block = (win32_memory_block*) Win32VirtualAlloc(LargeTotalSize, MEM_LARGE_PAGES, aFlags);
+        if(Block)
+        {
+            aSize = LargeTotalSize - BaseOffset;
+        }
+    }
+
+    if(!Block)
+    {
+        Block = (win32_memory_block*) Win32VirtualAlloc(TotalSize, 0, aFlags);
+    }
 
     Assert(Block);
     Block->Block.Base = (u8*) Block + BaseOffset;
@@ -1724,18 +1882,26 @@ WinMain(  HINSTANCE Instance,
           LPSTR CommandLine,
           s32 ShowCode )
 {
-  win32_thread_info Threads[3] = {};
+  win32_thread_info Threads[5] = {};
   u32 ThreadCount = 3;
   u32 InitialCount = 0;
-  u32 ThreadIDs[4] = {};
+  u32 ThreadIDs[6] = {};
   ThreadIDs[0] = GetThreadID();
   platform_work_queue HighPriorityQueue = {};
   HighPriorityQueue.SemaphoreHandle = CreateSemaphoreEx(0, InitialCount, ThreadCount, 0, 0, SEMAPHORE_ALL_ACCESS);
+  // The last thread only serves the low priority queue so background loads never hold up
+  // work the main thread is waiting for
+  platform_work_queue LowPriorityQueue = {};
+  LowPriorityQueue.SemaphoreHandle = CreateSemaphoreEx(0, InitialCount, 1, 0, 0, SEMAPHORE_ALL_ACCESS);
+  // The profiler collation gets a thread of its own, the main thread waits for it every frame
+  platform_work_queue DebugQueue = {};
+  DebugQueue.SemaphoreHandle = CreateSemaphoreEx(0, InitialCount, 1, 0, 0, SEMAPHORE_ALL_ACCESS);
   for (u32 ThreadIndex = 0; ThreadIndex < ArrayCount(Threads); ++ThreadIndex)
   {
     win32_thread_info* Info = Threads + ThreadIndex;
     Info->LogicalThreadIndex = ThreadIndex;
-    Info->Queue = &HighPriorityQueue;
+    Info->Queue = (ThreadIndex < ThreadCount)  ? &HighPriorityQueue :
+                  (ThreadIndex == ThreadCount) ? &LowPriorityQueue  : &DebugQueue;
     DWORD ThreadID;
     HANDLE ThreadHandle = CreateThread( 0, 0, ThreadProc, Info, 0, &ThreadID);
     ThreadIDs[ThreadIndex+1] = ThreadID;
@@ -1864,7 +2030,11 @@ WinMain(  HINSTANCE Instance,
                   MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
   Assert(SoundSamples);
 
+  Win32EnableLargePages(&GlobalWin32State);
+
   GlobalDebugTable_ = (debug_table*) VirtualAlloc(0, sizeof(debug_table), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  GlobalFixedCountersReadable = Win32CanReadFixedCounters();
+  GlobalDebugTable_->ReadPerformanceCounters = DEBUGReadPerformanceCounters;
   GlobalDebugTable = GlobalDebugTable_;
   ///////// Init Platform API
 
@@ -1884,13 +2054,24 @@ WinMain(  HINSTANCE Instance,
   GameMemory.PlatformAPI.DEBUGPlatformFreeFileMemory  = DEBUGPlatformFreeFileMemory;
   GameMemory.PlatformAPI.DEBUGPlatformReadEntireFile  = DEBUGPlatformReadEntireFile;
   GameMemory.PlatformAPI.DEBUGPlatformWriteEntireFile = DEBUGPlatformWriteEntireFile;
+  GameMemory.PlatformAPI.DEBUGPlatformMapFile         = DEBUGPlatformMapFile;
+  GameMemory.PlatformAPI.DEBUGPlatformUnmapFile       = DEBUGPlatformUnmapFile;
+  GameMemory.PlatformAPI.DEBUGPlatformGetFileWriteTime = DEBUGPlatformGetFileWriteTime;
   GameMemory.PlatformAPI.DEBUGPlatformAppendToFile    = DEBUGPlatformAppendToFile;
   GameMemory.PlatformAPI.DEBUGExecuteSystemCommand    = DEBUGExecuteSystemCommand;
   GameMemory.PlatformAPI.DEBUGGetProcessState         = DEBUGGetProcessState;
   GameMemory.PlatformAPI.DEBUGFormatString            = DEBUGFormatString;
   GameMemory.PlatformAPI.DEBUGPrint                   = DEBUGPrint;
+  GameMemory.PlatformAPI.DEBUGFlushWriteBuffers       = DEBUGFlushWriteBuffers;
+  GameMemory.PlatformAPI.DEBUGReadPerformanceCounters = DEBUGReadPerformanceCounters;
+  GameMemory.PlatformAPI.DEBUGPerformanceCounterNames[0] = "ThreadCycles";
+  GameMemory.PlatformAPI.DEBUGPerformanceCounterNames[1] = "Instructions";
+  GameMemory.PlatformAPI.DEBUGPerformanceCounterNames[2] = "CoreCycles";
+  GameMemory.PlatformAPI.DEBUGPerformanceCounterCount    = GlobalFixedCountersReadable ? 3 : 1;
 
   GameMemory.PlatformAPI.HighPriorityQueue = &HighPriorityQueue;
+  GameMemory.PlatformAPI.LowPriorityQueue  = &LowPriorityQueue;
+  GameMemory.PlatformAPI.DebugQueue        = &DebugQueue;
 
   GameMemory.PlatformAPI.PlatformAddEntry = Win32AddEntry;
   GameMemory.PlatformAPI.PlatformCompleteWorkQueue = Win32CompleteAllWork;
@@ -1988,6 +2169,10 @@ WinMain(  HINSTANCE Instance,
     FILETIME NewDLLWriteTime = Win32GetLastWriteTime(SourceGameCodeDLLFullPath);
     if (CompareFileTime(&NewDLLWriteTime, &Game.LastDLLWriteTime))
     {
+      // Work queued by the old game code, like the profiler collation and bitmap loads, has to finish before it is unloaded
+      Win32CompleteAllWork(&HighPriorityQueue);
+      Win32CompleteAllWork(&LowPriorityQueue);
+      Win32CompleteAllWork(&DebugQueue);
       Win32UnloadGameCode(&Game);
       GlobalDebugTable = GlobalDebugTable_;
       Game = Win32LoadGameCode(SourceGameCodeDLLFullPath,
@@ -2272,7 +2457,14 @@ WinMain(  HINSTANCE Instance,
       {
         GlobalDebugTable = Game.DEBUGGameFrameEnd(&GameMemory);
       }
-      GlobalDebugTable_->EventArrayIndex_EventIndex = 0;
+      // Events recorded into the platform table while the game code was being reloaded are never collated
+      for(u32 SlotIndex = 0; SlotIndex < MAX_DEBUG_THREAD_COUNT; ++SlotIndex)
+      {
+        ZeroArray(MAX_DEBUG_EVENT_ARRAY_COUNT, (u32*) GlobalDebugTable_->Threads[SlotIndex].EventCount);
+        ZeroArray(MAX_DEBUG_EVENT_ARRAY_COUNT, (u32*) GlobalDebugTable_->Threads[SlotIndex].CounterSampleCount);
+        ZeroArray(MAX_DEBUG_EVENT_ARRAY_COUNT, (u32*) GlobalDebugTable_->Threads[SlotIndex].DroppedEventCount);
+      }
+      ZeroArray(MAX_DEBUG_EVENT_ARRAY_COUNT, (u32*) GlobalDebugTable_->EventChunkCount);
       END_BLOCK(DebugCollation);
 #endif
       LARGE_INTEGER EndCounter = Win32GetWallClock();
@@ -2286,5 +2478,11 @@ WinMain(  HINSTANCE Instance,
     } // Global Pause
   } // Global Running
 
+  // The workers may still be running game code
+  Win32CompleteAllWork(&HighPriorityQueue);
+  Win32CompleteAllWork(&LowPriorityQueue);
+  Win32CompleteAllWork(&DebugQueue);
+  Win32UnloadGameCode(&Game);
+
   return 0;
 }
\ No newline at end of file
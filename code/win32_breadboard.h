@@ -109,6 +109,7 @@ struct win32_state
 {
   ticket_mutex MemoryMutex;
   win32_memory_block MemorySentinel;
+  uintptr_t LargePageSize; // Zero if the process may not lock large pages
 
   u64 TotalSize;
   //TODO, give support for more than 1 replaybuffer
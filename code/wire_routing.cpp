@@ -0,0 +1,717 @@
+#include "wire_routing.h"
+
+#define ROUTE_CELL_NONE 0xFFFFFFFF
+#define ROUTE_MAX_BATCH_SIZE 64
+
+const r32 RouteDiagonalCost = 1.41421356f;
+
+enum route_cell_state
+{
+  ROUTE_CELL_UNSEEN,
+  ROUTE_CELL_OPEN,
+  ROUTE_CELL_CLOSED
+};
+
+// Inclusive rectangle in absolute tile coordinates
+struct route_rect
+{
+  s32 MinX;
+  s32 MinY;
+  s32 MaxX;
+  s32 MaxY;
+};
+
+// Shared by all nets. Blocked and History are only written between batches,
+// Usage is written between batches and only read inside a nets own window.
+struct wire_router
+{
+  route_rect Area;
+  s32 Width;
+  s32 Height;
+  u8*  Blocked;
+  u16* Usage;
+  r32* History;
+  r32 PresentCongestionFactor;
+};
+
+// Search state for one net, indexed relative to its window
+struct route_search
+{
+  route_rect Window;
+  s32 Width;
+  s32 Height;
+
+  r32* G;
+  r32* F;
+  u32* Parent;
+  u32* HeapIndex;
+  u8*  State;
+
+  u32 HeapCount;
+  u32* Heap;
+};
+
+struct route_job
+{
+  wire_router* Router;
+  route_net* Net;
+  b32 UseCongestion;
+  route_search Search;
+
+  b32 Found;
+  u32 CornerCount;
+  route_point* Corners;
+};
+
+internal inline s32 SignOf(s32 Value)
+{
+  s32 Result = (Value > 0) - (Value < 0);
+  return Result;
+}
+
+internal inline b32 Intersects(route_rect A, route_rect B)
+{
+  b32 Result = A.MinX <= B.MaxX && B.MinX <= A.MaxX &&
+               A.MinY <= B.MaxY && B.MinY <= A.MaxY;
+  return Result;
+}
+
+internal inline b32 IsEndPoint(route_net* Net, s32 X, s32 Y)
+{
+  b32 Result = (X == Net->Start.X && Y == Net->Start.Y) ||
+               (X == Net->End.X   && Y == Net->End.Y);
+  return Result;
+}
+
+internal route_rect GetNetWindow(route_net* Net, s32 Margin)
+{
+  route_rect Result = {};
+  Result.MinX = Minimum(Net->Start.X, Net->End.X) - Margin;
+  Result.MinY = Minimum(Net->Start.Y, Net->End.Y) - Margin;
+  Result.MaxX = Maximum(Net->Start.X, Net->End.X) + Margin;
+  Result.MaxY = Maximum(Net->Start.Y, Net->End.Y) + Margin;
+  return Result;
+}
+
+internal inline u32 GetRouterCell(wire_router* Router, s32 X, s32 Y)
+{
+  u32 Result = (Y - Router->Area.MinY) * Router->Width + (X - Router->Area.MinX);
+  return Result;
+}
+
+internal inline u32 GetSearchCell(route_search* Search, s32 X, s32 Y)
+{
+  u32 Result = (Y - Search->Window.MinY) * Search->Width + (X - Search->Window.MinX);
+  return Result;
+}
+
+// Octile distance, admissible for both the uniform and the congested cost
+internal inline r32 RouteHeuristic(s32 X0, s32 Y0, s32 X1, s32 Y1)
+{
+  s32 DX = X1 > X0 ? X1 - X0 : X0 - X1;
+  s32 DY = Y1 > Y0 ? Y1 - Y0 : Y0 - Y1;
+  r32 Result = (r32)(DX + DY) + (RouteDiagonalCost - 2.f) * (r32) Minimum(DX, DY);
+  return Result;
+}
+
+internal inline b32 IsWalkable(route_job* Job, s32 X, s32 Y)
+{
+  route_rect Window = Job->Search.Window;
+  if(X < Window.MinX || Y < Window.MinY || X > Window.MaxX || Y > Window.MaxY)
+  {
+    return false;
+  }
+  if(IsEndPoint(Job->Net, X, Y))
+  {
+    return true;
+  }
+  wire_router* Router = Job->Router;
+  b32 Result = !Router->Blocked[GetRouterCell(Router, X, Y)];
+  return Result;
+}
+
+internal void SiftUp(route_search* Search, u32 Index)
+{
+  u32 Cell = Search->Heap[Index];
+  while(Index > 0)
+  {
+    u32 ParentIndex = (Index - 1) / 2;
+    u32 ParentCell = Search->Heap[ParentIndex];
+    if(Search->F[ParentCell] <= Search->F[Cell])
+    {
+      break;
+    }
+    Search->Heap[Index] = ParentCell;
+    Search->HeapIndex[ParentCell] = Index;
+    Index = ParentIndex;
+  }
+  Search->Heap[Index] = Cell;
+  Search->HeapIndex[Cell] = Index;
+}
+
+internal void SiftDown(route_search* Search, u32 Index)
+{
+  u32 Cell = Search->Heap[Index];
+  for(;;)
+  {
+    u32 Child = 2 * Index + 1;
+    if(Child >= Search->HeapCount)
+    {
+      break;
+    }
+    if(Child + 1 < Search->HeapCount && Search->F[Search->Heap[Child + 1]] < Search->F[Search->Heap[Child]])
+    {
+      ++Child;
+    }
+    if(Search->F[Search->Heap[Child]] >= Search->F[Cell])
+    {
+      break;
+    }
+    Search->Heap[Index] = Search->Heap[Child];
+    Search->HeapIndex[Search->Heap[Index]] = Index;
+    Index = Child;
+  }
+  Search->Heap[Index] = Cell;
+  Search->HeapIndex[Cell] = Index;
+}
+
+internal u32 PopCheapestCell(route_search* Search)
+{
+  Assert(Search->HeapCount);
+  u32 Result = Search->Heap[0];
+  --Search->HeapCount;
+  if(Search->HeapCount)
+  {
+    Search->Heap[0] = Search->Heap[Search->HeapCount];
+    SiftDown(Search, 0);
+  }
+  return Result;
+}
+
+internal void OpenCell(route_job* Job, u32 FromCell, s32 X, s32 Y, r32 Cost)
+{
+  route_search* Search = &Job->Search;
+  u32 Cell = GetSearchCell(Search, X, Y);
+  if(Search->State[Cell] == ROUTE_CELL_CLOSED)
+  {
+    return;
+  }
+
+  r32 G = Search->G[FromCell] + Cost;
+  if(Search->State[Cell] == ROUTE_CELL_UNSEEN)
+  {
+    Search->State[Cell] = ROUTE_CELL_OPEN;
+    Search->G[Cell] = G;
+    Search->F[Cell] = G + RouteHeuristic(X, Y, Job->Net->End.X, Job->Net->End.Y);
+    Search->Parent[Cell] = FromCell;
+    Search->Heap[Search->HeapCount] = Cell;
+    SiftUp(Search, Search->HeapCount++);
+  }else if(G < Search->G[Cell]){
+    r32 H = Search->F[Cell] - Search->G[Cell];
+    Search->G[Cell] = G;
+    Search->F[Cell] = G + H;
+    Search->Parent[Cell] = FromCell;
+    SiftUp(Search, Search->HeapIndex[Cell]);
+  }
+}
+
+// Jump point search without corner cutting, a diagonal step needs both its orthogonal neighbours free.
+// Walks from X,Y in direction DX,DY and returns the first jump point, if any.
+internal b32 Jump(route_job* Job, s32 X, s32 Y, s32 DX, s32 DY, s32* JumpX, s32* JumpY)
+{
+  route_point End = Job->Net->End;
+  for(;;)
+  {
+    X += DX;
+    Y += DY;
+    if(!IsWalkable(Job, X, Y))
+    {
+      return false;
+    }
+    if(X == End.X && Y == End.Y)
+    {
+      break;
+    }
+
+    if(DX && DY)
+    {
+      s32 StraightX = 0;
+      s32 StraightY = 0;
+      if(Jump(Job, X, Y, DX, 0, &StraightX, &StraightY) ||
+         Jump(Job, X, Y, 0, DY, &StraightX, &StraightY))
+      {
+        break;
+      }
+      if(!IsWalkable(Job, X + DX, Y) || !IsWalkable(Job, X, Y + DY))
+      {
+        return false;
+      }
+    }else if(DX){
+      // Forced neighbour, an obstacle behind us opens up above or below
+      if((IsWalkable(Job, X, Y + 1) && !IsWalkable(Job, X - DX, Y + 1)) ||
+         (IsWalkable(Job, X, Y - 1) && !IsWalkable(Job, X - DX, Y - 1)))
+      {
+        break;
+      }
+    }else{
+      if((IsWalkable(Job, X + 1, Y) && !IsWalkable(Job, X + 1, Y - DY)) ||
+         (IsWalkable(Job, X - 1, Y) && !IsWalkable(Job, X - 1, Y - DY)))
+      {
+        break;
+      }
+    }
+  }
+
+  *JumpX = X;
+  *JumpY = Y;
+  return true;
+}
+
+// Fills Directions with the directions worth searching from X,Y given where we came from
+internal u32 GetPrunedDirections(route_job* Job, u32 Cell, s32 X, s32 Y, s32 Directions[8][2])
+{
+  route_search* Search = &Job->Search;
+  u32 Count = 0;
+  u32 ParentCell = Search->Parent[Cell];
+  if(ParentCell == ROUTE_CELL_NONE)
+  {
+    for(s32 DY = -1; DY <= 1; ++DY)
+    {
+      for(s32 DX = -1; DX <= 1; ++DX)
+      {
+        if(!DX && !DY)
+        {
+          continue;
+        }
+        if(DX && DY && (!IsWalkable(Job, X + DX, Y) || !IsWalkable(Job, X, Y + DY)))
+        {
+          continue;
+        }
+        Directions[Count][0] = DX;
+        Directions[Count][1] = DY;
+        ++Count;
+      }
+    }
+    return Count;
+  }
+
+  s32 ParentX = Search->Window.MinX + (s32)(ParentCell % Search->Width);
+  s32 ParentY = Search->Window.MinY + (s32)(ParentCell / Search->Width);
+  s32 DX = SignOf(X - ParentX);
+  s32 DY = SignOf(Y - ParentY);
+
+  if(DX && DY)
+  {
+    b32 WalkX = IsWalkable(Job, X + DX, Y);
+    b32 WalkY = IsWalkable(Job, X, Y + DY);
+    if(WalkY)          { Directions[Count][0] = 0;  Directions[Count][1] = DY; ++Count; }
+    if(WalkX)          { Directions[Count][0] = DX; Directions[Count][1] = 0;  ++Count; }
+    if(WalkX && WalkY) { Directions[Count][0] = DX; Directions[Count][1] = DY; ++Count; }
+  }else if(DX){
+    b32 WalkNext  = IsWalkable(Job, X + DX, Y);
+    b32 WalkUp    = IsWalkable(Job, X, Y + 1);
+    b32 WalkDown  = IsWalkable(Job, X, Y - 1);
+    if(WalkNext)
+    {
+      Directions[Count][0] = DX; Directions[Count][1] = 0; ++Count;
+      if(WalkUp)   { Directions[Count][0] = DX; Directions[Count][1] =  1; ++Count; }
+      if(WalkDown) { Directions[Count][0] = DX; Directions[Count][1] = -1; ++Count; }
+    }
+    if(WalkUp)   { Directions[Count][0] = 0; Directions[Count][1] =  1; ++Count; }
+    if(WalkDown) { Directions[Count][0] = 0; Directions[Count][1] = -1; ++Count; }
+  }else{
+    b32 WalkNext  = IsWalkable(Job, X, Y + DY);
+    b32 WalkRight = IsWalkable(Job, X + 1, Y);
+    b32 WalkLeft  = IsWalkable(Job, X - 1, Y);
+    if(WalkNext)
+    {
+      Directions[Count][0] = 0; Directions[Count][1] = DY; ++Count;
+      if(WalkRight) { Directions[Count][0] =  1; Directions[Count][1] = DY; ++Count; }
+      if(WalkLeft)  { Directions[Count][0] = -1; Directions[Count][1] = DY; ++Count; }
+    }
+    if(WalkRight) { Directions[Count][0] =  1; Directions[Count][1] = 0; ++Count; }
+    if(WalkLeft)  { Directions[Count][0] = -1; Directions[Count][1] = 0; ++Count; }
+  }
+  return Count;
+}
+
+internal void ExpandJumpPoints(route_job* Job, u32 Cell, s32 X, s32 Y)
+{
+  s32 Directions[8][2] = {};
+  u32 DirectionCount = GetPrunedDirections(Job, Cell, X, Y, Directions);
+  for(u32 Index = 0; Index < DirectionCount; ++Index)
+  {
+    s32 JumpX = 0;
+    s32 JumpY = 0;
+    if(Jump(Job, X, Y, Directions[Index][0], Directions[Index][1], &JumpX, &JumpY))
+    {
+      OpenCell(Job, Cell, JumpX, JumpY, RouteHeuristic(X, Y, JumpX, JumpY));
+    }
+  }
+}
+
+internal void ExpandCongestedNeighbours(route_job* Job, u32 Cell, s32 X, s32 Y)
+{
+  wire_router* Router = Job->Router;
+  for(s32 DY = -1; DY <= 1; ++DY)
+  {
+    for(s32 DX = -1; DX <= 1; ++DX)
+    {
+      if(!DX && !DY)
+      {
+        continue;
+      }
+      s32 NX = X + DX;
+      s32 NY = Y + DY;
+      if(!IsWalkable(Job, NX, NY))
+      {
+        continue;
+      }
+      r32 StepCost = 1.f;
+      if(DX && DY)
+      {
+        if(!IsWalkable(Job, NX, Y) || !IsWalkable(Job, X, NY))
+        {
+          continue;
+        }
+        StepCost = RouteDiagonalCost;
+      }
+
+      u32 RouterCell = GetRouterCell(Router, NX, NY);
+      r32 Present = 1.f + Router->PresentCongestionFactor * Router->Usage[RouterCell];
+      r32 History = 1.f + Router->History[RouterCell];
+      OpenCell(Job, Cell, NX, NY, StepCost * Present * History);
+    }
+  }
+}
+
+// Walks the parent chain from the end cell and keeps only the points where the direction changes
+internal void ExtractCorners(route_job* Job, u32 EndCell)
+{
+  route_search* Search = &Job->Search;
+  u32 PathCount = 0;
+  for(u32 Cell = EndCell; Cell != ROUTE_CELL_NONE; Cell = Search->Parent[Cell])
+  {
+    route_point* Point = Job->Corners + PathCount++;
+    Point->X = Search->Window.MinX + (s32)(Cell % Search->Width);
+    Point->Y = Search->Window.MinY + (s32)(Cell / Search->Width);
+  }
+
+  // The chain runs end to start, reverse it
+  for(u32 Index = 0; Index < PathCount / 2; ++Index)
+  {
+    route_point Tmp = Job->Corners[Index];
+    Job->Corners[Index] = Job->Corners[PathCount - 1 - Index];
+    Job->Corners[PathCount - 1 - Index] = Tmp;
+  }
+
+  u32 CornerCount = 1;
+  for(u32 Index = 1; Index < PathCount; ++Index)
+  {
+    b32 Last = Index == PathCount - 1;
+    if(!Last)
+    {
+      route_point Prev = Job->Corners[CornerCount - 1];
+      route_point Point = Job->Corners[Index];
+      route_point Next = Job->Corners[Index + 1];
+      b32 SameDirection = SignOf(Point.X - Prev.X) == SignOf(Next.X - Point.X) &&
+                          SignOf(Point.Y - Prev.Y) == SignOf(Next.Y - Point.Y);
+      if(SameDirection)
+      {
+        continue;
+      }
+    }
+    Job->Corners[CornerCount++] = Job->Corners[Index];
+  }
+  Job->CornerCount = CornerCount;
+}
+
+internal void FindRoute(route_job* Job)
+{
+  TIMED_FUNCTION();
+
+  route_search* Search = &Job->Search;
+  route_point Start = Job->Net->Start;
+  route_point End = Job->Net->End;
+
+  u32 StartCell = GetSearchCell(Search, Start.X, Start.Y);
+  Search->State[StartCell] = ROUTE_CELL_OPEN;
+  Search->G[StartCell] = 0;
+  Search->F[StartCell] = RouteHeuristic(Start.X, Start.Y, End.X, End.Y);
+  Search->Parent[StartCell] = ROUTE_CELL_NONE;
+  Search->Heap[Search->HeapCount] = StartCell;
+  SiftUp(Search, Search->HeapCount++);
+
+  while(Search->HeapCount)
+  {
+    u32 Cell = PopCheapestCell(Search);
+    Search->State[Cell] = ROUTE_CELL_CLOSED;
+    s32 X = Search->Window.MinX + (s32)(Cell % Search->Width);
+    s32 Y = Search->Window.MinY + (s32)(Cell / Search->Width);
+    if(X == End.X && Y == End.Y)
+    {
+      Job->Found = true;
+      ExtractCorners(Job, Cell);
+      return;
+    }
+
+    if(Job->UseCongestion)
+    {
+      ExpandCongestedNeighbours(Job, Cell, X, Y);
+    }else{
+      ExpandJumpPoints(Job, Cell, X, Y);
+    }
+  }
+}
+
+PLATFORM_WORK_QUEUE_CALLBACK(RouteNetWork)
+{
+  route_job* Job = (route_job*) Data;
+  FindRoute(Job);
+}
+
+internal void InitiateRouteJob(memory_arena* Arena, route_job* Job, wire_router* Router, route_net* Net, route_rect Window, b32 UseCongestion)
+{
+  *Job = {};
+  Job->Router = Router;
+  Job->Net = Net;
+  Job->UseCongestion = UseCongestion;
+
+  route_search* Search = &Job->Search;
+  Search->Window = Window;
+  Search->Width  = Window.MaxX - Window.MinX + 1;
+  Search->Height = Window.MaxY - Window.MinY + 1;
+
+  u32 CellCount = Search->Width * Search->Height;
+  Search->G         = PushArray(Arena, CellCount, r32, NoClear());
+  Search->F         = PushArray(Arena, CellCount, r32, NoClear());
+  Search->Parent    = PushArray(Arena, CellCount, u32, NoClear());
+  Search->HeapIndex = PushArray(Arena, CellCount, u32, NoClear());
+  Search->Heap      = PushArray(Arena, CellCount, u32, NoClear());
+  Search->State     = PushArray(Arena, CellCount, u8);
+  Job->Corners      = PushArray(Arena, CellCount, route_point, NoClear());
+}
+
+// Delta is +1 when a route is committed and -1 when it is ripped up.
+// The end points are not counted, many wires may connect to the same pin.
+internal void AddRouteUsage(wire_router* Router, route_net* Net, s32 Delta)
+{
+  for(u32 Index = 1; Index < Net->PointCount; ++Index)
+  {
+    route_point From = Net->Points[Index - 1];
+    route_point To = Net->Points[Index];
+    s32 DX = SignOf(To.X - From.X);
+    s32 DY = SignOf(To.Y - From.Y);
+    s32 X = From.X;
+    s32 Y = From.Y;
+    while(X != To.X || Y != To.Y)
+    {
+      X += DX;
+      Y += DY;
+      if(!IsEndPoint(Net, X, Y))
+      {
+        u16* Usage = Router->Usage + GetRouterCell(Router, X, Y);
+        Assert(Delta > 0 || *Usage > 0);
+        *Usage = (u16)(*Usage + Delta);
+      }
+    }
+  }
+}
+
+internal b32 IsRouteOverused(wire_router* Router, route_net* Net)
+{
+  for(u32 Index = 1; Index < Net->PointCount; ++Index)
+  {
+    route_point From = Net->Points[Index - 1];
+    route_point To = Net->Points[Index];
+    s32 DX = SignOf(To.X - From.X);
+    s32 DY = SignOf(To.Y - From.Y);
+    s32 X = From.X;
+    s32 Y = From.Y;
+    while(X != To.X || Y != To.Y)
+    {
+      X += DX;
+      Y += DY;
+      if(!IsEndPoint(Net, X, Y) && Router->Usage[GetRouterCell(Router, X, Y)] > 1)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+internal void CommitRoute(memory_arena* Arena, wire_router* Router, route_job* Job)
+{
+  route_net* Net = Job->Net;
+  Net->Routed = Job->Found;
+  Net->PointCount = 0;
+  if(!Job->Found)
+  {
+    return;
+  }
+
+  // Reroutes reuse the points of the previous route when they fit
+  if(Job->CornerCount > Net->MaxPointCount)
+  {
+    Net->Points = PushArray(Arena, Job->CornerCount, route_point, NoClear());
+    Net->MaxPointCount = Job->CornerCount;
+  }
+  CopyArray(Job->CornerCount, Job->Corners, Net->Points);
+  Net->PointCount = Job->CornerCount;
+  AddRouteUsage(Router, Net, 1);
+}
+
+// Routes the pending nets in batches of non-overlapping windows.
+internal void RoutePendingNets(memory_arena* Arena, memory_arena* ScratchArena, wire_router* Router, route_net* Nets, u32 PendingCount, u32* Pending, b32 UseCongestion, s32 Margin)
+{
+  route_job Jobs[ROUTE_MAX_BATCH_SIZE];
+  while(PendingCount)
+  {
+    ScopedMemory BatchMemory(ScratchArena);
+
+    u32 JobCount = 0;
+    u32 RemainingCount = 0;
+    for(u32 Index = 0; Index < PendingCount; ++Index)
+    {
+      route_net* Net = Nets + Pending[Index];
+      route_rect Window = GetNetWindow(Net, Margin);
+
+      b32 Overlaps = JobCount == ArrayCount(Jobs);
+      for(u32 JobIndex = 0; JobIndex < JobCount && !Overlaps; ++JobIndex)
+      {
+        Overlaps = Intersects(Window, Jobs[JobIndex].Search.Window);
+      }
+
+      if(Overlaps)
+      {
+        Pending[RemainingCount++] = Pending[Index];
+      }else{
+        InitiateRouteJob(ScratchArena, Jobs + JobCount++, Router, Net, Window, UseCongestion);
+      }
+    }
+
+    if(JobCount == 1)
+    {
+      FindRoute(Jobs);
+    }else{
+      for(u32 JobIndex = 0; JobIndex < JobCount; ++JobIndex)
+      {
+        Platform.PlatformAddEntry(Platform.HighPriorityQueue, RouteNetWork, Jobs + JobIndex);
+      }
+      Platform.PlatformCompleteWorkQueue(Platform.HighPriorityQueue);
+    }
+
+    for(u32 JobIndex = 0; JobIndex < JobCount; ++JobIndex)
+    {
+      CommitRoute(Arena, Router, Jobs + JobIndex);
+    }
+
+    PendingCount = RemainingCount;
+  }
+}
+
+b32 RouteNets(memory_arena* Arena, tile_map* TileMap, s32 TileZ, u32 NetCount, route_net* Nets, route_settings Settings)
+{
+  TIMED_FUNCTION();
+
+  if(!NetCount)
+  {
+    return true;
+  }
+
+  // Points go on Arena so the router state can't be on it, it may well be the TransientArena
+  temporary_memory Scratch = GetScratch(&Arena, 1);
+  memory_arena* ScratchArena = Scratch.Arena;
+
+  wire_router Router = {};
+  Router.Area = GetNetWindow(Nets, Settings.Margin);
+  for(u32 Index = 1; Index < NetCount; ++Index)
+  {
+    route_rect Window = GetNetWindow(Nets + Index, Settings.Margin);
+    Router.Area.MinX = Minimum(Router.Area.MinX, Window.MinX);
+    Router.Area.MinY = Minimum(Router.Area.MinY, Window.MinY);
+    Router.Area.MaxX = Maximum(Router.Area.MaxX, Window.MaxX);
+    Router.Area.MaxY = Maximum(Router.Area.MaxY, Window.MaxY);
+  }
+  Router.Width  = Router.Area.MaxX - Router.Area.MinX + 1;
+  Router.Height = Router.Area.MaxY - Router.Area.MinY + 1;
+  Router.PresentCongestionFactor = Settings.PresentCongestionFactor;
+
+  u32 CellCount = Router.Width * Router.Height;
+  Router.Blocked = PushArray(ScratchArena, CellCount, u8, NoClear());
+  Router.Usage   = PushArray(ScratchArena, CellCount, u16);
+  Router.History = PushArray(ScratchArena, CellCount, r32);
+
+  for(s32 Y = Router.Area.MinY; Y <= Router.Area.MaxY; ++Y)
+  {
+    for(s32 X = Router.Area.MinX; X <= Router.Area.MaxX; ++X)
+    {
+      tile_contents Contents = GetTileContents(TileMap, X, Y, TileZ);
+      b32 Occupied = Contents.Type != TILE_TYPE_NONE || IsValid(&Contents.ElectricalComponentEntity);
+      Router.Blocked[GetRouterCell(&Router, X, Y)] = (u8) Occupied;
+    }
+  }
+
+  u32 PendingCount = NetCount;
+  u32* Pending = PushArray(ScratchArena, NetCount, u32, NoClear());
+  for(u32 Index = 0; Index < NetCount; ++Index)
+  {
+    Nets[Index].Routed = false;
+    Nets[Index].PointCount = 0;
+    Pending[Index] = Index;
+  }
+
+  b32 Result = false;
+  for(u32 Iteration = 0; Iteration < Settings.MaxIterations; ++Iteration)
+  {
+    RoutePendingNets(Arena, ScratchArena, &Router, Nets, PendingCount, Pending, Iteration > 0, Settings.Margin);
+
+    u32 OverusedCount = 0;
+    for(u32 Cell = 0; Cell < CellCount; ++Cell)
+    {
+      if(Router.Usage[Cell] > 1)
+      {
+        Router.History[Cell] += Settings.HistoryCongestionFactor;
+        ++OverusedCount;
+      }
+    }
+
+    if(!OverusedCount)
+    {
+      Result = true;
+      break;
+    }
+
+    if(Iteration + 1 == Settings.MaxIterations)
+    {
+      break;
+    }
+
+    // Rip up every net passing through an overused tile and try again
+    PendingCount = 0;
+    for(u32 Index = 0; Index < NetCount; ++Index)
+    {
+      route_net* Net = Nets + Index;
+      if(Net->Routed && IsRouteOverused(&Router, Net))
+      {
+        Pending[PendingCount++] = Index;
+      }
+    }
+    for(u32 Index = 0; Index < PendingCount; ++Index)
+    {
+      route_net* Net = Nets + Pending[Index];
+      AddRouteUsage(&Router, Net, -1);
+    }
+
+    Router.PresentCongestionFactor *= Settings.PresentCongestionGrowth;
+  }
+
+  for(u32 Index = 0; Index < NetCount; ++Index)
+  {
+    Result = Result && Nets[Index].Routed;
+  }
+
+  ReleaseScratch(Scratch);
+  return Result;
+}
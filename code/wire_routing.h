@@ -0,0 +1,54 @@
+#pragma once
+
+#include "types.h"
+#include "breadboard_tile.h"
+
+// Wire routing over the tile map.
+// The first pass routes every net with jump point search over free tiles. Nets that end up sharing
+// tiles are then ripped up and rerouted with a plain A* where each tile costs more the more nets
+// use it now and have used it in earlier passes (negotiated congestion). JPS needs uniform cost so
+// it is only used for the first pass.
+// Nets are routed in parallel batches where their search windows don't overlap.
+
+// Absolute tile coordinate
+struct route_point
+{
+  s32 X;
+  s32 Y;
+};
+
+struct route_net
+{
+  route_point Start;
+  route_point End;
+
+  b32 Routed;
+  u32 PointCount;       // Corners of the wire from Start to End, straight or diagonal in between
+  u32 MaxPointCount;
+  route_point* Points;
+};
+
+struct route_settings
+{
+  u32 MaxIterations;
+  s32 Margin;                    // How many tiles outside a nets bounding box it may use
+  r32 PresentCongestionFactor;   // Cost of a tile already used by another net
+  r32 PresentCongestionGrowth;   // Present cost grows each iteration so nets are forced apart
+  r32 HistoryCongestionFactor;   // Permanent cost added to a tile each iteration it is overused
+};
+
+inline route_settings DefaultRouteSettings()
+{
+  route_settings Result = {};
+  Result.MaxIterations = 16;
+  Result.Margin = 8;
+  Result.PresentCongestionFactor = 0.5f;
+  Result.PresentCongestionGrowth = 1.5f;
+  Result.HistoryCongestionFactor = 1.f;
+  return Result;
+}
+
+// Routes all nets on the tile slice TileZ. Occupied tiles are obstacles, except for the nets own end points.
+// Points are pushed on Arena, the search state goes on a scratch arena.
+// Returns true if every net was routed without sharing a tile with another.
+b32 RouteNets(memory_arena* Arena, tile_map* TileMap, s32 TileZ, u32 NetCount, route_net* Nets, route_settings Settings = DefaultRouteSettings());
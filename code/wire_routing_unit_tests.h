@@ -0,0 +1,135 @@
+#include "wire_routing.h"
+
+namespace wire_routing_tests
+{
+
+// Any valid entity makes a tile an obstacle
+internal void BlockTile(memory_arena* Arena, tile_map* TileMap, s32 X, s32 Y)
+{
+  tile_contents Contents = {};
+  Contents.ElectricalComponentEntity.EntityID = 1;
+  SetTileContentsAbs(Arena, TileMap, X, Y, 0, Contents);
+}
+
+internal b32 IsBlocked(tile_map* TileMap, s32 X, s32 Y)
+{
+  tile_contents Contents = GetTileContents(TileMap, X, Y, 0);
+  return IsValid(&Contents.ElectricalComponentEntity);
+}
+
+// Walks the route tile by tile and checks that it connects the end points with straight
+// or diagonal segments, only passes free tiles and never cuts the corner of a blocked tile.
+internal void AssertRouteIsValid(tile_map* TileMap, route_net* Net)
+{
+  Assert(Net->Routed);
+  Assert(Net->PointCount >= 2);
+  Assert(Net->Points[0].X == Net->Start.X && Net->Points[0].Y == Net->Start.Y);
+  Assert(Net->Points[Net->PointCount-1].X == Net->End.X && Net->Points[Net->PointCount-1].Y == Net->End.Y);
+
+  for(u32 Index = 1; Index < Net->PointCount; ++Index)
+  {
+    route_point From = Net->Points[Index-1];
+    route_point To = Net->Points[Index];
+    s32 DX = SignOf(To.X - From.X);
+    s32 DY = SignOf(To.Y - From.Y);
+    Assert(DX || DY);
+    Assert(!DX || !DY || (To.X - From.X) * DX == (To.Y - From.Y) * DY);
+
+    s32 X = From.X;
+    s32 Y = From.Y;
+    while(X != To.X || Y != To.Y)
+    {
+      if(DX && DY)
+      {
+        Assert(!IsBlocked(TileMap, X + DX, Y));
+        Assert(!IsBlocked(TileMap, X, Y + DY));
+      }
+      X += DX;
+      Y += DY;
+      Assert(IsEndPoint(Net, X, Y) || !IsBlocked(TileMap, X, Y));
+    }
+  }
+}
+
+internal b32 RoutePassesTile(route_net* Net, s32 TileX, s32 TileY)
+{
+  for(u32 Index = 1; Index < Net->PointCount; ++Index)
+  {
+    route_point From = Net->Points[Index-1];
+    route_point To = Net->Points[Index];
+    s32 DX = SignOf(To.X - From.X);
+    s32 DY = SignOf(To.Y - From.Y);
+    s32 X = From.X;
+    s32 Y = From.Y;
+    while(X != To.X || Y != To.Y)
+    {
+      X += DX;
+      Y += DY;
+      if(X == TileX && Y == TileY && !IsEndPoint(Net, X, Y))
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void RouteAroundWall(memory_arena* Arena)
+{
+  ScopedMemory ScopedMem = ScopedMemory(Arena);
+  tile_map TileMap = {};
+  InitializeTileMap(&TileMap);
+
+  // Wall across the straight line, open at both ends of the window
+  for(s32 Y = 14; Y <= 26; ++Y)
+  {
+    BlockTile(Arena, &TileMap, 20, Y);
+  }
+
+  route_net Net = {};
+  Net.Start = {10, 20};
+  Net.End   = {30, 20};
+  b32 Routed = RouteNets(Arena, &TileMap, 0, 1, &Net);
+  Assert(Routed);
+  AssertRouteIsValid(&TileMap, &Net);
+}
+
+void SeparateNetsThroughGaps(memory_arena* Arena)
+{
+  ScopedMemory ScopedMem = ScopedMemory(Arena);
+  tile_map TileMap = {};
+  InitializeTileMap(&TileMap);
+
+  // Wall with one gap both nets prefer and one further away
+  s32 NearGap = 60;
+  s32 FarGap = 64;
+  for(s32 Y = 48; Y <= 72; ++Y)
+  {
+    if(Y != NearGap && Y != FarGap)
+    {
+      BlockTile(Arena, &TileMap, 20, Y);
+    }
+  }
+
+  route_net Nets[2] = {};
+  Nets[0].Start = {10, 60};
+  Nets[0].End   = {30, 60};
+  Nets[1].Start = {10, 61};
+  Nets[1].End   = {30, 61};
+  b32 Routed = RouteNets(Arena, &TileMap, 0, ArrayCount(Nets), Nets);
+  Assert(Routed);
+  AssertRouteIsValid(&TileMap, Nets + 0);
+  AssertRouteIsValid(&TileMap, Nets + 1);
+
+  // Congestion has to push one of them through the far gap
+  Assert(RoutePassesTile(Nets + 0, 20, NearGap) != RoutePassesTile(Nets + 1, 20, NearGap));
+  Assert(RoutePassesTile(Nets + 0, 20, FarGap) != RoutePassesTile(Nets + 1, 20, FarGap));
+}
+
+void RunUnitTests(memory_arena* Arena)
+{
+  RouteAroundWall(Arena);
+  SeparateNetsThroughGaps(Arena);
+}
+
+};